@@ -0,0 +1,103 @@
+#include "Fixtures.hpp"
+
+namespace celux::bench
+{
+namespace
+{
+struct Conversion
+{
+    const char* name;
+    celux::ConversionType type;
+    AVPixelFormat frameFormat; // Of the decoded or encoder frame
+    bool toFrame;              // Writes the frame from a buffer, as encoders do
+    int bufferChannels;        // 3 for packed RGB/BGR, 0 for packed NV12
+};
+
+const Conversion conversions[] = {
+    {"NV12ToRGB", celux::ConversionType::NV12ToRGB, AV_PIX_FMT_NV12, false, 3},
+    {"NV12ToBGR", celux::ConversionType::NV12ToBGR, AV_PIX_FMT_NV12, false, 3},
+    {"P010ToRGB", celux::ConversionType::P010ToRGB, AV_PIX_FMT_P010LE, false, 3},
+    {"RGBToNV12", celux::ConversionType::RGBToNV12, AV_PIX_FMT_NV12, true, 3},
+    {"BGRToNV12", celux::ConversionType::BGRToNV12, AV_PIX_FMT_NV12, true, 3},
+    {"NV12ToNV12", celux::ConversionType::NV12ToNV12, AV_PIX_FMT_NV12, true, 0},
+};
+
+const celux::dataType dataTypes[] = {
+    celux::dataType::UINT8,
+    celux::dataType::UINT16,
+    celux::dataType::FLOAT16,
+    celux::dataType::FLOAT32,
+};
+
+// One conversion of a grey frame per iteration, waited for on the GPU, so
+// latency is the time of one frame and fps the rate of back to back frames
+void convertFrames(benchmark::State& state, celux::backend backend,
+                   Conversion conversion, celux::dataType dtype,
+                   Resolution resolution)
+{
+    auto converter = celux::Factory::createConverter(backend, conversion.type, dtype);
+    celux::Frame frame =
+        makeFrame(backend, conversion.frameFormat, resolution.width, resolution.height);
+    const size_t pixels = static_cast<size_t>(resolution.width) * resolution.height;
+    const size_t bytes = conversion.bufferChannels > 0
+                             ? pixels * conversion.bufferChannels * elementSize(dtype)
+                             : pixels * 3 / 2;
+    Buffer buffer(backend, bytes);
+
+    // The first conversion sets up per-size state, e.g. swscale contexts
+    converter->convert(frame, buffer.data());
+    converter->synchronize();
+
+    Latencies latencies;
+    for (auto _ : state)
+    {
+        latencies.start();
+        converter->convert(frame, buffer.data());
+        converter->synchronize();
+        latencies.stop();
+    }
+    latencies.report(state, state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+} // namespace
+
+void registerConvertBenchmarks()
+{
+    std::vector<celux::backend> backends = {celux::backend::CPU};
+    if (cudaAvailable())
+    {
+        backends.push_back(celux::backend::CUDA);
+    }
+
+    for (celux::backend backend : backends)
+    {
+        for (const Conversion& conversion : conversions)
+        {
+            for (celux::dataType dtype : dataTypes)
+            {
+                // Only the combinations the factory builds
+                try
+                {
+                    celux::Factory::createConverter(backend, conversion.type, dtype);
+                }
+                catch (const std::exception&)
+                {
+                    continue;
+                }
+                for (const Resolution& resolution : resolutions)
+                {
+                    const std::string name =
+                        std::string("Convert/") + backendName(backend) + "/" +
+                        conversion.name + "/" + dataTypeName(dtype) + "/" +
+                        resolution.name;
+                    benchmark::RegisterBenchmark(name.c_str(), convertFrames, backend,
+                                                 conversion, dtype, resolution)
+                        ->Unit(benchmark::kMillisecond)
+                        ->UseRealTime();
+                }
+            }
+        }
+    }
+}
+
+} // namespace celux::bench
@@ -0,0 +1,94 @@
+#include "Fixtures.hpp"
+
+namespace celux::bench
+{
+namespace
+{
+const char* const codecs[] = {"h264", "hevc", "av1"};
+
+/**
+ * @brief Decode the clip frame after frame, from the start again at its end.
+ *
+ * @param convert Convert each frame to uint8 RGB, as VideoReader does, instead
+ * of only decoding it, which separates the decoder's time from the
+ * conversion's.
+ */
+void decodeFrames(benchmark::State& state, celux::backend backend,
+                  std::string codec, Resolution resolution, bool convert)
+{
+    std::unique_ptr<celux::Decoder> decoder;
+    try
+    {
+        decoder = celux::Factory::createDecoder(
+            backend, syntheticClip(codec, resolution),
+            celux::Factory::createConverter(backend, celux::ConversionType::NV12ToRGB,
+                                            celux::dataType::UINT8));
+    }
+    catch (const std::exception& e)
+    {
+        // Encoders for the clip, or decoders for the codec, may be missing
+        state.SkipWithError(e.what());
+        return;
+    }
+    Buffer buffer(backend,
+                  static_cast<size_t>(resolution.width) * resolution.height * 3);
+    celux::Frame raw;
+
+    Latencies latencies;
+    for (auto _ : state)
+    {
+        latencies.start();
+        bool decoded = convert ? decoder->decodeNextFrame(buffer.data())
+                               : decoder->decodeNextRawFrame(raw);
+        if (!decoded)
+        {
+            state.PauseTiming();
+            decoder->seek(0.0);
+            state.ResumeTiming();
+            latencies.start();
+            decoded = convert ? decoder->decodeNextFrame(buffer.data())
+                              : decoder->decodeNextRawFrame(raw);
+            if (!decoded)
+            {
+                state.SkipWithError("No frame decoded after rewinding");
+                break;
+            }
+        }
+        decoder->synchronize();
+        latencies.stop();
+    }
+    latencies.report(state, state.iterations());
+}
+} // namespace
+
+void registerDecodeBenchmarks()
+{
+    std::vector<celux::backend> backends = {celux::backend::CPU};
+    if (cudaAvailable())
+    {
+        backends.push_back(celux::backend::CUDA);
+    }
+
+    for (celux::backend backend : backends)
+    {
+        for (const char* codec : codecs)
+        {
+            for (const Resolution& resolution : resolutions)
+            {
+                for (bool convert : {false, true})
+                {
+                    const std::string name =
+                        std::string(convert ? "DecodeRGB/" : "Decode/") +
+                        backendName(backend) + "/" + codec + "/" + resolution.name;
+                    benchmark::RegisterBenchmark(name.c_str(), decodeFrames, backend,
+                                                 std::string(codec), resolution,
+                                                 convert)
+                        ->Unit(benchmark::kMillisecond)
+                        ->UseRealTime();
+                }
+            }
+        }
+    }
+}
+
+} // namespace celux::bench
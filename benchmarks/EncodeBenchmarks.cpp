@@ -0,0 +1,119 @@
+#include "Fixtures.hpp"
+#include <filesystem>
+
+namespace celux::bench
+{
+namespace
+{
+struct Codec
+{
+    const char* name;
+    celux::backend backend;
+    const char* encoder;
+    const char* preset;
+};
+
+// Presets a realtime pipeline would pick, so rates are comparable across runs
+const Codec codecs[] = {
+    {"h264", celux::backend::CPU, "libx264", "veryfast"},
+    {"hevc", celux::backend::CPU, "libx265", "veryfast"},
+    {"av1", celux::backend::CPU, "libsvtav1", "10"},
+    {"h264", celux::backend::CUDA, "h264_nvenc", "p4"},
+    {"hevc", celux::backend::CUDA, "hevc_nvenc", "p4"},
+    {"av1", celux::backend::CUDA, "av1_nvenc", "p4"},
+};
+
+// Distinct frames cycled through, so the encoder can't coast on repeats
+constexpr int PatternFrames = 8;
+
+/**
+ * @brief Convert and encode uint8 RGB frames into a matroska file, one per
+ * iteration. Latency is the time encodeFrame() takes, which includes the
+ * packets it muxes; frames the encoder still buffers are flushed untimed.
+ */
+void encodeFrames(benchmark::State& state, Codec codec, Resolution resolution)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        (std::string("celux_bench_") + codec.encoder + "_" + resolution.name + ".mkv");
+
+    celux::Encoder::VideoProperties props;
+    props.width = resolution.width;
+    props.height = resolution.height;
+    props.fps = 30.0;
+    props.pixelFormat = AV_PIX_FMT_NV12;
+    props.codecName = codec.encoder;
+    celux::Encoder::Options options;
+    options.preset = codec.preset;
+    options.gopSize = 30;
+
+    std::unique_ptr<celux::Encoder> encoder;
+    try
+    {
+        encoder = celux::Factory::createEncoder(
+            codec.backend, path.string(), props,
+            celux::Factory::createConverter(codec.backend,
+                                            celux::ConversionType::RGBToNV12,
+                                            celux::dataType::UINT8),
+            options);
+    }
+    catch (const std::exception& e)
+    {
+        // The encoder may be missing, or not support the size (e.g. 8K H.264)
+        state.SkipWithError(e.what());
+        return;
+    }
+
+    const size_t frameBytes =
+        static_cast<size_t>(resolution.width) * resolution.height * 3;
+    std::vector<std::unique_ptr<Buffer>> frames;
+    std::vector<uint8_t> rgb;
+    for (int i = 0; i < PatternFrames; ++i)
+    {
+        fillPattern(rgb, resolution.width, resolution.height, i);
+        frames.push_back(std::make_unique<Buffer>(codec.backend, frameBytes));
+        frames.back()->upload(rgb.data(), frameBytes);
+    }
+
+    Latencies latencies;
+    int64_t index = 0;
+    for (auto _ : state)
+    {
+        latencies.start();
+        if (!encoder->encodeFrame(frames[index++ % PatternFrames]->data()))
+        {
+            state.SkipWithError("Failed to encode a frame");
+            break;
+        }
+        latencies.stop();
+    }
+    latencies.report(state, state.iterations());
+
+    encoder->close();
+    encoder.reset();
+    std::filesystem::remove(path);
+}
+} // namespace
+
+void registerEncodeBenchmarks()
+{
+    const bool cuda = cudaAvailable();
+    for (const Codec& codec : codecs)
+    {
+        if (codec.backend == celux::backend::CUDA && !cuda)
+        {
+            continue;
+        }
+        for (const Resolution& resolution : resolutions)
+        {
+            const std::string name = std::string("Encode/") +
+                                     backendName(codec.backend) + "/" + codec.name +
+                                     "/" + resolution.name;
+            benchmark::RegisterBenchmark(name.c_str(), encodeFrames, codec, resolution)
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+        }
+    }
+}
+
+} // namespace celux::bench
@@ -0,0 +1,313 @@
+#include "Fixtures.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#ifdef CUDA_ENABLED
+#include <cuda_runtime.h>
+#endif // CUDA_ENABLED
+
+namespace celux::bench
+{
+namespace
+{
+// Frames per synthetic clip; with a GOP of 30, enough to include seeks and
+// several GOPs per decode loop
+constexpr int ClipFrames = 120;
+
+struct ClipEncoder
+{
+    const char* codec;
+    const char* encoder;
+    const char* preset;
+};
+
+// The fastest settings, since clips only need to exist
+const ClipEncoder clipEncoders[] = {
+    {"h264", "libx264", "ultrafast"},
+    {"hevc", "libx265", "ultrafast"},
+    {"av1", "libsvtav1", "12"},
+};
+
+#ifdef CUDA_ENABLED
+void check(cudaError_t err, const char* what)
+{
+    if (err != cudaSuccess)
+    {
+        throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(err));
+    }
+}
+
+void freeDevice(void* opaque, uint8_t* data)
+{
+    cudaFree(data);
+}
+#endif // CUDA_ENABLED
+} // namespace
+
+const std::vector<Resolution> resolutions = {
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+    {"8K", 7680, 4320},
+};
+
+bool cudaAvailable()
+{
+#ifdef CUDA_ENABLED
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+#else
+    return false;
+#endif // CUDA_ENABLED
+}
+
+const char* backendName(celux::backend backend)
+{
+    return backend == celux::backend::CUDA ? "cuda" : "cpu";
+}
+
+const char* dataTypeName(celux::dataType dtype)
+{
+    switch (dtype)
+    {
+    case celux::dataType::UINT8:
+        return "uint8";
+    case celux::dataType::UINT16:
+        return "uint16";
+    case celux::dataType::FLOAT16:
+        return "float16";
+    case celux::dataType::FLOAT32:
+        return "float32";
+    }
+    return "unknown";
+}
+
+size_t elementSize(celux::dataType dtype)
+{
+    switch (dtype)
+    {
+    case celux::dataType::UINT8:
+        return 1;
+    case celux::dataType::UINT16:
+    case celux::dataType::FLOAT16:
+        return 2;
+    case celux::dataType::FLOAT32:
+        return 4;
+    }
+    return 1;
+}
+
+void synchronize(celux::backend backend)
+{
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        check(cudaDeviceSynchronize(), "cudaDeviceSynchronize");
+    }
+#endif // CUDA_ENABLED
+}
+
+Buffer::Buffer(celux::backend backend, size_t bytes) : backend(backend), bytes(bytes)
+{
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        check(cudaMalloc(&memory, bytes), "cudaMalloc");
+        check(cudaMemset(memory, 0, bytes), "cudaMemset");
+        return;
+    }
+#endif // CUDA_ENABLED
+    memory = av_mallocz(bytes);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+}
+
+Buffer::~Buffer()
+{
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        cudaFree(memory);
+        return;
+    }
+#endif // CUDA_ENABLED
+    av_free(memory);
+}
+
+void* Buffer::data() const
+{
+    return memory;
+}
+
+size_t Buffer::size() const
+{
+    return bytes;
+}
+
+void Buffer::upload(const void* source, size_t count)
+{
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        check(cudaMemcpy(memory, source, count, cudaMemcpyHostToDevice), "cudaMemcpy");
+        return;
+    }
+#endif // CUDA_ENABLED
+    std::memcpy(memory, source, count);
+}
+
+celux::Frame makeFrame(celux::backend backend, AVPixelFormat format, int width,
+                       int height)
+{
+    celux::Frame frame;
+    AVFrame* av = frame.get();
+    av->format = format;
+    av->width = width;
+    av->height = height;
+    // Mid grey luma and neutral chroma; 0x8080 for 16-bit samples
+    const int grey = 0x80;
+
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        // One allocation holding both planes, freed with the frame
+        const bool wide = format == AV_PIX_FMT_P010LE || format == AV_PIX_FMT_P016LE;
+        const int lineSize = width * (wide ? 2 : 1);
+        const size_t lumaBytes = static_cast<size_t>(lineSize) * height;
+        const size_t size = lumaBytes + lumaBytes / 2;
+        void* memory = nullptr;
+        check(cudaMalloc(&memory, size), "cudaMalloc");
+        check(cudaMemset(memory, grey, size), "cudaMemset");
+        av->buf[0] = av_buffer_create(static_cast<uint8_t*>(memory), size,
+                                      freeDevice, nullptr, 0);
+        if (!av->buf[0])
+        {
+            cudaFree(memory);
+            throw std::bad_alloc();
+        }
+        av->data[0] = av->buf[0]->data;
+        av->data[1] = av->buf[0]->data + lumaBytes;
+        av->linesize[0] = lineSize;
+        av->linesize[1] = lineSize;
+        return frame;
+    }
+#endif // CUDA_ENABLED
+    FF_CHECK(av_frame_get_buffer(av, 0));
+    for (int plane = 0; plane < 2; ++plane)
+    {
+        const int rows = plane == 0 ? height : height / 2;
+        std::memset(av->data[plane], grey,
+                    static_cast<size_t>(av->linesize[plane]) * rows);
+    }
+    return frame;
+}
+
+void fillPattern(std::vector<uint8_t>& rgb, int width, int height, int index)
+{
+    rgb.resize(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t* row = rgb.data() + static_cast<size_t>(y) * width * 3;
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 3] = static_cast<uint8_t>(x + index * 4);
+            row[x * 3 + 1] = static_cast<uint8_t>(y + index * 2);
+            row[x * 3 + 2] = static_cast<uint8_t>((x ^ y) + index);
+        }
+    }
+}
+
+std::string syntheticClip(const std::string& codec, const Resolution& resolution)
+{
+    const auto known = std::find_if(std::begin(clipEncoders), std::end(clipEncoders),
+                                    [&](const ClipEncoder& entry)
+                                    { return codec == entry.codec; });
+    if (known == std::end(clipEncoders))
+    {
+        throw std::invalid_argument("No synthetic clips for codec " + codec);
+    }
+
+    const char* configured = std::getenv("CELUX_BENCH_DIR");
+    const std::filesystem::path directory =
+        configured ? std::filesystem::path(configured)
+                   : std::filesystem::temp_directory_path() / "celux_bench";
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path path =
+        directory / (codec + "_" + resolution.name + ".mkv");
+    if (std::filesystem::exists(path))
+    {
+        return path.string();
+    }
+
+    celux::Encoder::VideoProperties props;
+    props.width = resolution.width;
+    props.height = resolution.height;
+    props.fps = 30.0;
+    props.pixelFormat = AV_PIX_FMT_NV12;
+    props.codecName = known->encoder;
+    celux::Encoder::Options options;
+    options.preset = known->preset;
+    options.gopSize = 30;
+    options.maxBFrames = 2;
+
+    // Written under a temporary name, so an interrupted run leaves no clip
+    const std::filesystem::path partial = path.string() + ".part.mkv";
+    {
+        auto encoder = celux::Factory::createEncoder(
+            celux::backend::CPU, partial.string(), props,
+            celux::Factory::createConverter(celux::backend::CPU,
+                                            celux::ConversionType::RGBToNV12,
+                                            celux::dataType::UINT8),
+            options);
+        std::vector<uint8_t> rgb;
+        for (int i = 0; i < ClipFrames; ++i)
+        {
+            fillPattern(rgb, resolution.width, resolution.height, i);
+            if (!encoder->encodeFrame(rgb.data()))
+            {
+                throw std::runtime_error("Failed to encode " + partial.string());
+            }
+        }
+        encoder->close();
+    }
+    std::filesystem::rename(partial, path);
+    return path.string();
+}
+
+void Latencies::start()
+{
+    started = std::chrono::steady_clock::now();
+}
+
+void Latencies::stop()
+{
+    milliseconds.push_back(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - started)
+                               .count());
+}
+
+void Latencies::report(benchmark::State& state, int64_t frames)
+{
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(frames),
+                                               benchmark::Counter::kIsRate);
+    state.SetItemsProcessed(frames);
+    if (milliseconds.empty())
+    {
+        return;
+    }
+    std::sort(milliseconds.begin(), milliseconds.end());
+    const auto percentile = [&](double p)
+    {
+        const size_t rank = static_cast<size_t>(p * (milliseconds.size() - 1) + 0.5);
+        return milliseconds[rank];
+    };
+    state.counters["p50_ms"] = percentile(0.50);
+    state.counters["p90_ms"] = percentile(0.90);
+    state.counters["p99_ms"] = percentile(0.99);
+}
+
+} // namespace celux::bench
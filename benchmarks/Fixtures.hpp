@@ -0,0 +1,110 @@
+// Fixtures.hpp
+#pragma once
+
+#include "Factory.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace celux::bench
+{
+
+struct Resolution
+{
+    const char* name;
+    int width;
+    int height;
+};
+
+// 720p to 8K UHD
+extern const std::vector<Resolution> resolutions;
+
+/**
+ * @brief Whether the CUDA backend was built and a device is present.
+ */
+bool cudaAvailable();
+
+const char* backendName(celux::backend backend);
+const char* dataTypeName(celux::dataType dtype);
+size_t elementSize(celux::dataType dtype);
+
+/**
+ * @brief Wait for all work queued on the backend's device.
+ */
+void synchronize(celux::backend backend);
+
+/**
+ * @brief Host memory, or device memory on the CUDA backend.
+ */
+class Buffer
+{
+  public:
+    Buffer(celux::backend backend, size_t bytes);
+    ~Buffer();
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    void* data() const;
+    size_t size() const;
+
+    /**
+     * @brief Copy `bytes` of host data to the start of the buffer.
+     */
+    void upload(const void* source, size_t bytes);
+
+  private:
+    celux::backend backend;
+    void* memory = nullptr;
+    size_t bytes;
+};
+
+/**
+ * @brief A `width` x `height` NV12 (or P010) frame whose planes are in the
+ * backend's memory, filled with mid grey, as decoders hand them to converters.
+ */
+celux::Frame makeFrame(celux::backend backend, AVPixelFormat format, int width,
+                       int height);
+
+/**
+ * @brief Deterministic RGB24 test pattern for frame `index`: gradients moving at
+ * different speeds per channel, so consecutive frames differ everywhere.
+ */
+void fillPattern(std::vector<uint8_t>& rgb, int width, int height, int index);
+
+/**
+ * @brief Path of a synthetic clip, encoded on first use and cached afterwards.
+ *
+ * Clips go to $CELUX_BENCH_DIR, or `celux_bench` in the temp directory. Every
+ * clip of one codec and size is the same file, so runs decode the same bits.
+ *
+ * @param codec "h264", "hevc" or "av1", encoded by libx264, libx265 and
+ * libsvtav1 respectively.
+ * @throws std::exception if the encoder is not available.
+ */
+std::string syntheticClip(const std::string& codec, const Resolution& resolution);
+
+/**
+ * @brief Per-frame latency of a benchmark loop.
+ *
+ * report() sets p50_ms, p90_ms and p99_ms counters, and fps as frames per
+ * second of the time measured by the benchmark.
+ */
+class Latencies
+{
+  public:
+    void start();
+    void stop();
+    void report(benchmark::State& state, int64_t frames);
+
+  private:
+    std::chrono::steady_clock::time_point started;
+    std::vector<double> milliseconds;
+};
+
+void registerConvertBenchmarks();
+void registerDecodeBenchmarks();
+void registerEncodeBenchmarks();
+
+} // namespace celux::bench
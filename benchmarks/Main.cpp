@@ -0,0 +1,23 @@
+// Throughput and latency of decoding, converting and encoding across backends,
+// codecs, data types and resolutions. Run with --help for Google Benchmark's
+// options, e.g. --benchmark_filter=Decode/cuda or --benchmark_format=json.
+#include "Fixtures.hpp"
+
+int main(int argc, char** argv)
+{
+    // Benchmarks are registered at run time, for the backends present here
+    celux::bench::registerConvertBenchmarks();
+    celux::bench::registerDecodeBenchmarks();
+    celux::bench::registerEncodeBenchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    // Keep FFmpeg's per-stream messages out of the tables
+    av_log_set_level(AV_LOG_ERROR);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
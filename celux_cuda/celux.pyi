@@ -1,4 +1,5 @@
-from typing import List, Dict, Optional, Any, Union, TypedDict, Tuple
+import os
+from typing import List, Dict, Optional, Any, Union, TypedDict, Tuple, BinaryIO
 import torch
 
 class VideoProperties(TypedDict):
@@ -9,16 +10,124 @@ class VideoProperties(TypedDict):
     total_frames: int
     pixel_format: str
     has_audio: bool
+    time_base: Tuple[int, int]
 
 class VideoReader:
-    def __init__(self, input_path: str, device: str = "cuda", d_type: str = "uint8") -> None:
+    def __init__(self, input_path: Union[str, "os.PathLike[str]", bytes, bytearray, memoryview, BinaryIO], device: str = "cuda", d_type: str = "uint8", prefetch: int = 0, batch_size: int = 0, pool_size: int = 2, index_cache: str = "", exact_frame_count: bool = False, decoder_threads: int = 0, thread_type: str = "auto", extra_hw_frames: int = 0, layout: str = "hwc", mean: Optional[List[float]] = None, std: Optional[List[float]] = None, conversion_threads: int = 1, resize: Optional[Tuple[int, int]] = None, crop: Optional[Tuple[int, int, int, int]] = None, interpolation: str = "bilinear", hw_resize: Optional[Tuple[int, int]] = None, hw_crop: Optional[Tuple[int, int, int, int]] = None, stream: Optional[Union[torch.cuda.Stream, int]] = None, share_context: bool = True, io_buffer_size: int = 65536, input_format: str = "", format_options: Optional[Dict[str, str]] = None, skip_stream_info: bool = False, stride: int = 1, keyframes_only: bool = False, return_pts: bool = False, output_device: str = "") -> None:
         """
         Initialize the VideoReader object.
 
         Args:
-            input_path (str): Path to the video file.
-            device (str): Device to be used. Default is "cuda".
-            d_type (str): Data type of the frames (e.g., "uint8"). Default is "uint8".
+            input_path: Path to the video file, a bytes-like object holding the
+                whole file (read in place), or a binary file object read through
+                `readinto`/`read` and, when `seekable()`, `seek`/`tell`. Inputs
+                without a path don't use `index_cache`.
+            device (str): Device to be used: "cpu", "cuda" (the first GPU) or
+                "cuda:N". Default is "cuda". Decoding, conversion and the returned
+                frames all stay on the selected GPU.
+            d_type (str): Data type of the frames: "uint8" (default), "float32",
+                "float16", or "uint16" for 10-bit and deeper sources on cuda.
+            prefetch (int): Number of frames to decode ahead on a background thread.
+                0 (default) decodes on the calling thread.
+            batch_size (int): When greater than 0, `read_frame` and iteration return
+                `[batch_size, H, W, 3]` tensors. The last batch may be shorter.
+            pool_size (int): Number of preallocated frames recycled between reads.
+                Default is 2. A frame returns to the pool once it is no longer
+                referenced (or after `release`); holding more frames than this
+                falls back to fresh allocations.
+            index_cache (str): Where to keep the keyframe index used by
+                `seek_to_frame` between opens. "sidecar" stores `<video>.cxidx`
+                next to the video, any other non-empty value is a cache directory.
+                Indexes are keyed by path, size and modification time. Empty
+                (default) rebuilds the index in every reader.
+            exact_frame_count (bool): Count frames exactly instead of estimating
+                them from duration and fps. Uses the container's count for MP4/MOV
+                and otherwise a packet-only scan, which also builds (and, with
+                `index_cache`, stores) the seek index. Default is False.
+            decoder_threads (int): Threads used by the codec. 0 (default) uses one
+                per core; lower it when running many readers side by side.
+            thread_type (str): "frame", "slice" or "auto" (default, both) codec
+                threading.
+            extra_hw_frames (int): Extra surfaces in the hardware decoder's frame
+                pool. Raise it when holding several `read_raw` frames at once so
+                the decoder doesn't run out of surfaces. Default is 0.
+            layout (str): "hwc" (default) for `[H, W, 3]` frames or "chw" for
+                planar `[3, H, W]` frames, written directly by the conversion
+                kernel.
+            mean (Optional[List[float]]): Per-channel RGB mean subtracted inside the
+                conversion kernel, applied to values in [0, 1]. Requires `std` and a
+                floating point `d_type`. CUDA only.
+            std (Optional[List[float]]): Per-channel RGB standard deviation the
+                values are divided by, see `mean`.
+            conversion_threads (int): Threads the CPU backend splits each frame's
+                color conversion across, in horizontal bands. 0 uses one per core;
+                default is 1. Ignored on CUDA.
+            resize (Optional[Tuple[int, int]]): Output `(width, height)`. Frames are
+                scaled inside the conversion, so no full resolution RGB frame is
+                ever written. Default keeps the (cropped) source size.
+            crop (Optional[Tuple[int, int, int, int]]): Source rectangle
+                `(x, y, width, height)` to convert, applied before `resize`. `x`
+                and `y` must be even. Default is the whole frame.
+            interpolation (str): Resize filter, "bilinear" (default) or "area".
+                "area" averages every source pixel an output pixel covers and
+                suits large downscales.
+            hw_resize (Optional[Tuple[int, int]]): `(width, height)` NVDEC scales
+                frames to before they leave the decoder, using the stream's
+                `*_cuvid` decoder. Decoded surfaces are allocated at this size,
+                which lowers VRAM use per stream. `crop`/`resize` then apply to
+                the scaled frames, and `get_properties` reports the scaled size.
+                CUDA only.
+            hw_crop (Optional[Tuple[int, int, int, int]]): `(x, y, width, height)`
+                rectangle NVDEC crops to before `hw_resize`. `x` and `y` must be
+                even. CUDA only.
+            stream (Optional[Union[torch.cuda.Stream, int]]): Stream to run the color
+                conversion on, e.g. `torch.cuda.current_stream()`, so work queued
+                on it afterwards sees each frame without a `sync()`. Accepts a raw
+                `cudaStream_t` as an int. With `output_device`, the stream the
+                copies to the GPU run on. CUDA only.
+            share_context (bool): Decode in one CUDA device context shared by all
+                readers and writers on the primary CUDA context, instead of one
+                context per reader. CUDA only.
+            io_buffer_size (int): Bytes read per callback for bytes-like and file
+                object inputs. Default is 64 KiB.
+            input_format (str): Demuxer to use instead of probing for one, e.g.
+                "matroska", "mpegts" or "h264". Default probes.
+            format_options (Optional[Dict[str, str]]): Demuxer and protocol
+                options, e.g. `{"probesize": "32768", "analyzeduration": "0",
+                "fflags": "nobuffer"}` or `{"reconnect": "1"}` for http inputs.
+                Options neither the demuxer nor the protocol takes raise
+                ValueError.
+            skip_stream_info (bool): Don't probe the start of the streams when
+                the container header already gives the video's codec, size,
+                frame rate and duration; a missing pixel format is parsed from
+                the first video packet. Saves most of the open time on large
+                MKV/TS files and remote inputs. Inputs whose header is
+                incomplete are still probed. Default is False.
+            stride (int): Return every `stride`-th frame: frames 0, stride,
+                2 * stride, ... (counted from the start or a seek). Skipped
+                frames are never converted, and whole GOPs between two returned
+                frames are not decoded, using the seek index of
+                `seek_to_frame`. Unless `index_cache` already holds it, the
+                first strided read builds that index, reading every packet of
+                the file once without decoding it. `len()` counts the frames
+                returned. Default 1.
+            keyframes_only (bool): Decode only keyframes, dropping all other
+                packets as they are read; with `stride`, every `stride`-th
+                keyframe. Much faster for thumbnails and scene detection.
+                Frame ranges can't be used with it, and `len()` still counts
+                every frame. Default is False.
+            return_pts (bool): Return `(frame, seconds, pts)` from `read_frame`
+                and iteration, and `(frames, seconds, pts)` from `read_batch`
+                and `get_frames_at`. `pts` is in units of the stream's
+                `time_base` (see `get_properties`) and `seconds` is
+                `pts * time_base`; both are None (NaN in batches) for frames
+                without a timestamp. Default is False.
+            output_device (str): "cuda" or "cuda:N" to return frames decoded on
+                the CPU (`device="cpu"`) as tensors on that GPU. Frames are
+                converted into pinned host buffers and copied asynchronously
+                while the next frame decodes, ordered with the current stream
+                (or `stream`) like CUDA-decoded frames. Default returns frames
+                on `device`.
         """
         ...
 
@@ -48,11 +157,77 @@ class VideoReader:
         """
         Read a frame from the video.
 
+        The frame is decoded directly into a pooled tensor without an extra copy.
+        The tensor is never overwritten while it is still referenced, so frames can
+        be kept without cloning them.
+
+        On CUDA the conversion may still be running when this returns; PyTorch work
+        queued afterwards on the current stream waits for it on the GPU, so there
+        is no need to call `sync()`.
+
         Returns:
             Union[torch.Tensor: The frame data, as a torch.Tensor.
         """
         ...
 
+    def read_batch(self, n: int) -> torch.Tensor:
+        """
+        Read up to `n` frames into a single BHWC tensor.
+
+        Frames are decoded directly into slices of one preallocated tensor, with a
+        single GIL release and (on CUDA) a single wait of the current stream on the
+        conversions per batch.
+
+        Args:
+            n (int): Number of frames to read.
+
+        Returns:
+            torch.Tensor: Tensor of shape `[k, H, W, 3]` (`[k, 3, H, W]` with
+            `layout="chw"`), where `k == n` except for the final batch of the
+            video. Reused by the next batch read.
+
+        Raises:
+            StopIteration: When no more frames are available.
+        """
+        ...
+
+    def read_raw(self, dlpack: bool = False) -> List[Any]:
+        """
+        Read the next frame as its decoded planes, skipping color conversion.
+
+        Each plane is a 2D `[rows, row elements]` tensor aliasing the decoder's
+        surface, with the surface pitch as its row stride: for NV12 these are the
+        Y plane `[H, W]` and the interleaved UV plane `[H / 2, W]`. On CUDA the
+        planes stay in device memory. Formats deeper than 8 bits use uint16. The
+        surface stays referenced until all of its planes are released.
+
+        Not available together with `prefetch`.
+
+        Args:
+            dlpack (bool): Return DLPack capsules instead of tensors.
+
+        Returns:
+            List[Any]: One tensor (or capsule) per plane.
+
+        Raises:
+            StopIteration: When no more frames are available.
+        """
+        ...
+
+    def release(self, frame: torch.Tensor) -> bool:
+        """
+        Return a frame to the pool before its last reference is dropped.
+
+        The frame's memory may be overwritten by any later read.
+
+        Args:
+            frame (torch.Tensor): Frame previously returned by `read_frame`.
+
+        Returns:
+            bool: True if the frame belonged to the pool.
+        """
+        ...
+
     def seek(self, timestamp: float) -> bool:
         """
         Seek to a specific timestamp in the video.
@@ -65,6 +240,45 @@ class VideoReader:
         """
         ...
 
+    def get_frames_at(self, times: List[float]) -> torch.Tensor:
+        """
+        Read the frames shown at each of `times`.
+
+        Times are mapped to frames through the seek index of `seek_to_frame` and
+        decoded in presentation order, so a GOP holding several requested frames
+        is decoded once. Times falling on the same frame share it. Reading then
+        continues after the last frame decoded.
+
+        Args:
+            times (List[float]): Seconds, on the same timeline as the `seconds`
+                returned with `return_pts=True`.
+
+        Returns:
+            torch.Tensor: Tensor of shape `[len(times), H, W, 3]` in the order
+            of `times`.
+
+        Raises:
+            IndexError: If a time is outside the video.
+            RuntimeError: If the stream has no timestamps to index.
+        """
+        ...
+
+    def seek_to_frame(self, frame_number: int) -> bool:
+        """
+        Seek so that the next frame read is exactly `frame_number`.
+
+        Decoding restarts from the preceding keyframe and the frames before the
+        target are discarded without color conversion. The first call scans the
+        file's packets (without decoding) to build a keyframe index.
+
+        Args:
+            frame_number (int): Zero-based frame number in presentation order.
+
+        Returns:
+            bool: True if seek was successful, otherwise False.
+        """
+        ...
+
     def supported_codecs(self) -> List[str]:
         """
         Get a list of supported video codecs.
@@ -81,16 +295,44 @@ class VideoReader:
         Returns:
             VideoProperties: A dictionary containing specific video properties.
             Contains the following:
-            - width: Width of the video.
-            - height: Height of the video.
+            - width: Width of decoded frames (after `hw_crop`/`hw_resize`, before
+              `crop`/`resize`).
+            - height: Height of decoded frames, see `width`.
             - fps: Frames per second of the video.
             - duration: Duration of the video in seconds.
-            - total_frames: Total number of frames in the video.
+            - total_frames: Total number of frames in the video. Exact with
+              `exact_frame_count=True`, otherwise taken from the container header
+              or estimated from duration and fps.
             - pixel_format: Pixel format of the video.
             - has_audio: Whether the video has an audio stream.
         """
         ...
 
+    def stats(self, reset: bool = False) -> Dict[str, Any]:
+        """
+        Time spent in each stage of decoding since opening or the last reset.
+
+        Use it to tell whether a slow reader is bound by I/O, the decoder, the
+        conversion or the Python code consuming the frames. Built with
+        `ENABLE_NVTX`, the same stages also show up as NVTX ranges in Nsight
+        Systems.
+
+        Args:
+            reset (bool): Zero the counters after reading them.
+
+        Returns:
+            Dict[str, Any]: `{"seconds": float, "calls": int}` for each of
+            `demux`, `send_packet`, `receive_frame`, `convert` (host time of
+            the conversion call) and `convert_kernel` (GPU time of the
+            conversion kernels that have finished; CUDA only), plus `frames`
+            (frames decoded) and `queue_depth` (frames waiting in the prefetch
+            queue). The encode-side stages are always zero here.
+
+        Raises:
+            RuntimeError: If the reader is closed.
+        """
+        ...
+
     def __len__(self) -> int:
         """
         Get the total number of frames in the video.
@@ -146,7 +388,10 @@ class VideoReader:
 
     def sync(self) -> None:
         """
-        Synchronize the video reader (if required for hardware operations).
+        Block until every queued conversion has finished.
+
+        Only needed when frames are used outside PyTorch's current stream, e.g.
+        on another stream or through a raw device pointer.
         """
         ...
 
@@ -156,3 +401,64 @@ class VideoReader:
         """
         ...
 
+
+class VideoReaderPool:
+    def __init__(self, device: str = "cuda", d_type: str = "uint8", workers: int = 0, open_decoders: int = 1, decoder_threads: int = 1, thread_type: str = "auto", layout: str = "hwc", mean: Optional[List[float]] = None, std: Optional[List[float]] = None, resize: Optional[Tuple[int, int]] = None, crop: Optional[Tuple[int, int, int, int]] = None, interpolation: str = "bilinear", hw_resize: Optional[Tuple[int, int]] = None, hw_crop: Optional[Tuple[int, int, int, int]] = None, index_cache: str = "", skip_stream_info: bool = False, share_context: bool = True) -> None:
+        """
+        Start a pool of decode threads reading clips from many videos.
+
+        Args:
+            device (str): "cpu", "cuda" or "cuda:N". Default is "cuda".
+            d_type (str): Data type of the frames, see `VideoReader`.
+            workers (int): Decode threads. 0 (default) uses one per core.
+            open_decoders (int): Files each worker keeps open between calls,
+                closing the least recently used first. Default is 1.
+            decoder_threads (int): Codec threads per decoder. Default is 1, since
+                the pool already decodes one file per worker; 0 uses one per core.
+            thread_type (str): "frame", "slice" or "auto" (default) codec
+                threading.
+            layout, mean, std, resize, crop, interpolation, hw_resize, hw_crop:
+                As in `VideoReader`, applied to every clip.
+            index_cache (str): Where to keep seek indexes between opens, see
+                `VideoReader`.
+            skip_stream_info (bool): Open files from their header alone when it
+                is complete, see `VideoReader`.
+            share_context (bool): Decode in the shared CUDA device context.
+        """
+        ...
+
+    def read_clips(self, clips: List[Tuple[Union[str, "os.PathLike[str]"], int, int]]) -> List[torch.Tensor]:
+        """
+        Decode `(path, start, n)` clips in parallel.
+
+        Clips of one file are read by one worker in order of `start`, seeking
+        only between clips that don't follow each other. With fewer files than
+        workers, the clips of a file are split into runs of consecutive clips
+        read by several workers. Frames are exact, as with
+        `VideoReader.seek_to_frame`.
+
+        Returns:
+            List[torch.Tensor]: One `[n, H, W, 3]` (or `[n, 3, H, W]`) tensor
+            per clip, in the order given, ready to use on any stream. Clips
+            running past the end of their file are shorter. With `resize`, all
+            clips can be stacked into one batch with `torch.stack`.
+
+        Raises:
+            IndexError: If a clip starts outside its file.
+        """
+        ...
+
+    @property
+    def workers(self) -> int:
+        """Number of decode threads."""
+        ...
+
+    def close(self) -> None:
+        """
+        Stop the workers and close every open file.
+        """
+        ...
+
+    def __enter__(self) -> 'VideoReaderPool': ...
+
+    def __exit__(self, exc_type: Optional[type], exc_value: Optional[BaseException], traceback: Optional[Any]) -> bool: ...
@@ -36,6 +36,7 @@ extern "C"
 #include <libswscale/swscale.h>
 
 }
+#include "Logger.hpp"
 
 namespace celux
 {
@@ -101,7 +102,7 @@ inline void logSupportedHardwareConfigs(const AVCodec* codec)
         const char* deviceTypeName = av_hwdevice_get_type_name(hwConfig->device_type);
         if (deviceTypeName)
         {
-            std::cout << "Supported hardware config: " << deviceTypeName << std::endl;
+            CELUX_DEBUG("Supported hardware config: " << deviceTypeName);
         }
     }
 }
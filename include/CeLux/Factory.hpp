@@ -21,21 +21,23 @@ class Factory
      * @param backend Backend type (CPU or CUDA).
      * @param filename Path to the video file.
      * @param converter Unique pointer to the IConverter instance.
+     * @param options Decoder configuration (threading, ...).
      * @return std::unique_ptr<Decoder> Pointer to the created Decoder.
      */
     static std::unique_ptr<Decoder>
     createDecoder(celux::backend backend, const std::string& filename,
-                  std::unique_ptr<celux::conversion::IConverter> converter)
+                  std::unique_ptr<celux::conversion::IConverter> converter,
+                  const Decoder::Options& options = Decoder::Options())
     {
         switch (backend)
         {
         case celux::backend::CPU:
             return std::make_unique<celux::backends::cpu::Decoder>(
-                filename, std::move(converter));
+                filename, std::move(converter), options);
 #ifdef CUDA_ENABLED
         case celux::backend::CUDA:
             return std::make_unique<celux::backends::gpu::cuda::Decoder>(
-                filename, std::move(converter));
+                filename, std::move(converter), options);
 #endif // CUDA_ENABLED
         default:
             throw std::invalid_argument("Unsupported backend: " +
@@ -50,30 +52,27 @@ class Factory
      * @param filename Path to the output video file.
      * @param props Video properties for the encoder (e.g., width, height, fps).
      * @param converter Unique pointer to the IConverter instance.
+     * @param options Encoder configuration (rate control, GOP, device context).
      * @return std::unique_ptr<Encoder> Pointer to the created Encoder.
      */
     static std::unique_ptr<Encoder>
     createEncoder(celux::backend backend, const std::string& filename,
                   const Encoder::VideoProperties& props,
-                  std::unique_ptr<celux::conversion::IConverter> converter)
+                  std::unique_ptr<celux::conversion::IConverter> converter,
+                  const Encoder::Options& options = Encoder::Options())
     {
-        int width = props.width;
-        int height = props.height;
-        int fps = props.fps;
-        std::cout << "Creating Encoder with width: " << width << ", height: " << height
-				  << ", fps: " << fps << std::endl;
+        CELUX_DEBUG("Creating " << props.codecName << " encoder, " << props.width
+                                << "x" << props.height << " at " << props.fps
+                                << " fps");
         switch (backend)
-
         {
-            std::cout << "Creating CPU encoder\n" << std::endl;
         case celux::backend::CPU:
             return std::make_unique<celux::backends::cpu::Encoder>(
-                filename, props, std::move(converter));
+                filename, props, std::move(converter), options);
 #ifdef CUDA_ENABLED 
         case celux::backend::CUDA:
-            std::cout << "Creating CUDA encoder\n" << std::endl;
             return std::make_unique<celux::backends::gpu::cuda::Encoder>(
-                filename, props, std::move(converter));
+                filename, props, std::move(converter), options);
 #endif // CUDA_ENABLED
         default:
             throw std::invalid_argument("Unsupported backend: " +
@@ -87,12 +86,14 @@ class Factory
      *
      * @param device Backend type (CPU or CUDA).
      * @param type Conversion type (e.g., RGBToNV12).
-     * @param dtype Data type (UINT8, FLOAT16, FLOAT32).
+     * @param dtype Data type (UINT8, UINT16, FLOAT16, FLOAT32).
+     * @param stream CUDA only: cudaStream_t to queue conversions on, borrowed
+     * for the converter's lifetime. Null gives the converter its own stream.
      * @return std::unique_ptr<IConverter> Pointer to the created Converter.
      */
     static std::unique_ptr<celux::conversion::IConverter>
     createConverter(celux::backend device, celux::ConversionType type,
-                    celux::dataType dtype)
+                    celux::dataType dtype, void* stream = nullptr)
     {
         // CPU only supports float32 and uint8
         if (device == celux::backend::CPU && dtype == celux::dataType::FLOAT16)
@@ -151,6 +152,13 @@ class Factory
                 }
                 break;
 
+            case celux::ConversionType::NV12ToNV12:
+                if (dtype == celux::dataType::UINT8)
+                {
+                    return std::make_unique<
+                        celux::conversion::cpu::NV12ToNV12<uint8_t>>();
+                }
+                break;
             default:
                 throw std::runtime_error("Unsupported conversion type for CPU backend");
             }
@@ -160,23 +168,24 @@ class Factory
         // For CUDA backend
         if (device == celux::backend::CUDA)
         {
+            cudaStream_t cudaStream = static_cast<cudaStream_t>(stream);
             switch (type)
             {
             case celux::ConversionType::RGBToNV12:
                 if (dtype == celux::dataType::UINT8)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::RGBToNV12<uint8_t>>();
+                        celux::conversion::gpu::cuda::RGBToNV12<uint8_t>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT16)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::RGBToNV12<half>>();
+                        celux::conversion::gpu::cuda::RGBToNV12<half>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT32)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::RGBToNV12<float>>();
+                        celux::conversion::gpu::cuda::RGBToNV12<float>>(cudaStream);
                 }
                 break;
 
@@ -184,17 +193,17 @@ class Factory
                 if (dtype == celux::dataType::UINT8)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToRGB<uint8_t>>();
+                        celux::conversion::gpu::cuda::NV12ToRGB<uint8_t>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT16)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToRGB<half>>();
+                        celux::conversion::gpu::cuda::NV12ToRGB<half>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT32)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToRGB<float>>();
+                        celux::conversion::gpu::cuda::NV12ToRGB<float>>(cudaStream);
                 }
                 break;
 
@@ -202,17 +211,17 @@ class Factory
                 if (dtype == celux::dataType::UINT8)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::BGRToNV12<uint8_t>>();
+                        celux::conversion::gpu::cuda::BGRToNV12<uint8_t>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT16)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::BGRToNV12<half>>();
+                        celux::conversion::gpu::cuda::BGRToNV12<half>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT32)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::BGRToNV12<float>>();
+                        celux::conversion::gpu::cuda::BGRToNV12<float>>(cudaStream);
                 }
                 break;
 
@@ -220,17 +229,48 @@ class Factory
                 if (dtype == celux::dataType::UINT8)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToBGR<uint8_t>>();
+                        celux::conversion::gpu::cuda::NV12ToBGR<uint8_t>>(cudaStream);
+                }
+                else if (dtype == celux::dataType::FLOAT16)
+                {
+                    return std::make_unique<
+                        celux::conversion::gpu::cuda::NV12ToBGR<half>>(cudaStream);
+                }
+                else if (dtype == celux::dataType::FLOAT32)
+                {
+                    return std::make_unique<
+                        celux::conversion::gpu::cuda::NV12ToBGR<float>>(cudaStream);
+                }
+                break;
+
+            case celux::ConversionType::NV12ToNV12:
+                if (dtype == celux::dataType::UINT8)
+                {
+                    return std::make_unique<
+                        celux::conversion::gpu::cuda::NV12ToNV12<uint8_t>>(cudaStream);
+                }
+                break;
+
+            case celux::ConversionType::P010ToRGB:
+                if (dtype == celux::dataType::UINT8)
+                {
+                    return std::make_unique<
+                        celux::conversion::gpu::cuda::P010ToRGB<uint8_t>>(cudaStream);
+                }
+                else if (dtype == celux::dataType::UINT16)
+                {
+                    return std::make_unique<
+                        celux::conversion::gpu::cuda::P010ToRGB<uint16_t>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT16)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToBGR<half>>();
+                        celux::conversion::gpu::cuda::P010ToRGB<half>>(cudaStream);
                 }
                 else if (dtype == celux::dataType::FLOAT32)
                 {
                     return std::make_unique<
-                        celux::conversion::gpu::cuda::NV12ToBGR<float>>();
+                        celux::conversion::gpu::cuda::P010ToRGB<float>>(cudaStream);
                 }
                 break;
 
@@ -8,6 +8,7 @@ namespace celux
 enum class dataType
 {
     UINT8,
+    UINT16,
     FLOAT16,
     FLOAT32,
 };
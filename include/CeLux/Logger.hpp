@@ -0,0 +1,106 @@
+// Logger.hpp
+#pragma once
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <string>
+
+namespace celux
+{
+
+enum class LogLevel
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+/**
+ * @class Logger
+ * @brief Process-wide leveled logger, silent by default.
+ *
+ * Messages below the level are dropped before they are formatted, so a disabled
+ * CELUX_LOG costs one relaxed atomic load on the decode and encode paths.
+ * Messages let through go to stderr, or to the sink, at most rateLimit per
+ * second; the ones over the limit are counted and the count is reported with
+ * the next message written. The level starts from CELUX_LOG_LEVEL if set.
+ */
+class Logger
+{
+  public:
+    using Sink = std::function<void(LogLevel, const std::string&)>;
+
+    static void setLevel(LogLevel level);
+    static LogLevel level();
+
+    /**
+     * @brief Whether a message of this level would be written.
+     */
+    static bool enabled(LogLevel level)
+    {
+        return level >= currentLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Messages written per second at most, 0 for no limit.
+     */
+    static void setRateLimit(int perSecond);
+
+    /**
+     * @brief Receives the messages instead of stderr; nullptr restores stderr.
+     *
+     * Called from whichever thread logs, decode and FFmpeg threads included.
+     */
+    static void setSink(Sink sink);
+
+    /**
+     * @brief Writes a message, subject to the rate limit. Callers check
+     * enabled() first, which CELUX_LOG does.
+     */
+    static void write(LogLevel level, const std::string& message);
+
+    /**
+     * @brief Routes FFmpeg's messages through the logger with
+     * av_log_set_callback, mapped to the closest level.
+     */
+    static void installFFmpegCallback();
+
+    /**
+     * @brief Parses "debug", "info", "warning", "error" or "off".
+     * @throws std::invalid_argument for any other name.
+     */
+    static LogLevel parseLevel(const std::string& name);
+    static const char* levelName(LogLevel level);
+
+  private:
+    static std::atomic<LogLevel> currentLevel;
+};
+
+} // namespace celux
+
+/**
+ * @brief Logs a stream expression, e.g. CELUX_LOG(LogLevel::Info, "fps " << fps),
+ * formatting it only when the level is enabled.
+ */
+#define CELUX_LOG(level, message)                                                 \
+    do                                                                            \
+    {                                                                             \
+        if (::celux::Logger::enabled(level))                                      \
+        {                                                                         \
+            std::ostringstream celuxLogStream;                                    \
+            celuxLogStream << message;                                            \
+            ::celux::Logger::write(level, celuxLogStream.str());                  \
+        }                                                                         \
+    } while (0)
+
+#define CELUX_DEBUG(message) CELUX_LOG(::celux::LogLevel::Debug, message)
+#define CELUX_INFO(message) CELUX_LOG(::celux::LogLevel::Info, message)
+#define CELUX_WARNING(message) CELUX_LOG(::celux::LogLevel::Warning, message)
+#define CELUX_ERROR(message) CELUX_LOG(::celux::LogLevel::Error, message)
+
+#endif // LOGGER_HPP
@@ -0,0 +1,194 @@
+// SPSCQueue.hpp
+#pragma once
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace celux
+{
+
+/**
+ * @class SPSCQueue
+ * @brief Bounded single-producer/single-consumer ring buffer.
+ *
+ * The fast path is lock-free: the producer only writes `tail`, the consumer only
+ * writes `head`. The mutex and condition variables are used solely to park a
+ * thread when the ring is full (producer) or empty (consumer), so each side blocks
+ * instead of spinning while the other one is busy decoding or computing.
+ *
+ * Exactly one thread may call push() and exactly one thread may call pop().
+ * close() may be called from either side to wake both and stop the exchange.
+ *
+ * @tparam T Element type. Must be default constructible and movable.
+ */
+template <typename T> class SPSCQueue
+{
+  public:
+    /**
+     * @brief Constructs a queue holding at most `capacity` elements.
+     *
+     * @param capacity Maximum number of queued elements (at least 1).
+     */
+    explicit SPSCQueue(size_t capacity)
+        : buffer(capacity > 0 ? capacity : 1), capacity(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /**
+     * @brief Push an element, blocking while the queue is full.
+     *
+     * @param item Element to enqueue.
+     * @return true if the element was queued, false if the queue was closed.
+     */
+    bool push(T item)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == capacity)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock,
+                         [&]
+                         {
+                             return closed.load(std::memory_order_acquire) ||
+                                    t - head.load(std::memory_order_acquire) <
+                                        capacity;
+                         });
+        }
+        if (closed.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        buffer[t % capacity] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        wake(notEmpty);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element, blocking while the queue is empty.
+     *
+     * Elements pushed before close() are still delivered.
+     *
+     * @param item Receives the dequeued element.
+     * @return true if an element was dequeued, false if the queue is closed and
+     * drained.
+     */
+    bool pop(T& item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock,
+                          [&]
+                          {
+                              return closed.load(std::memory_order_acquire) ||
+                                     tail.load(std::memory_order_acquire) != h;
+                          });
+            if (tail.load(std::memory_order_acquire) == h)
+            {
+                return false; // Closed and drained
+            }
+        }
+
+        item = std::move(buffer[h % capacity]);
+        buffer[h % capacity] = T();
+        head.store(h + 1, std::memory_order_release);
+        wake(notFull);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element if one is immediately available.
+     *
+     * @param item Receives the dequeued element.
+     * @return true if an element was dequeued.
+     */
+    bool tryPop(T& item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h)
+        {
+            return false;
+        }
+        item = std::move(buffer[h % capacity]);
+        buffer[h % capacity] = T();
+        head.store(h + 1, std::memory_order_release);
+        wake(notFull);
+        return true;
+    }
+
+    /**
+     * @brief Close the queue and wake any blocked producer or consumer.
+     */
+    void close()
+    {
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex);
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    /**
+     * @brief Drop all elements and reopen the queue.
+     *
+     * Must only be called while neither side is using the queue.
+     */
+    void reset()
+    {
+        for (auto& slot : buffer)
+        {
+            slot = T();
+        }
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        closed.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of queued elements (approximate while both sides are active).
+     */
+    size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    bool isClosed() const
+    {
+        return closed.load(std::memory_order_acquire);
+    }
+
+  private:
+    void wake(std::condition_variable& cv)
+    {
+        // Taking the lock orders the index update before a sleeper re-checks its
+        // predicate, so the notification cannot be lost.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        cv.notify_one();
+    }
+
+    std::vector<T> buffer;
+    const size_t capacity;
+    std::atomic<size_t> head{0}; ///< Next slot to pop (written by consumer).
+    std::atomic<size_t> tail{0}; ///< Next slot to push (written by producer).
+    std::atomic<bool> closed{false};
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+} // namespace celux
+
+#endif // SPSCQUEUE_HPP
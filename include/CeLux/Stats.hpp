@@ -0,0 +1,166 @@
+// Stats.hpp
+#pragma once
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef CELUX_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace celux
+{
+
+/**
+ * @class Stats
+ * @brief Time spent per pipeline stage by one decoder or encoder.
+ *
+ * Counters are atomic, so a decode thread can add to them while another thread
+ * reads them. Built with CELUX_NVTX, every timed scope is also an NVTX range
+ * named after its stage, so Nsight Systems shows the same split on its
+ * timeline.
+ */
+class Stats
+{
+  public:
+    enum class Stage
+    {
+        Demux,         // av_read_frame
+        SendPacket,    // avcodec_send_packet
+        ReceiveFrame,  // avcodec_receive_frame
+        Convert,       // IConverter::convert, host side
+        ConvertKernel, // GPU time of the conversion kernels
+        Transfer,      // Host-device copies of input or staged frames
+        Encode,        // avcodec_send_frame and avcodec_receive_packet
+        Mux,           // av_interleaved_write_frame
+        Count
+    };
+
+    static constexpr size_t StageCount = static_cast<size_t>(Stage::Count);
+
+    /**
+     * @brief snake_case name of a stage, as reported to Python.
+     */
+    static const char* name(Stage stage)
+    {
+        static const char* const names[StageCount] = {
+            "demux",          "send_packet", "receive_frame", "convert",
+            "convert_kernel", "transfer",    "encode",        "mux"};
+        return names[static_cast<size_t>(stage)];
+    }
+
+    /**
+     * @brief Adds the time from construction to destruction to a stage.
+     */
+    class Scope
+    {
+      public:
+        Scope(Stats& stats, Stage stage)
+            : stats(stats), stage(stage), start(std::chrono::steady_clock::now())
+        {
+#ifdef CELUX_NVTX
+            nvtxRangePushA(name(stage));
+#endif
+        }
+
+        ~Scope()
+        {
+#ifdef CELUX_NVTX
+            nvtxRangePop();
+#endif
+            stats.add(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        Stats& stats;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    Stats() = default;
+    Stats(const Stats&) = delete;
+    Stats& operator=(const Stats&) = delete;
+
+    void add(Stage stage, int64_t nanoseconds)
+    {
+        const size_t i = static_cast<size_t>(stage);
+        elapsed[i].fetch_add(nanoseconds, std::memory_order_relaxed);
+        counts[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count frames that went through the whole pipeline.
+     */
+    void addFrames(int64_t count)
+    {
+        frameCount.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    double seconds(Stage stage) const
+    {
+        return elapsed[static_cast<size_t>(stage)].load(std::memory_order_relaxed) *
+               1e-9;
+    }
+
+    /**
+     * @brief How many times a stage was timed.
+     */
+    int64_t calls(Stage stage) const
+    {
+        return counts[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+    }
+
+    int64_t frames() const
+    {
+        return frameCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Zero all counters. Scopes still open add to the new totals.
+     */
+    void reset()
+    {
+        for (size_t i = 0; i < StageCount; ++i)
+        {
+            elapsed[i].store(0, std::memory_order_relaxed);
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+        frameCount.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Take over another instance's counters and zero them, for the moves
+     * of the decoder or encoder that owns them.
+     */
+    void takeFrom(Stats& other)
+    {
+        for (size_t i = 0; i < StageCount; ++i)
+        {
+            elapsed[i].store(other.elapsed[i].exchange(0, std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+            counts[i].store(other.counts[i].exchange(0, std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+        }
+        frameCount.store(other.frameCount.exchange(0, std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<std::atomic<int64_t>, StageCount> elapsed{};
+    std::array<std::atomic<int64_t>, StageCount> counts{};
+    std::atomic<int64_t> frameCount{0};
+};
+
+} // namespace celux
+
+#endif // STATS_HPP
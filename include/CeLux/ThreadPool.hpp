@@ -0,0 +1,184 @@
+// ThreadPool.hpp
+#pragma once
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace celux
+{
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads running index-parallel jobs.
+ *
+ * parallelFor() hands out task indices to the workers and to the calling thread,
+ * and returns once every task has finished. It is meant for a few coarse tasks
+ * per call (e.g. one image band each), so indices are taken under a lock.
+ *
+ * parallelFor() must not be called concurrently or from inside a task.
+ */
+class ThreadPool
+{
+  public:
+    /**
+     * @brief Create a pool with `threads` total parallelism.
+     *
+     * The calling thread takes part in every job, so `threads - 1` workers are
+     * started.
+     *
+     * @param threads Number of threads to run tasks on (at least 1).
+     */
+    explicit ThreadPool(size_t threads)
+    {
+        for (size_t i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWorkers.notify_all();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Number of threads tasks run on, including the caller.
+     */
+    size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    /**
+     * @brief Run `task(0) ... task(count - 1)` in parallel and wait for them.
+     *
+     * @param count Number of tasks.
+     * @param task Callable invoked once per index.
+     * @throws The first exception thrown by a task, after all tasks finished.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& task)
+    {
+        if (workers.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        uint64_t current;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            jobCount = count;
+            nextIndex = 0;
+            pending = count;
+            error = nullptr;
+            current = ++generation;
+        }
+        wakeWorkers.notify_all();
+
+        runTasks(current);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [&] { return pending == 0; });
+        job = nullptr;
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+  private:
+    void workerLoop()
+    {
+        uint64_t seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorkers.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+            runTasks(seen);
+        }
+    }
+
+    // Runs tasks of job `gen` until none are left
+    void runTasks(uint64_t gen)
+    {
+        for (;;)
+        {
+            const std::function<void(size_t)>* fn;
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (generation != gen || nextIndex >= jobCount)
+                {
+                    return;
+                }
+                index = nextIndex++;
+                fn = job;
+            }
+
+            std::exception_ptr failure;
+            try
+            {
+                (*fn)(index);
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failure && !error)
+            {
+                error = failure;
+            }
+            if (--pending == 0)
+            {
+                jobDone.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobDone;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    size_t nextIndex = 0;
+    size_t pending = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+};
+
+} // namespace celux
+
+#endif // THREADPOOL_HPP
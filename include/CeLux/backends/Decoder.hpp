@@ -2,8 +2,12 @@
 #pragma once
 
 #include "FFException.hpp"
+#include "IOContext.hpp"
+#include "SeekIndex.hpp"
+#include "Stats.hpp"
 #include <Frame.hpp> 
 #include <Conversion.hpp>
+#include <map>
 
 namespace celux
 {
@@ -17,13 +21,78 @@ class Decoder
         int height;
         double fps;
         double duration;
-        double totalFrames;
+        int totalFrames;
         AVPixelFormat pixelFormat;
         bool hasAudio;
     };
+
+    /**
+     * @brief Per-instance decoder configuration, applied before the codec opens.
+     */
+    struct Options
+    {
+        // Decode threads; 0 lets FFmpeg pick one per core
+        int threadCount = 0;
+        // FF_THREAD_FRAME and/or FF_THREAD_SLICE
+        int threadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        // Surfaces added to the hardware frame pool beyond what the codec needs,
+        // so decoded frames can be held (e.g. by raw readers) without stalling
+        int extraHwFrames = 0;
+        // NVDEC scaling (CUDA backend). When set, the stream is decoded by its
+        // *_cuvid decoder, which crops to the rectangle (hwCropX, hwCropY,
+        // hwCropWidth, hwCropHeight) and scales it to hwResizeWidth x
+        // hwResizeHeight before the frame leaves the hardware. Zero sizes keep
+        // the rest of the frame / the cropped size.
+        int hwCropX = 0;
+        int hwCropY = 0;
+        int hwCropWidth = 0;
+        int hwCropHeight = 0;
+        int hwResizeWidth = 0;
+        int hwResizeHeight = 0;
+        // CUDA backend: device context to decode on (e.g.
+        // gpu::cuda::sharedDeviceContext), referenced by the decoder. Null creates
+        // a private context.
+        AVBufferRef* hwDeviceCtx = nullptr;
+        // CUDA backend: GPU ordinal the private context is created on
+        int hwDevice = 0;
+        // Read the input through these callbacks instead of opening the path,
+        // which is then only used in messages. Seeking needs a seek callback.
+        std::shared_ptr<IOCallbacks> io;
+        // Demuxer to use instead of probing for one, e.g. "matroska" or "mpegts"
+        std::string inputFormat;
+        // Passed to avformat_open_input: demuxer options (probesize,
+        // analyzeduration, fflags, ...) and the protocol's (reconnect,
+        // rw_timeout, buffer_size, ...). Options nothing takes are an error.
+        std::map<std::string, std::string> formatOptions;
+        // Skip avformat_find_stream_info, which reads and decodes the start of
+        // every stream, when the container header already describes the video
+        // stream (codec, size, frame rate and duration). A pixel format missing
+        // from the header is parsed from the first video packet. Probing still
+        // runs for inputs whose header leaves the rest out, and for unseekable
+        // inputs that need the packet parsed.
+        bool skipStreamInfo = false;
+        // Return every stride-th frame. The frames in between are decoded but
+        // not converted, and with a seek index whole GOPs between two returned
+        // frames are skipped without decoding them. The first strided read
+        // builds the index if it isn't loaded yet, a demux pass over the whole
+        // input; keyframesOnly doesn't need it.
+        int stride = 1;
+        // Decode keyframes only (AVDISCARD_NONKEY); other packets are dropped as
+        // they are read. Strides then count keyframes.
+        bool keyframesOnly = false;
+
+        bool hwScales() const
+        {
+            return hwCropX != 0 || hwCropY != 0 || hwCropWidth != 0 ||
+                   hwCropHeight != 0 || hwResizeWidth != 0 || hwResizeHeight != 0;
+        }
+    };
+
     Decoder() = default;
     // Constructor
     Decoder(std::unique_ptr<celux::conversion::IConverter> converter = nullptr);
+    Decoder(std::unique_ptr<celux::conversion::IConverter> converter,
+            const Options& options);
 
     // Destructor
     virtual ~Decoder();
@@ -38,7 +107,133 @@ class Decoder
 
     // Core methods
     virtual bool decodeNextFrame(void* buffer);
+
+    /**
+     * @brief Decode the next frame without converting it.
+     *
+     * For hardware decoders the frame stays on the device (AV_PIX_FMT_CUDA);
+     * `output` holds a reference to the decoder's surface until it is unref'd.
+     *
+     * @param output Receives the decoded frame.
+     * @return false at end of stream.
+     */
+    virtual bool decodeNextRawFrame(Frame& output);
     virtual bool seek(double timestamp);
+
+    /**
+     * @brief Position the decoder so the next decoded frame is `frameIndex`.
+     *
+     * Seeks to the keyframe preceding the target (using the seek index, built on
+     * first use) and decodes forward, discarding the frames in between without
+     * converting them. Falls back to a timestamp seek when the stream has no
+     * usable timestamps.
+     *
+     * @param frameIndex Zero-based frame number in presentation order.
+     * @return true if the target frame is ready to be returned.
+     */
+    virtual bool seekToFrame(int frameIndex);
+
+    /**
+     * @brief Frame on screen at `timestamp`: the last one presented at or before
+     * it, on the same timeline as seek() and lastFramePts().
+     *
+     * @param timestamp Seconds.
+     * @return Frame number, or -1 if the time is outside the video or the stream
+     * has no usable seek index.
+     */
+    int frameAtTime(double timestamp);
+
+    /**
+     * @brief PTS, in the video stream's time base, of the frame the last
+     * decodeNextFrame() or decodeNextRawFrame() returned; AV_NOPTS_VALUE if the
+     * frame had none.
+     */
+    int64_t lastFramePts() const;
+
+    /**
+     * @brief Position the demuxer on the keyframe at or before `frameIndex`, for
+     * readPacket().
+     *
+     * @return Frame number of that keyframe, or -1 if the stream has no usable
+     * timestamps or the frame is out of range.
+     */
+    int seekToKeyframe(int frameIndex);
+
+    /**
+     * @brief Read the next packet of the video stream without decoding it.
+     *
+     * Packets of other streams are skipped. The decoder does not see the packets
+     * read here, so decoding afterwards starts from a seek.
+     *
+     * @param packet Receives the packet; unref'd first.
+     * @return false at end of input.
+     */
+    bool readPacket(AVPacket* packet);
+
+    /**
+     * @brief Build the seek index if it has not been built yet.
+     *
+     * Leaves the demuxer at the end of the input; callers must seek afterwards.
+     */
+    const SeekIndex& getSeekIndex();
+
+    /**
+     * @brief The demuxed video stream, e.g. for its codec parameters and time
+     * base.
+     */
+    const AVStream* getVideoStream() const;
+
+    /**
+     * @brief Persist the seek index between opens of the same file.
+     *
+     * A previously saved index is loaded right away; otherwise the index is
+     * saved once it has been built. The cache is keyed by path, size and mtime.
+     *
+     * @param cache "sidecar" to store `<video>.cxidx` next to the video, or a
+     * directory to store indexes in. Empty disables caching.
+     */
+    void setSeekIndexCache(const std::string& cache);
+
+    /**
+     * @brief Exact number of frames in the video stream.
+     *
+     * Uses the container's frame count where it is authoritative (MP4/MOV) and
+     * otherwise the seek index, building it with a packet-only scan if needed.
+     * A scan rewinds the decoder to the first frame. Also updates totalFrames in
+     * getVideoProperties().
+     *
+     * @return int Frame count.
+     */
+    int countFrames();
+
+    /**
+     * @brief Replace the converter used by decodeNextFrame().
+     *
+     * Lets callers pick a converter once the stream is known, e.g. a 10-bit one
+     * for HDR sources. Pending work on the previous converter is finished first.
+     *
+     * @param converter New converter; may be null for raw decoding only.
+     */
+    void setConverter(std::unique_ptr<celux::conversion::IConverter> converter);
+    virtual void synchronize();
+
+    /**
+     * @brief Order work on `stream` after the frames converted so far, without
+     * blocking the host. See IConverter::orderBefore().
+     */
+    void orderBefore(void* stream);
+
+    /**
+     * @brief Order later conversions after the work already on `stream`. See
+     * IConverter::orderAfter().
+     */
+    void orderAfter(void* stream);
+
+    /**
+     * @brief Time spent per stage and frames returned since opening or the last
+     * Stats::reset(). Safe to read while another thread decodes.
+     */
+    Stats& getStats();
     virtual VideoProperties getVideoProperties() const;
     virtual bool isOpen() const;
     virtual void close();
@@ -51,11 +246,53 @@ class Decoder
 
     // Virtual methods for customization
     virtual void openFile(const std::string& filePath);
+    /**
+     * @brief Whether the header gives everything initialize() reads, so
+     * options.skipStreamInfo may skip probing. Fills in the video stream's pixel
+     * format from its first packet if the header lacks it.
+     */
+    bool describedByHeader();
     virtual void initHWAccel(); // Default does nothing
     virtual void findVideoStream();
     virtual void initCodecContext(const AVCodec* codec);
+
+    /**
+     * @brief Last chance to configure the codec before it opens.
+     *
+     * Called by initCodecContext() once the stream parameters are copied into
+     * `codecCtx`. The default does nothing.
+     *
+     * @param codecOptions Options passed to avcodec_open2, e.g. private options
+     * of the codec.
+     */
+    virtual void configureCodec(AVDictionary** codecOptions);
     virtual int64_t convertTimestamp(double timestamp) const;
 
+    /**
+     * @brief Decode the next frame into `frame` without converting it.
+     *
+     * @return false at end of stream.
+     */
+    bool receiveFrame();
+
+    /**
+     * @brief Leave the next frame to return in `frame`, skipping the frames
+     * options.stride leaves out.
+     *
+     * @return false at end of stream.
+     */
+    bool nextFrame();
+
+    /**
+     * @brief Seek the demuxer to `keyframe` (a PTS from the seek index) and reset
+     * the decoder, falling back to the keyframe's byte offset for demuxers that
+     * can only seek by bytes.
+     *
+     * @param target PTS of the frame the caller is after.
+     * @return false if the demuxer could not seek.
+     */
+    bool seekToKeyframePts(const SeekIndex& index, int64_t keyframe, int64_t target);
+
     // Virtual callback for hardware pixel formats
     virtual enum AVPixelFormat getHWFormat(AVCodecContext* ctx,
                                            const enum AVPixelFormat* pix_fmts);
@@ -99,14 +336,22 @@ class Decoder
     using AVPacketPtr = std::unique_ptr<AVPacket, AVPacketDeleter>;
 
     // Member variables
+    std::unique_ptr<IOContext> ioContext; // Custom input; outlives formatCtx
     AVFormatContextPtr formatCtx;
     AVCodecContextPtr codecCtx;
     AVPacketPtr pkt;
     int videoStreamIndex;
     VideoProperties properties;
     Frame frame;
+    Options options;
+    bool draining = false;     // End of input reached, decoder is being flushed
+    bool pendingFrame = false; // `frame` holds a decoded frame not yet returned
+    int64_t lastPts = AV_NOPTS_VALUE; // PTS of the most recently decoded frame
+    std::unique_ptr<SeekIndex> seekIndex;
+    std::string seekIndexCache; // Where to persist seekIndex, empty to disable
 
     std::unique_ptr<celux::conversion::IConverter> converter;
     AVBufferRefPtr hwDeviceCtx; // For hardware acceleration
+    Stats stats;
 };
 } // namespace celux
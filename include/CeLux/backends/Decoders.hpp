@@ -7,6 +7,7 @@
 
 #ifdef CUDA_ENABLED
 #include <backends/gpu/cuda/Decoder.hpp>
+#include <backends/gpu/cuda/DeviceContext.hpp>
 #endif
 
 #endif // DECODERS_HPP
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "FFException.hpp"
+#include "IOContext.hpp"
+#include "Stats.hpp"
 #include <Conversion.hpp>
 #include <Frame.hpp>
+#include <deque>
+#include <map>
 
 namespace celux
 {
@@ -14,13 +18,55 @@ class Encoder
         int width;
         int height;
         double fps;
+        // Exact frame rate, e.g. 30000/1001. {0, 1} derives it from fps, reading
+        // 29.97, 23.976, ... as their NTSC rates.
+        AVRational frameRate = {0, 1};
         AVPixelFormat pixelFormat;
+        // FFmpeg encoder name (e.g. "hevc_nvenc", "libx265") or codec name
+        // ("hevc"), which selects FFmpeg's default encoder for that codec
         std::string codecName;
     };
+
+    /**
+     * @brief Per-instance encoder configuration, applied before the codec opens.
+     *
+     * Empty strings and negative values keep the encoder's own default.
+     */
+    struct Options
+    {
+        std::string preset; // e.g. "p1".."p7" for NVENC, "veryfast" for x264
+        std::string tune;   // e.g. "hq", "ll", "film"
+        // "constqp", "vbr", "cbr" or "crf" (VBR with a CQ target on NVENC)
+        std::string rateControl;
+        int64_t bitrate = 0; // Target bits per second for "vbr"/"cbr"
+        // QP for "constqp", CRF for "crf", constant quality (CQ) for "vbr"
+        int quality = -1;
+        int gopSize = 12;
+        int maxBFrames = 0;
+        // Passed to avcodec_open2 last, so they override the settings above
+        std::map<std::string, std::string> codecOptions;
+        // CUDA backend: device context to encode on (e.g.
+        // gpu::cuda::sharedDeviceContext), referenced by the encoder. Null creates
+        // a private context.
+        AVBufferRef* hwDeviceCtx = nullptr;
+        // CUDA backend: GPU ordinal the private context is created on
+        int hwDevice = 0;
+        // File whose best audio stream is copied into the output without
+        // decoding, interleaved with the video and cut to its length
+        std::string audioSource;
+        // Write the output through these callbacks instead of creating the file.
+        // The output path then names the container, as a format ("matroska") or
+        // a file name ("out.mkv"). Without a seek callback, pick a container
+        // that needs no seeking back, e.g. matroska or mpegts.
+        std::shared_ptr<IOCallbacks> io;
+    };
+
     Encoder(const std::string& outputPath, const VideoProperties& props,
             std::unique_ptr<celux::conversion::IConverter> converter);
     Encoder() = default;
     Encoder(std::unique_ptr<celux::conversion::IConverter> converter = nullptr);
+    Encoder(std::unique_ptr<celux::conversion::IConverter> converter,
+            const Options& options);
 
     virtual ~Encoder();
 
@@ -34,6 +80,62 @@ class Encoder
 
     // Core methods
     virtual bool encodeFrame(void* buffer);
+
+    /**
+     * @brief Encode `count` frames stored back to back in `buffer`.
+     *
+     * All conversions are queued before waiting for them once, then the frames
+     * are sent to the encoder in order. Large batches are split into chunks of
+     * maxBatchFrames.
+     *
+     * @param frameBytes Distance in bytes between consecutive frames.
+     */
+    virtual bool encodeFrames(void* buffer, int count, size_t frameBytes);
+
+    /**
+     * @brief Encode a frame already in the encoder's input format, without
+     * converting it.
+     *
+     * For hardware encoders this takes device frames (AV_PIX_FMT_CUDA) on the
+     * encoder's device, e.g. decoder surfaces, which NVENC reads in place. The
+     * encoder keeps a reference to the frame's buffers until it is done with
+     * them; `input` itself may be reused once this returns.
+     *
+     * @throws CxException if the frame's format or size does not match the
+     * encoder's, or encoding fails.
+     */
+    void encodeRawFrame(const celux::Frame& input);
+
+    /**
+     * @brief Open `outputPath` for stream copy instead of encoding.
+     *
+     * The output gets one stream with the codec parameters of `source`, and takes
+     * already encoded packets through writePacket(). Timestamps are shifted so
+     * the output starts at zero.
+     *
+     * @throws CxException if the container can't carry the codec.
+     */
+    void openCopy(const std::string& outputPath, const AVStream* source);
+
+    /**
+     * @brief Mux an encoded packet, e.g. one read with Decoder::readPacket().
+     *
+     * @param packet Packet to write; left blank on return.
+     * @param timeBase Time base of the packet's timestamps.
+     */
+    void writePacket(AVPacket* packet, AVRational timeBase);
+
+    /**
+     * @brief Order later input conversions after the work already on `stream`,
+     * e.g. the kernels that produced the frames. See IConverter::orderAfter().
+     */
+    void orderAfter(void* stream);
+
+    /**
+     * @brief Time spent per stage and frames encoded since opening or the last
+     * Stats::reset(). Safe to read while another thread encodes.
+     */
+    Stats& getStats();
     virtual bool finalize();
     virtual bool isOpen() const;
     virtual void close();
@@ -47,6 +149,48 @@ class Encoder
     virtual void openFile(const std::string& outputPath, const VideoProperties& props);
     virtual void initHWAccel(); // Default does nothing
     virtual void initCodecContext(const AVCodec* codec, const VideoProperties& props);
+
+    /**
+     * @brief Last chance to configure the codec before it opens.
+     *
+     * Called by initCodecContext() once the generic parameters are set. The
+     * default maps options.rateControl and options.quality onto the options of
+     * FFmpeg's software encoders (x264, x265, SVT-AV1, ...).
+     *
+     * @throws std::invalid_argument on an unknown rate control mode.
+     * @param codecOptions Options passed to avcodec_open2, e.g. private options
+     * of the codec.
+     */
+    virtual void configureCodec(AVDictionary** codecOptions);
+
+    /**
+     * @brief Make `input` a surface the next conversion may write to.
+     *
+     * Called by encodeFrames() before each conversion. The default leaves the
+     * frame as it is.
+     */
+    virtual void prepareFrame(celux::Frame& input);
+
+    /**
+     * @brief Send one converted frame to the encoder and write the packets it
+     * returns.
+     */
+    void sendFrame(AVFrame* input);
+
+    /**
+     * @brief Open options.audioSource and add an output stream copying its audio.
+     * Called before the header is written.
+     *
+     * @throws CxException if the file has no audio stream.
+     */
+    void openAudioSource();
+
+    /**
+     * @brief Copy the audio packets that start before `timestamp`, so audio is
+     * muxed alongside the video written so far. Does nothing without an audio
+     * source.
+     */
+    void copyAudioUntil(int64_t timestamp, AVRational timeBase);
     virtual int64_t convertTimestamp(double timestamp) const;
 
     // Virtual callback for hardware pixel formats
@@ -58,7 +202,9 @@ class Encoder
     {
         void operator()(AVFormatContext* ctx) const
         {
-            if (!(ctx->oformat->flags & AVFMT_NOFILE))
+            // A custom pb belongs to its IOContext
+            if (!(ctx->oformat->flags & AVFMT_NOFILE) &&
+                !(ctx->flags & AVFMT_FLAG_CUSTOM_IO))
                 avio_closep(&ctx->pb);
             avformat_free_context(ctx);
         }
@@ -80,11 +226,21 @@ class Encoder
         }
     };
 
+    struct AVInputContextDeleter
+    {
+        void operator()(AVFormatContext* ctx) const
+        {
+            avformat_close_input(&ctx);
+        }
+    };
+
     using AVFormatContextPtr = std::unique_ptr<AVFormatContext, AVFormatContextDeleter>;
+    using AVInputContextPtr = std::unique_ptr<AVFormatContext, AVInputContextDeleter>;
     using AVCodecContextPtr = std::unique_ptr<AVCodecContext, AVCodecContextDeleter>;
     using AVBufferRefPtr = std::unique_ptr<AVBufferRef, AVBufferRefDeleter>;
 
     // Member variables
+    std::unique_ptr<IOContext> ioContext; // options.io, outlives formatCtx
     AVFormatContextPtr formatCtx;
     AVCodecContextPtr codecCtx;
     AVBufferRefPtr hwDeviceCtx;
@@ -92,9 +248,23 @@ class Encoder
     AVStream* stream = nullptr;
     AVPacket* packet = nullptr;
     VideoProperties properties;
+    Options options;
     std::string hwAccelType;
     int64_t pts = 0;
-    Frame frame;
+    // Input surfaces, one per frame of the largest chunk. A deque so growing it
+    // never moves frames the encoder may still reference.
+    std::deque<Frame> inputFrames;
+    int maxBatchFrames = 0; // Frames converted before encoding them; 0 is no limit
+    Frame raw;              // Reference sent by encodeRawFrame()
+    bool streamCopy = false; // Opened by openCopy(), without a codec
+    bool finalized = false;  // Trailer written by finalize()
+    // Audio passthrough from options.audioSource
+    AVInputContextPtr audioInput;
+    AVStream* audioStream = nullptr; // Output stream the audio is copied to
+    int audioInputIndex = -1;        // Audio stream in audioInput
+    AVPacket* audioPacket = nullptr; // Read ahead, waiting for the video to catch up
+    bool audioPending = false;
     std::unique_ptr<celux::conversion::IConverter> converter;
+    Stats stats;
 };
 } // namespace celux
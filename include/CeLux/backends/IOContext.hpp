@@ -0,0 +1,61 @@
+// IOContext.hpp
+#pragma once
+
+#include "CxCore.hpp"
+#include <functional>
+
+namespace celux
+{
+
+/**
+ * @brief Where a Decoder reads from or an Encoder writes to instead of a file,
+ * e.g. a buffer in memory or a Python file object.
+ */
+struct IOCallbacks
+{
+    // Fill up to `size` bytes; return the count, 0 at the end, or an AVERROR
+    std::function<int(uint8_t* buffer, int size)> read;
+    // Consume `size` bytes; return the count or an AVERROR
+    std::function<int(const uint8_t* buffer, int size)> write;
+    // fseek-like, plus AVSEEK_SIZE to return the total size (or an AVERROR if it
+    // is unknown). Null for streams that can't seek, which then can only be read
+    // or written front to back.
+    std::function<int64_t(int64_t offset, int whence)> seek;
+    // Size of the buffer FFmpeg reads and writes through
+    int bufferSize = 64 * 1024;
+};
+
+/**
+ * @class IOContext
+ * @brief Owns an AVIOContext that calls IOCallbacks.
+ *
+ * Attach get() to an AVFormatContext's `pb` with AVFMT_FLAG_CUSTOM_IO set; the
+ * IOContext must outlive the format context.
+ */
+class IOContext
+{
+  public:
+    /**
+     * @param callbacks read for inputs, write for outputs; seek optional.
+     * @param writable Create an output context.
+     * @throws std::invalid_argument if the callback the direction needs is
+     * missing or the buffer size is not positive.
+     */
+    IOContext(IOCallbacks callbacks, bool writable);
+    ~IOContext();
+
+    IOContext(const IOContext&) = delete;
+    IOContext& operator=(const IOContext&) = delete;
+
+    AVIOContext* get() const;
+
+  private:
+    static int readPacket(void* opaque, uint8_t* buffer, int size);
+    static int writePacket(void* opaque, const uint8_t* buffer, int size);
+    static int64_t seekTo(void* opaque, int64_t offset, int whence);
+
+    IOCallbacks callbacks;
+    AVIOContext* context = nullptr;
+};
+
+} // namespace celux
@@ -0,0 +1,114 @@
+// SeekIndex.hpp
+#pragma once
+
+#include "CxCore.hpp"
+
+namespace celux
+{
+
+/**
+ * @class SeekIndex
+ * @brief Presentation timestamps and keyframe positions of one video stream.
+ *
+ * Built from a packet-only scan of the demuxer (no decoding), it maps a frame
+ * number to the PTS of that frame in presentation order and to the keyframe a
+ * decoder has to start from to reach it.
+ */
+class SeekIndex
+{
+  public:
+    SeekIndex() = default;
+
+    /**
+     * @brief Scan every packet of a stream and record its timestamps.
+     *
+     * Reads the input to the end; the caller is responsible for seeking back.
+     *
+     * @param formatCtx Opened input.
+     * @param streamIndex Index of the video stream to scan.
+     * @return SeekIndex The index. It is invalid if the stream carries packets
+     * without a PTS.
+     */
+    static SeekIndex build(AVFormatContext* formatCtx, int streamIndex);
+
+    /**
+     * @brief Whether the index can be used for frame-accurate seeking.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Number of frames in the stream.
+     *
+     * Counted from packets, so it is exact even when the index is invalid.
+     */
+    int frameCount() const;
+
+    /**
+     * @brief PTS (in stream time base) of a frame in presentation order.
+     */
+    int64_t framePts(int frameIndex) const;
+
+    /**
+     * @brief PTS of the last keyframe presented at or before `pts`.
+     */
+    int64_t keyframeBefore(int64_t pts) const;
+
+    /**
+     * @brief Byte offset of the keyframe returned by keyframeBefore(), or -1 if
+     * the demuxer did not report one.
+     */
+    int64_t keyframePositionBefore(int64_t pts) const;
+
+    /**
+     * @brief Frame number of the first frame presented at or after `pts`.
+     */
+    int frameAt(int64_t pts) const;
+
+    /**
+     * @brief Identity of a source file: its absolute path, size and mtime.
+     *
+     * An index saved under one key is only loaded back for the same key, so
+     * edited or replaced videos are rescanned.
+     *
+     * @return std::string The key, or an empty string if the file can't be stat'd
+     * (e.g. it is not a local file).
+     */
+    static std::string sourceKey(const std::string& filePath);
+
+    /**
+     * @brief Where the cached index of a video lives.
+     *
+     * @param filePath Path of the video.
+     * @param cache "sidecar" for `<video>.cxidx` next to the video, otherwise a
+     * directory that holds the indexes of many videos.
+     */
+    static std::string cachePath(const std::string& filePath, const std::string& cache);
+
+    /**
+     * @brief Write the index to `indexPath`.
+     *
+     * The file is written under a temporary name and renamed into place, so
+     * concurrent readers never see a partial index.
+     *
+     * @return true on success. Failures leave no file behind.
+     */
+    bool save(const std::string& indexPath, const std::string& key) const;
+
+    /**
+     * @brief Read an index written by save().
+     *
+     * @param index Receives the index on success.
+     * @return true if the file exists, is well formed and matches `key`.
+     */
+    static bool load(const std::string& indexPath, const std::string& key,
+                     SeekIndex& index);
+
+  private:
+    std::vector<int64_t> pts;         // Sorted, one entry per frame
+    std::vector<int64_t> keyframePts; // Sorted
+    std::vector<int64_t> keyframePos; // Byte offsets of keyframes, -1 if unknown
+    uint64_t packetCount = 0;         // Frames seen, including untimed ones
+    bool valid = false;
+};
+
+} // namespace celux
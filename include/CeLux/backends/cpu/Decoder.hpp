@@ -9,8 +9,9 @@ class Decoder : public celux::Decoder
 {
   public:
     Decoder(const std::string& filePath,
-            std::unique_ptr<celux::conversion::IConverter> converter = nullptr)
-        : celux::Decoder(std::move(converter))
+            std::unique_ptr<celux::conversion::IConverter> converter = nullptr,
+            const Options& options = Options())
+        : celux::Decoder(std::move(converter), options)
     {
         initialize(filePath);
     }
@@ -8,8 +8,9 @@ class Encoder : public celux::Encoder
 {
   public:
     Encoder(const std::string& outputPath, const VideoProperties& props,
-            std::unique_ptr<celux::conversion::IConverter> converter = nullptr)
-        : celux::Encoder(std::move(converter))
+            std::unique_ptr<celux::conversion::IConverter> converter = nullptr,
+            const Options& options = Options())
+        : celux::Encoder(std::move(converter), options)
     {
         initialize(outputPath, props);
     }
@@ -19,6 +20,23 @@ class Encoder : public celux::Encoder
         // Cleanup if necessary
     }
 
-    // No need to override methods unless specific behavior is needed
+  protected:
+    /**
+     * @brief Allocate the input frame in the encoder's pixel format on first use,
+     * and give it fresh buffers while the encoder still references the last ones.
+     */
+    void prepareFrame(celux::Frame& input) override
+    {
+        AVFrame* av = input.get();
+        if (!av->data[0])
+        {
+            av->format = codecCtx->pix_fmt;
+            av->width = codecCtx->width;
+            av->height = codecCtx->height;
+            FF_CHECK(av_frame_get_buffer(av, 0));
+            return;
+        }
+        FF_CHECK(av_frame_make_writable(av));
+    }
 };
 } // namespace celux::backends::cpu
@@ -9,20 +9,40 @@ class Decoder : public celux::Decoder
 {
   public:
     Decoder(const std::string& filePath,
-            std::unique_ptr<celux::conversion::IConverter> converter = nullptr)
-        : celux::Decoder(std::move(converter))
+            std::unique_ptr<celux::conversion::IConverter> converter = nullptr,
+            const Options& options = Options())
+        : celux::Decoder(std::move(converter), options)
     {
         initialize(filePath);
+        if (scaledWidth > 0)
+        {
+            // Frames leave NVDEC at the scaled size
+            properties.width = scaledWidth;
+            properties.height = scaledHeight;
+        }
     }
 
     ~Decoder() override ;
 
   protected:
     void initHWAccel() override;
+
+    /**
+     * @brief Open the codec for NVDEC output, via the stream's *_cuvid decoder
+     * when hardware crop/resize is requested.
+     *
+     * @throws CxException if the codec has no cuvid decoder or the crop does not
+     * fit the frame.
+     */
     void initCodecContext(const AVCodec* codec) override;
+    void configureCodec(AVDictionary** codecOptions) override;
 
     static enum AVPixelFormat getHWFormat(AVCodecContext* ctx,
                                           const enum AVPixelFormat* pix_fmts);
+  private:
+    // Output size of the cuvid decoder, 0 when it does not scale
+    int scaledWidth = 0;
+    int scaledHeight = 0;
 };
 
 } // namespace celux::backends::gpu::cuda
@@ -0,0 +1,24 @@
+// DeviceContext.hpp
+#pragma once
+
+#include "FFException.hpp"
+
+namespace celux::backends::gpu::cuda
+{
+
+/**
+ * @brief FFmpeg CUDA device context shared by the decoders and encoders of a GPU.
+ *
+ * Created on first use and kept for the life of the process. It wraps the
+ * device's primary CUDA context, the one the CUDA runtime (and so PyTorch and
+ * the conversion kernels) works in, so NVDEC/NVENC surfaces, tensors and
+ * kernels share one context and opening another reader creates none.
+ *
+ * @param device CUDA device index.
+ * @return The context. It stays owned by the registry; take a reference with
+ * av_buffer_ref to use it.
+ * @throws CxException if the context cannot be created.
+ */
+AVBufferRef* sharedDeviceContext(int device = 0);
+
+} // namespace celux::backends::gpu::cuda
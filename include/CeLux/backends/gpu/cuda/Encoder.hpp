@@ -9,22 +9,28 @@ class Encoder : public celux::Encoder
   public:
     Encoder(const std::string& outputPath, const VideoProperties& props,
             std::unique_ptr<celux::conversion::IConverter> converter = nullptr,
-            const std::string& hwType = "cuda")
-        : celux::Encoder(std::move(converter))
+            const Options& options = Options(), const std::string& hwType = "cuda")
+        : celux::Encoder(std::move(converter), options)
     {
-        std::cout << "Initializing CUDA Encoder, in constructor\n" << std::endl;
         hwAccelType = hwType;
+        // Keeps the surfaces of a chunk plus those NVENC still holds in the pool
+        maxBatchFrames = InputPoolSize / 2;
         this->initialize(outputPath, props);
     }
 
-    ~Encoder() override
-    {
-        finalize();
-    }
+    // Input surfaces kept by the frames pool. NVENC may still hold a few
+    // submitted frames while the next ones are converted.
+    static constexpr int InputPoolSize = 20;
 
   protected:
     void initHWAccel() override;
-    void initCodecContext(const AVCodec* codec, const VideoProperties& props) override;
+    /**
+     * @brief Attach the hw frames pool and map the rate control options onto
+     * NVENC's ("rc", "qp", "cq"). Without options this encodes with preset p5 at
+     * constant QP 23.
+     */
+    void configureCodec(AVDictionary** codecOptions) override;
+    void prepareFrame(celux::Frame& input) override;
     enum AVPixelFormat getHWFormat(AVCodecContext* ctx,
                                    const enum AVPixelFormat* pix_fmts) override;
 };
@@ -0,0 +1,83 @@
+// ColorSpace.hpp
+#pragma once
+
+namespace celux
+{
+namespace conversion
+{
+
+/**
+ * @brief YCbCr matrix standards supported by the YUV to RGB converters.
+ */
+enum class ColorStandard
+{
+    BT601,
+    BT709,
+    BT2020
+};
+
+/**
+ * @brief Coefficients that turn raw Y/U/V samples into RGB in [0, 1].
+ *
+ * With Y' = Y * yScale + yBias and U' = U * cScale + cBias (V likewise):
+ *   R = Y' + rV * V'
+ *   G = Y' + gU * U' + gV * V'
+ *   B = Y' + bU * U'
+ *
+ * Plain data so it can be passed by value to CUDA kernels.
+ */
+struct YuvToRgbMatrix
+{
+    float yScale, yBias;
+    float cScale, cBias;
+    float rV, gU, gV, bU;
+};
+
+/**
+ * @brief Build the conversion coefficients for a stream.
+ *
+ * @param standard Matrix coefficients (Kr/Kb) of the stream.
+ * @param fullRange true for JPEG/full range, false for MPEG/limited range.
+ * @param bitDepth Bits per sample of the source (8, 10, 12, ...).
+ * @param sampleShift Left shift of each sample inside its storage word, e.g. 6
+ * for P010 where 10-bit samples occupy the high bits of 16.
+ */
+inline YuvToRgbMatrix makeYuvToRgbMatrix(ColorStandard standard, bool fullRange,
+                                         int bitDepth = 8, int sampleShift = 0)
+{
+    float kr = 0.299f, kb = 0.114f; // BT.601
+    if (standard == ColorStandard::BT709)
+    {
+        kr = 0.2126f;
+        kb = 0.0722f;
+    }
+    else if (standard == ColorStandard::BT2020)
+    {
+        kr = 0.2627f;
+        kb = 0.0593f;
+    }
+    const float kg = 1.0f - kr - kb;
+
+    // Code values of black, white and the chroma midpoint at this bit depth
+    const float depthScale = static_cast<float>(1 << (bitDepth - 8));
+    const float maxCode = static_cast<float>((1 << bitDepth) - 1);
+    const float storage = static_cast<float>(1 << sampleShift);
+    const float yBlack = fullRange ? 0.0f : 16.0f * depthScale;
+    const float yRange = fullRange ? maxCode : 219.0f * depthScale;
+    const float cRange = fullRange ? maxCode : 224.0f * depthScale;
+    const float cMid = 128.0f * depthScale;
+
+    YuvToRgbMatrix m;
+    m.yScale = 1.0f / (yRange * storage);
+    m.yBias = -yBlack / yRange;
+    m.cScale = 1.0f / (cRange * storage);
+    m.cBias = -cMid / cRange;
+    m.rV = 2.0f * (1.0f - kr);
+    m.gU = -2.0f * kb * (1.0f - kb) / kg;
+    m.gV = -2.0f * kr * (1.0f - kr) / kg;
+    m.bU = 2.0f * (1.0f - kb);
+    return m;
+}
+
+} // namespace conversion
+} // namespace celux
@@ -16,6 +16,8 @@ namespace celux
 		NV12ToRGB,
 		BGRToNV12,
 		NV12ToBGR,
+		P010ToRGB, // 10/16-bit hardware frames (P010, P016), CUDA only
+		NV12ToNV12, // Packed NV12 encoder input, uint8 only
 	};
 }
 
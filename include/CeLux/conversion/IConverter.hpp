@@ -2,13 +2,121 @@
 
 #pragma once
 
+#include "ColorSpace.hpp"
 #include "Frame.hpp"
+#include "Resample.hpp"
+#include "Stats.hpp"
 
 namespace celux
 {
 namespace conversion
 {
 
+/**
+ * @brief Matrix standard a decoded frame is tagged with.
+ *
+ * Untagged frames follow the usual convention: BT.709 for HD and larger,
+ * BT.601 below.
+ */
+inline ColorStandard colorStandardOf(const AVFrame* frame)
+{
+    switch (frame->colorspace)
+    {
+    case AVCOL_SPC_BT709:
+        return ColorStandard::BT709;
+    case AVCOL_SPC_BT2020_NCL:
+    case AVCOL_SPC_BT2020_CL:
+        return ColorStandard::BT2020;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+    case AVCOL_SPC_SMPTE240M:
+    case AVCOL_SPC_FCC:
+        return ColorStandard::BT601;
+    default:
+        return frame->height >= 720 ? ColorStandard::BT709 : ColorStandard::BT601;
+    }
+}
+
+/**
+ * @brief Whether a decoded frame uses full (JPEG) range. Untagged means limited.
+ */
+inline bool isFullRange(const AVFrame* frame)
+{
+    return frame->color_range == AVCOL_RANGE_JPEG;
+}
+
+/**
+ * @brief Output layout and post-processing applied while converting a frame.
+ *
+ * Defaults reproduce the plain conversion: full frame, source size, interleaved
+ * HWC, values scaled to [0, 1] for floating point outputs.
+ */
+struct ConversionOptions
+{
+    // Write CHW planes instead of interleaved HWC
+    bool planar = false;
+    // Apply (value - mean) / std per channel. Floating point outputs only.
+    bool normalize = false;
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    float stddev[3] = {1.0f, 1.0f, 1.0f};
+    // Threads CPU converters split each frame across; 0 uses one per core. A
+    // performance hint that does not change the output, so isDefault ignores it.
+    int threadCount = 1;
+    // Source rectangle to convert; a zero width or height spans the rest of the
+    // frame. x and y must be even so chroma samples are not split.
+    int cropX = 0;
+    int cropY = 0;
+    int cropWidth = 0;
+    int cropHeight = 0;
+    // Output size; 0 keeps the size of the cropped rectangle
+    int outputWidth = 0;
+    int outputHeight = 0;
+    ResizeFilter resizeFilter = ResizeFilter::Bilinear;
+
+    bool isDefault() const
+    {
+        return !planar && !normalize && !resamples();
+    }
+
+    /**
+     * @brief Whether a crop or resize is requested.
+     */
+    bool resamples() const
+    {
+        return cropX != 0 || cropY != 0 || cropWidth != 0 || cropHeight != 0 ||
+               outputWidth != 0 || outputHeight != 0;
+    }
+
+    /**
+     * @brief Resolve the crop and output size for a `width` x `height` frame.
+     *
+     * @throws std::runtime_error if the crop does not fit inside the frame.
+     */
+    ResampleParams resampleFor(int width, int height) const
+    {
+        ResampleParams params;
+        params.cropX = cropX;
+        params.cropY = cropY;
+        params.cropWidth = cropWidth > 0 ? cropWidth : width - cropX;
+        params.cropHeight = cropHeight > 0 ? cropHeight : height - cropY;
+        if (cropX < 0 || cropY < 0 || cropX % 2 != 0 || cropY % 2 != 0 ||
+            params.cropWidth <= 0 || params.cropHeight <= 0 ||
+            cropX + params.cropWidth > width || cropY + params.cropHeight > height)
+        {
+            throw std::runtime_error(
+                "Crop (" + std::to_string(cropX) + ", " + std::to_string(cropY) +
+                ", " + std::to_string(params.cropWidth) + ", " +
+                std::to_string(params.cropHeight) + ") does not fit a " +
+                std::to_string(width) + "x" + std::to_string(height) +
+                " frame or has an odd origin");
+        }
+        params.outputWidth = outputWidth > 0 ? outputWidth : params.cropWidth;
+        params.outputHeight = outputHeight > 0 ? outputHeight : params.cropHeight;
+        params.filter = resizeFilter;
+        return params;
+    }
+};
+
 class IConverter
 {
   public:
@@ -17,6 +125,69 @@ class IConverter
     }
     virtual void convert(celux::Frame& frame, void* buffer) = 0;
     virtual void synchronize() = 0;
+
+    /**
+     * @brief Make work queued on `stream` from now on wait for the conversions
+     * queued so far, without blocking the host.
+     *
+     * The default does nothing, for converters that finish before convert()
+     * returns.
+     *
+     * @param stream Backend stream handle, e.g. a cudaStream_t.
+     */
+    virtual void orderBefore(void* stream)
+    {
+    }
+
+    /**
+     * @brief Make conversions queued from now on wait for the work already on
+     * `stream`, e.g. reads of a buffer that is about to be overwritten.
+     *
+     * The default does nothing, see orderBefore().
+     */
+    virtual void orderAfter(void* stream)
+    {
+    }
+
+    /**
+     * @brief Measure the GPU time of the conversions queued until endTiming().
+     *
+     * It is added to Stats::Stage::ConvertKernel of `stats` by a later call, once
+     * the conversions have run; the host never waits for them. The default does
+     * nothing, for converters that finish before convert() returns.
+     */
+    virtual void beginTiming(Stats& stats)
+    {
+    }
+
+    /**
+     * @brief End the measurement started by beginTiming().
+     */
+    virtual void endTiming()
+    {
+    }
+
+    /**
+     * @brief Configure layout/normalization for subsequent conversions.
+     *
+     * Converters that support options override this; the default only accepts
+     * the default options.
+     *
+     * @throws std::runtime_error if the converter cannot honour the options.
+     */
+    virtual void setOptions(const ConversionOptions& options)
+    {
+        if (!options.isDefault())
+        {
+            throw std::runtime_error(
+                "Planar output, normalization, crop and resize are not supported by "
+                "this converter");
+        }
+        conversionOptions = options;
+    }
+
+  protected:
+    ConversionOptions conversionOptions;
 };
 
 } // namespace conversion
@@ -0,0 +1,42 @@
+// Resample.hpp
+#pragma once
+
+namespace celux
+{
+namespace conversion
+{
+
+/**
+ * @brief Filter used when the conversion also resizes.
+ */
+enum class ResizeFilter
+{
+    // Bilinear interpolation between the four nearest samples
+    Bilinear,
+    // Average of the source samples each output pixel covers. Behaves like
+    // Bilinear along an axis that is upscaled.
+    Area
+};
+
+/**
+ * @brief Source rectangle and output size of a crop/resize fused into the YUV
+ * to RGB conversion.
+ *
+ * The crop is applied first, then the rectangle is scaled to the output size.
+ * Plain data so it can be passed by value to CUDA kernels.
+ */
+struct ResampleParams
+{
+    int cropX, cropY;          // Top-left corner in source pixels, both even
+    int cropWidth, cropHeight; // Source rectangle size
+    int outputWidth, outputHeight;
+    ResizeFilter filter;
+
+    bool resizes() const
+    {
+        return cropWidth != outputWidth || cropHeight != outputHeight;
+    }
+};
+
+} // namespace conversion
+} // namespace celux
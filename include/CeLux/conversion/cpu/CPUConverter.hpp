@@ -2,6 +2,12 @@
 #pragma once
 #include "Frame.hpp"
 #include "IConverter.hpp"
+#include "ThreadPool.hpp"
+#include "YUVToRGBKernels.hpp"
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace celux
 {
@@ -25,10 +31,11 @@ template <typename T> class ConverterBase : public IConverter
     }
 
     /**
-     * @brief Virtual destructor.
+     * @brief Virtual destructor. Frees the per-band contexts.
      */
     virtual ~ConverterBase()
     {
+        releaseBands();
     }
 
     /**
@@ -46,7 +53,391 @@ template <typename T> class ConverterBase : public IConverter
     }
 
   protected:
+    /**
+     * @brief Crop and output size for `frame`; the whole frame at its own size
+     * unless the options crop or resize.
+     *
+     * @throws std::runtime_error if the crop does not fit the frame.
+     */
+    ResampleParams resampleFor(const AVFrame* frame) const
+    {
+        return conversionOptions.resampleFor(frame->width, frame->height);
+    }
+
+    /**
+     * @brief Convert 8-bit 4:2:0 frames (NV12, YUV420P) with the SIMD kernels.
+     *
+     * Writes uint8 or [0, 1] float output in one pass, in the layout selected by
+     * the conversion options, split across the conversion threads. A crop is
+     * applied by starting at the crop origin; resizing is left to swscale.
+     *
+     * @param bgr Write B, G, R instead of R, G, B.
+     * @return false if the frame's format or a resize needs the swscale path
+     * instead.
+     */
+    bool convertWithKernels(const AVFrame* frame, void* buffer, bool bgr)
+    {
+        const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+        if (format != AV_PIX_FMT_NV12 && format != AV_PIX_FMT_YUV420P &&
+            format != AV_PIX_FMT_YUVJ420P)
+        {
+            return false;
+        }
+        const ResampleParams geometry = resampleFor(frame);
+        if (geometry.resizes())
+        {
+            return false;
+        }
+
+        const uint8_t* planes[4];
+        cropPlanes(frame, geometry, planes);
+        const Yuv420Image src{planes[0],          planes[1],
+                              planes[2],          frame->linesize[0],
+                              frame->linesize[1], frame->linesize[2],
+                              format == AV_PIX_FMT_NV12, geometry.cropWidth,
+                              geometry.cropHeight};
+        const RgbImage dst{buffer, std::is_same<T, float>::value,
+                           conversionOptions.planar, bgr};
+        const YuvToRgbMatrix matrix =
+            makeYuvToRgbMatrix(colorStandardOf(frame),
+                               isFullRange(frame) || format == AV_PIX_FMT_YUVJ420P);
+
+        const int height = geometry.cropHeight;
+        const int threads = threadCount();
+        const int count = std::min(threads, height / kMinBandRows);
+        if (count <= 1)
+        {
+            yuv420ToRgb(src, dst, matrix, 0, height);
+            return true;
+        }
+        const int rowsPerBand = bandRows(height, count);
+        ensurePool(threads);
+        pool->parallelFor((height + rowsPerBand - 1) / rowsPerBand,
+                          [&](size_t band)
+                          {
+                              yuv420ToRgb(src, dst, matrix,
+                                          static_cast<int>(band) * rowsPerBand,
+                                          rowsPerBand);
+                          });
+        return true;
+    }
+
+    /**
+     * @brief Widen uint8 values to floats in [0, 1].
+     */
+    static void bytesToUnitFloat(const uint8_t* src, float* dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] = src[i] * (1.0f / 255.0f);
+        }
+    }
+
+    /**
+     * @brief Make `swsContext` ready to convert `frame` to `dstFormat`.
+     *
+     * Any software format swscale reads is accepted (NV12, YUV420P/422P/444P and
+     * their high bit depth variants). The context is keyed on the source format
+     * and size and rebuilt through sws_getCachedContext only when the key
+     * changes, so streams that switch resolution or format mid-way keep working.
+     *
+     * The crop rectangle is scaled to the output size from the options with
+     * the selected filter. Without a resize and with more than one conversion
+     * thread, tall frames are split into bands of whole chroma rows, each with
+     * its own context, converted in parallel by scale().
+     *
+     * @param frame Source frame.
+     * @param dstFormat Packed or planar RGB format to produce.
+     */
+    void prepareContext(const AVFrame* frame, AVPixelFormat dstFormat)
+    {
+        const AVPixelFormat srcFormat = static_cast<AVPixelFormat>(frame->format);
+        const ResampleParams geometry = resampleFor(frame);
+        const int flags =
+            geometry.filter == ResizeFilter::Area ? SWS_AREA : SWS_BILINEAR;
+        const int threads = threadCount();
+        if (!swsContext || srcFormat != contextSrcFormat ||
+            dstFormat != contextDstFormat || frame->width != contextWidth ||
+            frame->height != contextHeight || threads != contextThreads ||
+            !sameGeometry(geometry, contextGeometry))
+        {
+            swsContext = sws_getCachedContext(
+                swsContext, geometry.cropWidth, geometry.cropHeight, srcFormat,
+                geometry.outputWidth, geometry.outputHeight, dstFormat, flags,
+                nullptr, nullptr, nullptr);
+            if (!swsContext)
+            {
+                const char* srcName = av_get_pix_fmt_name(srcFormat);
+                throw std::runtime_error(
+                    std::string("Failed to initialize swsContext for ") +
+                    (srcName ? srcName : "unknown") + " to " +
+                    av_get_pix_fmt_name(dstFormat) + " conversion");
+            }
+            contextSrcFormat = srcFormat;
+            contextDstFormat = dstFormat;
+            contextWidth = frame->width;
+            contextHeight = frame->height;
+            contextThreads = threads;
+            contextGeometry = geometry;
+            colorspaceApplied = false;
+            releaseBands();
+            if (!geometry.resizes())
+            {
+                planBands(srcFormat, dstFormat, geometry.cropWidth,
+                          geometry.cropHeight, threads);
+            }
+        }
+        updateColorspace(frame);
+    }
+
+    /**
+     * @brief Convert `frame` into the destination planes using the prepared
+     * context(s).
+     *
+     * @throws std::runtime_error if swscale fails.
+     */
+    void scale(const AVFrame* frame, uint8_t* const dstData[4],
+               const int dstLineSize[4])
+    {
+        const uint8_t* planes[4];
+        cropPlanes(frame, contextGeometry, planes);
+        if (bands.empty())
+        {
+            if (sws_scale(swsContext, planes, frame->linesize, 0,
+                          contextGeometry.cropHeight, dstData, dstLineSize) <= 0)
+            {
+                throw std::runtime_error("sws_scale failed during conversion");
+            }
+            return;
+        }
+
+        const AVPixFmtDescriptor* desc =
+            av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+        pool->parallelFor(
+            bands.size(),
+            [&](size_t index)
+            {
+                const Band& band = bands[index];
+                const uint8_t* src[4] = {nullptr};
+                uint8_t* dst[4] = {nullptr};
+                for (int p = 0; p < 4; ++p)
+                {
+                    // Band starts are multiples of kBandAlign, so chroma rows are
+                    // never split between two bands
+                    const int shift = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+                    if (planes[p])
+                    {
+                        src[p] = planes[p] +
+                                 static_cast<ptrdiff_t>(band.firstRow >> shift) *
+                                     frame->linesize[p];
+                    }
+                    if (dstData[p])
+                    {
+                        dst[p] = dstData[p] +
+                                 static_cast<ptrdiff_t>(band.firstRow) * dstLineSize[p];
+                    }
+                }
+                if (sws_scale(band.context, src, frame->linesize, 0, band.rows, dst,
+                              dstLineSize) <= 0)
+                {
+                    throw std::runtime_error("sws_scale failed during conversion");
+                }
+            });
+    }
+
+    /**
+     * @brief Free the swscale context so the next conversion rebuilds it.
+     */
+    void releaseContext()
+    {
+        if (swsContext)
+        {
+            sws_freeContext(swsContext);
+            swsContext = nullptr;
+        }
+        releaseBands();
+        colorspaceApplied = false;
+    }
+
+    /**
+     * @brief Start of each plane of `frame` at the crop origin of `geometry`.
+     *
+     * @throws std::runtime_error if the origin splits a chroma sample.
+     */
+    static void cropPlanes(const AVFrame* frame, const ResampleParams& geometry,
+                           const uint8_t* planes[4])
+    {
+        const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+        if ((geometry.cropX & ((1 << desc->log2_chroma_w) - 1)) ||
+            (geometry.cropY & ((1 << desc->log2_chroma_h) - 1)))
+        {
+            throw std::runtime_error(std::string("Crop origin must be aligned to "
+                                                 "the chroma samples of ") +
+                                     desc->name);
+        }
+        for (int p = 0; p < 4; ++p)
+        {
+            planes[p] = frame->data[p];
+            if (!planes[p] || (geometry.cropX == 0 && geometry.cropY == 0))
+            {
+                continue;
+            }
+            const int shift = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+            planes[p] += static_cast<ptrdiff_t>(geometry.cropY >> shift) *
+                             frame->linesize[p] +
+                         av_image_get_linesize(format, geometry.cropX, p);
+        }
+    }
+
     struct SwsContext* swsContext;
+    std::vector<uint8_t> scratch; // Staging for outputs swscale cannot write
+
+  private:
+    /**
+     * @brief One horizontal slice of the frame converted as its own image.
+     */
+    struct Band
+    {
+        struct SwsContext* context;
+        int firstRow;
+        int rows;
+    };
+
+    // Band heights are a multiple of this, which covers every chroma subsampling
+    static constexpr int kBandAlign = 16;
+    // Frames are not split into bands shorter than this
+    static constexpr int kMinBandRows = 64;
+
+    /**
+     * @brief Split a `width` x `height` conversion into up to `threads` bands.
+     *
+     * Leaves `bands` empty, i.e. single threaded, when the frame is too short to
+     * be worth splitting.
+     */
+    void planBands(AVPixelFormat srcFormat, AVPixelFormat dstFormat, int width,
+                   int height, int threads)
+    {
+        const int count = std::min(threads, height / kMinBandRows);
+        if (count <= 1)
+        {
+            return;
+        }
+        const int rowsPerBand = bandRows(height, count);
+
+        for (int firstRow = 0; firstRow < height; firstRow += rowsPerBand)
+        {
+            const int rows = std::min(rowsPerBand, height - firstRow);
+            struct SwsContext* context =
+                sws_getContext(width, rows, srcFormat, width, rows, dstFormat,
+                               SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!context)
+            {
+                releaseBands();
+                throw std::runtime_error("Failed to initialize band swsContext");
+            }
+            bands.push_back({context, firstRow, rows});
+        }
+
+        ensurePool(threads);
+    }
+
+    // Resolved conversionOptions.threadCount
+    int threadCount() const
+    {
+        if (conversionOptions.threadCount > 0)
+        {
+            return conversionOptions.threadCount;
+        }
+        return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Rows per band when splitting `height` rows `count` ways
+    static int bandRows(int height, int count)
+    {
+        return ((height + count - 1) / count + kBandAlign - 1) / kBandAlign *
+               kBandAlign;
+    }
+
+    void ensurePool(int threads)
+    {
+        if (!pool || pool->size() != static_cast<size_t>(threads))
+        {
+            pool = std::make_unique<celux::ThreadPool>(threads);
+        }
+    }
+
+    static bool sameGeometry(const ResampleParams& a, const ResampleParams& b)
+    {
+        return a.cropX == b.cropX && a.cropY == b.cropY &&
+               a.cropWidth == b.cropWidth && a.cropHeight == b.cropHeight &&
+               a.outputWidth == b.outputWidth && a.outputHeight == b.outputHeight &&
+               a.filter == b.filter;
+    }
+
+    void releaseBands()
+    {
+        for (Band& band : bands)
+        {
+            sws_freeContext(band.context);
+        }
+        bands.clear();
+    }
+
+    /**
+     * @brief Match the swscale YUV to RGB coefficients and range to the frame.
+     *
+     * Uses the same colorspace rules as the CUDA kernels, so both backends agree
+     * on untagged input. The context is only touched when it was rebuilt or the
+     * frame's tags changed since the last call.
+     */
+    void updateColorspace(const AVFrame* frame)
+    {
+        const ColorStandard standard = colorStandardOf(frame);
+        const bool fullRange = isFullRange(frame);
+        if (colorspaceApplied && standard == lastStandard &&
+            fullRange == lastFullRange)
+        {
+            return;
+        }
+
+        int coefficients = SWS_CS_ITU709;
+        if (standard == ColorStandard::BT601)
+        {
+            coefficients = SWS_CS_ITU601;
+        }
+        else if (standard == ColorStandard::BT2020)
+        {
+            coefficients = SWS_CS_BT2020;
+        }
+
+        // The destination matrix is unused for RGB output; always write 0-255
+        const int* srcMatrix = sws_getCoefficients(coefficients);
+        const int* dstMatrix = sws_getCoefficients(SWS_CS_DEFAULT);
+        sws_setColorspaceDetails(swsContext, srcMatrix, fullRange ? 1 : 0, dstMatrix,
+                                 1, 0, 1 << 16, 1 << 16);
+        for (Band& band : bands)
+        {
+            sws_setColorspaceDetails(band.context, srcMatrix, fullRange ? 1 : 0,
+                                     dstMatrix, 1, 0, 1 << 16, 1 << 16);
+        }
+
+        colorspaceApplied = true;
+        lastStandard = standard;
+        lastFullRange = fullRange;
+    }
+
+    AVPixelFormat contextSrcFormat = AV_PIX_FMT_NONE;
+    AVPixelFormat contextDstFormat = AV_PIX_FMT_NONE;
+    int contextWidth = 0;
+    int contextHeight = 0;
+    int contextThreads = 0;
+    ResampleParams contextGeometry{};
+    std::vector<Band> bands;
+    std::unique_ptr<celux::ThreadPool> pool;
+    bool colorspaceApplied = false;
+    ColorStandard lastStandard = ColorStandard::BT709;
+    bool lastFullRange = false;
 };
 
 } // namespace cpu
@@ -5,6 +5,7 @@
 #include <cpu/CPUConverter.hpp>
 #include <cpu/NV12ToRGB.hpp>
 #include <cpu/NV12ToBGR.hpp>
+#include <cpu/NV12ToNV12.hpp>
 #include <cpu/RGBToNV12.hpp>
 #include <cpu/BGRToNV12.hpp>
 #endif // CPU_CONVERTERS_HPP
@@ -40,82 +40,60 @@ template <typename T> class NV12ToBGR : public ConverterBase<T>
     }
 
     /**
-     * @brief Performs NV12 to BGR conversion.
+     * @brief Performs YUV (any software format swscale reads) to BGR conversion.
      *
      * @param frame Reference to the frame to be converted.
-     * @param buffer Pointer to the buffer containing NV12 data.
+     * @param buffer Destination buffer for the BGR image.
      */
     void convert(celux::Frame& frame, void* buffer) override
     {
-        // Verify the pixel format
-        if (frame.getPixelFormat() != AV_PIX_FMT_YUV420P)
+        // 8-bit 4:2:0 goes straight to the output type in one vectorized pass
+        if (this->convertWithKernels(frame.get(), buffer, true))
         {
-            throw std::runtime_error("Frame pixel format is not YUV420P");
+            return;
         }
 
-        if (!swsContext)
-        {
-            // Initialize the swsContext for YUV420P to RGB conversion
-            swsContext = sws_getContext(frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_YUV420P, // Source format
-                                        frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_BGR24, // Destination format
-                                        SWS_BILINEAR, nullptr, nullptr, nullptr);
-            if (!swsContext)
-            {
-                throw std::runtime_error(
-                    "Failed to initialize swsContext for YUV420P to RGB conversion");
-            }
-
-            // Set color space and range explicitly (optional)
-            int srcRange = 0; // MPEG (16-235)
-            int dstRange = 1; // JPEG (0-255)
-            const int* srcMatrix = sws_getCoefficients(SWS_CS_ITU709);
-            const int* dstMatrix = sws_getCoefficients(SWS_CS_ITU709);
+        // Output size after the crop/resize from the options
+        const ResampleParams geometry = this->resampleFor(frame.get());
+        const int width = geometry.outputWidth;
+        const int height = geometry.outputHeight;
 
-            sws_setColorspaceDetails(swsContext, srcMatrix, srcRange, dstMatrix,
-                                     dstRange, 0, 1 << 16, 1 << 16);
+        // swscale writes bytes; float output is staged and widened afterwards
+        uint8_t* bytes = static_cast<uint8_t*>(buffer);
+        const size_t elementCount = static_cast<size_t>(width) * height * 3;
+        if constexpr (!std::is_same<T, uint8_t>::value)
+        {
+            this->scratch.resize(elementCount);
+            bytes = this->scratch.data();
         }
 
-        // Source data and line sizes
-        const uint8_t* srcData[4] = {nullptr};
-        int srcLineSize[4] = {0};
-
-        srcData[0] = frame.getData(0);
-        srcData[1] = frame.getData(1);
-        srcData[2] = frame.getData(2);
-
-        srcLineSize[0] = frame.getLineSize(0);
-        srcLineSize[1] = frame.getLineSize(1);
-        srcLineSize[2] = frame.getLineSize(2);
+        this->prepareContext(frame.get(), AV_PIX_FMT_BGR24);
 
         // Destination data and line sizes
         uint8_t* dstData[4] = {nullptr};
         int dstLineSize[4] = {0};
 
         // Calculate the required buffer size
-        int numBytes = av_image_get_buffer_size(AV_PIX_FMT_BGR24, frame.getWidth(),
-                                                frame.getHeight(), 1);
+        int numBytes = av_image_get_buffer_size(AV_PIX_FMT_BGR24, width, height, 1);
         if (numBytes < 0)
         {
             throw std::runtime_error("Could not get buffer size");
         }
 
         // Initialize the destination data pointers and line sizes
-        int ret = av_image_fill_arrays(dstData, dstLineSize,
-                                       static_cast<uint8_t*>(buffer), AV_PIX_FMT_BGR24,
-                                       frame.getWidth(), frame.getHeight(), 1);
+        int ret = av_image_fill_arrays(dstData, dstLineSize, bytes, AV_PIX_FMT_BGR24,
+                                       width, height, 1);
         if (ret < 0)
         {
             throw std::runtime_error("Could not fill destination image arrays");
         }
 
-        // Perform the conversion from YUV420P to RGB
-        int result = sws_scale(swsContext, srcData, srcLineSize, 0, frame.getHeight(),
-                               dstData, dstLineSize);
-        if (result <= 0)
+        // Perform the conversion to BGR, split across threads if enabled
+        this->scale(frame.get(), dstData, dstLineSize);
+
+        if constexpr (std::is_same<T, float>::value)
         {
-            throw std::runtime_error("sws_scale failed during conversion");
+            this->bytesToUnitFloat(bytes, static_cast<float*>(buffer), elementCount);
         }
     }
 };
@@ -0,0 +1,94 @@
+// NV12ToNV12.hpp
+#pragma once
+
+#include "CPUConverter.hpp"
+#include "Frame.hpp"
+
+namespace celux
+{
+namespace conversion
+{
+namespace cpu
+{
+
+/**
+ * @brief Copies NV12 input into encoder frames on CPU.
+ *
+ * Reads packed NV12 (a [H * 3 / 2, W] uint8 buffer: the Y plane followed by the
+ * interleaved UV plane). NV12 frames get a plane copy and no conversion; other
+ * YUV formats (e.g. YUV420P for libx264) are converted with swscale.
+ *
+ * @tparam T Data type of the input; only uint8_t is supported.
+ */
+template <typename T> class NV12ToNV12 : public ConverterBase<T>
+{
+    static_assert(std::is_same<T, uint8_t>::value, "NV12 input must be uint8");
+
+  public:
+    NV12ToNV12() : ConverterBase<T>()
+    {
+    }
+
+    /**
+     * @brief Destructor that frees the swsContext.
+     */
+    ~NV12ToNV12()
+    {
+        this->releaseContext();
+    }
+
+    /**
+     * @brief Copies or converts the NV12 input into the frame.
+     *
+     * @param frame Frame to write, allocated with its width, height and format.
+     * @param buffer Pointer to the NV12 input.
+     */
+    void convert(celux::Frame& frame, void* buffer) override
+    {
+        AVFrame* dst = frame.get();
+        const int width = dst->width;
+        const int height = dst->height;
+        const uint8_t* srcData[4] = {static_cast<const uint8_t*>(buffer),
+                                     static_cast<const uint8_t*>(buffer) +
+                                         static_cast<size_t>(width) * height,
+                                     nullptr, nullptr};
+        const int srcLineSize[4] = {width, width, 0, 0};
+        const AVPixelFormat dstFormat = static_cast<AVPixelFormat>(dst->format);
+
+        if (dstFormat == AV_PIX_FMT_NV12)
+        {
+            av_image_copy_plane(dst->data[0], dst->linesize[0], srcData[0], width,
+                                width, height);
+            av_image_copy_plane(dst->data[1], dst->linesize[1], srcData[1], width,
+                                width, height / 2);
+            return;
+        }
+
+        if (!this->swsContext || dstFormat != contextFormat)
+        {
+            this->swsContext = sws_getCachedContext(
+                this->swsContext, width, height, AV_PIX_FMT_NV12, width, height,
+                dstFormat, SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!this->swsContext)
+            {
+                throw std::runtime_error(
+                    std::string("Failed to initialize swsContext for nv12 to ") +
+                    av_get_pix_fmt_name(dstFormat) + " conversion");
+            }
+            contextFormat = dstFormat;
+        }
+        int result = sws_scale(this->swsContext, srcData, srcLineSize, 0, height,
+                               dst->data, dst->linesize);
+        if (result <= 0)
+        {
+            throw std::runtime_error("sws_scale failed during conversion");
+        }
+    }
+
+  private:
+    AVPixelFormat contextFormat = AV_PIX_FMT_NONE; // Format swsContext writes
+};
+
+} // namespace cpu
+} // namespace conversion
+} // namespace celux
@@ -40,82 +40,90 @@ template <typename T> class NV12ToRGB : public ConverterBase<T>
     }
 
     /**
-     * @brief Performs NV12 to RGB conversion.
+     * @brief Enables planar (CHW) output, crop and resize. Normalization is not
+     * supported on CPU.
+     */
+    void setOptions(const ConversionOptions& options) override
+    {
+        if (options.normalize)
+        {
+            throw std::runtime_error(
+                "Normalization is not supported by the CPU backend");
+        }
+        this->conversionOptions = options;
+    }
+
+    /**
+     * @brief Performs YUV (any software format swscale reads) to RGB conversion.
      *
      * @param frame Reference to the frame to be converted.
-     * @param buffer Pointer to the buffer containing NV12 data.
+     * @param buffer Destination buffer for the RGB image.
      */
     void convert(celux::Frame& frame, void* buffer) override
     {
-        // Verify the pixel format
-        if (frame.getPixelFormat() != AV_PIX_FMT_YUV420P)
+        // 8-bit 4:2:0 goes straight to the output type in one vectorized pass
+        if (this->convertWithKernels(frame.get(), buffer, false))
         {
-            throw std::runtime_error("Frame pixel format is not YUV420P");
+            return;
         }
 
-        if (!swsContext)
-        {
-            // Initialize the swsContext for YUV420P to RGB conversion
-            swsContext = sws_getContext(frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_YUV420P, // Source format
-                                        frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_RGB24, // Destination format
-                                        SWS_BILINEAR, nullptr, nullptr, nullptr);
-            if (!swsContext)
-            {
-                throw std::runtime_error(
-                    "Failed to initialize swsContext for YUV420P to RGB conversion");
-            }
-
-            // Set color space and range explicitly (optional)
-            int srcRange = 0; // MPEG (16-235)
-            int dstRange = 1; // JPEG (0-255)
-            const int* srcMatrix = sws_getCoefficients(SWS_CS_ITU709);
-            const int* dstMatrix = sws_getCoefficients(SWS_CS_ITU709);
+        // Output size after the crop/resize from the options
+        const ResampleParams geometry = this->resampleFor(frame.get());
+        const int width = geometry.outputWidth;
+        const int height = geometry.outputHeight;
 
-            sws_setColorspaceDetails(swsContext, srcMatrix, srcRange, dstMatrix,
-                                     dstRange, 0, 1 << 16, 1 << 16);
+        // swscale writes bytes; float output is staged and widened afterwards
+        uint8_t* bytes = static_cast<uint8_t*>(buffer);
+        const size_t elementCount = static_cast<size_t>(width) * height * 3;
+        if constexpr (!std::is_same<T, uint8_t>::value)
+        {
+            this->scratch.resize(elementCount);
+            bytes = this->scratch.data();
         }
 
-        // Source data and line sizes
-        const uint8_t* srcData[4] = {nullptr};
-        int srcLineSize[4] = {0};
-
-        srcData[0] = frame.getData(0);
-        srcData[1] = frame.getData(1);
-        srcData[2] = frame.getData(2);
-
-        srcLineSize[0] = frame.getLineSize(0);
-        srcLineSize[1] = frame.getLineSize(1);
-        srcLineSize[2] = frame.getLineSize(2);
+        // Planar RGB comes out of swscale as GBRP, see the plane order below
+        const bool planar = this->conversionOptions.planar;
+        const AVPixelFormat dstFormat = planar ? AV_PIX_FMT_GBRP : AV_PIX_FMT_RGB24;
+        this->prepareContext(frame.get(), dstFormat);
 
         // Destination data and line sizes
         uint8_t* dstData[4] = {nullptr};
         int dstLineSize[4] = {0};
 
-        // Calculate the required buffer size
-        int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, frame.getWidth(),
-                                                frame.getHeight(), 1);
-        if (numBytes < 0)
+        if (planar)
         {
-            throw std::runtime_error("Could not get buffer size");
+            // GBRP writes G, B, R planes; point them into the R, G, B order of CHW
+            uint8_t* out = bytes;
+            const size_t planeSize = static_cast<size_t>(width) * height;
+            dstData[0] = out + planeSize;     // G
+            dstData[1] = out + 2 * planeSize; // B
+            dstData[2] = out;                 // R
+            dstLineSize[0] = dstLineSize[1] = dstLineSize[2] = width;
         }
-
-        // Initialize the destination data pointers and line sizes
-        int ret = av_image_fill_arrays(dstData, dstLineSize,
-                                       static_cast<uint8_t*>(buffer), AV_PIX_FMT_RGB24,
-                                       frame.getWidth(), frame.getHeight(), 1);
-        if (ret < 0)
+        else
         {
-            throw std::runtime_error("Could not fill destination image arrays");
+            // Calculate the required buffer size
+            int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, width, height, 1);
+            if (numBytes < 0)
+            {
+                throw std::runtime_error("Could not get buffer size");
+            }
+
+            // Initialize the destination data pointers and line sizes
+            int ret = av_image_fill_arrays(dstData, dstLineSize, bytes,
+                                           AV_PIX_FMT_RGB24, width, height, 1);
+            if (ret < 0)
+            {
+                throw std::runtime_error("Could not fill destination image arrays");
+            }
         }
 
-        // Perform the conversion from YUV420P to RGB
-        int result = sws_scale(swsContext, srcData, srcLineSize, 0, frame.getHeight(),
-                               dstData, dstLineSize);
-        if (result <= 0)
+        // Perform the conversion to RGB, split across threads if enabled
+        this->scale(frame.get(), dstData, dstLineSize);
+
+        if constexpr (std::is_same<T, float>::value)
         {
-            throw std::runtime_error("sws_scale failed during conversion");
+            this->bytesToUnitFloat(bytes, static_cast<float*>(buffer), elementCount);
         }
     }
 };
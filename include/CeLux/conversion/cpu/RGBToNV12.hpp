@@ -1,8 +1,9 @@
-// BGRToNV12.hpp
+// RGBToNV12.hpp
 #pragma once
 
 #include "CPUConverter.hpp"
 #include "Frame.hpp"
+#include <cmath>
 #include <type_traits>
 
 namespace celux
@@ -13,109 +14,103 @@ namespace cpu
 {
 
 /**
- * @brief Converter for BGR to NV12 conversion on CPU.
+ * @brief Converter for RGB to NV12 conversion on CPU, used to feed encoders.
  *
- * @tparam T Data type used for conversion.
+ * Reads a packed HWC RGB buffer (uint8, or float in [0, 1]; BGR for BGRToNV12)
+ * and writes the frame's planes. The frame may be in any YUV format swscale
+ * writes, so encoders without NV12 input (e.g. libx265 and YUV420P) are fed
+ * directly.
+ *
+ * @tparam T Data type of the RGB input.
  */
-template <typename T> class BGRToNV12 : public ConverterBase<T>
+template <typename T> class RGBToNV12 : public ConverterBase<T>
 {
   public:
     /**
      * @brief Constructor that invokes the base class constructor.
      */
-    BGRToNV12() : ConverterBase<T>()
+    RGBToNV12() : RGBToNV12(AV_PIX_FMT_RGB24)
     {
     }
 
     /**
      * @brief Destructor that frees the swsContext.
      */
-    ~BGRToNV12()
+    ~RGBToNV12()
     {
-        if (swsContext)
-        {
-            sws_freeContext(swsContext);
-            swsContext = nullptr;
-        }
+        this->releaseContext();
     }
 
     /**
-     * @brief Performs BGR to NV12 conversion.
+     * @brief Performs RGB to NV12 conversion.
      *
-     * @param frame Reference to the frame to be converted.
-     * @param buffer Pointer to the buffer containing NV12 data.
+     * @param frame Frame to write, allocated with its width, height and format.
+     * @param buffer Pointer to the RGB input.
      */
     void convert(celux::Frame& frame, void* buffer) override
     {
-        // Verify the pixel format
-        if (frame.getPixelFormat() != AV_PIX_FMT_BGR24)
-        {
-            throw std::runtime_error("Frame pixel format is not BGR24");
-        }
+        const int width = frame.getWidth();
+        const int height = frame.getHeight();
+        const AVPixelFormat dstFormat = frame.getPixelFormat();
 
-        if (!swsContext)
+        if (!this->swsContext || dstFormat != contextFormat)
         {
-            // Initialize the swsContext for BGR to NV12 conversion
-            swsContext = sws_getContext(frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_BGR24, // Source format
-                                        frame.getWidth(), frame.getHeight(),
-                                        AV_PIX_FMT_NV12, // Destination format
-                                        SWS_BILINEAR, nullptr, nullptr, nullptr);
-            if (!swsContext)
+            this->swsContext = sws_getCachedContext(
+                this->swsContext, width, height, inputFormat, width, height,
+                dstFormat, SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!this->swsContext)
             {
                 throw std::runtime_error(
-                    "Failed to initialize swsContext for BGR to NV12 conversion");
+                    std::string("Failed to initialize swsContext for ") +
+                    av_get_pix_fmt_name(inputFormat) + " to " +
+                    av_get_pix_fmt_name(dstFormat) + " conversion");
             }
 
-            // Set color space and range explicitly (optional)
-            int srcRange = 1; // JPEG (0-255)
-            int dstRange = 0; // MPEG (16-235)
-            const int* srcMatrix = sws_getCoefficients(SWS_CS_ITU709);
-            const int* dstMatrix = sws_getCoefficients(SWS_CS_ITU709);
-
-            sws_setColorspaceDetails(swsContext, srcMatrix, srcRange, dstMatrix,
-                                     dstRange, 0, 1 << 16, 1 << 16);
+            // Full range RGB in, limited range BT.709 out, as players expect for
+            // untagged HD video
+            const int* matrix = sws_getCoefficients(SWS_CS_ITU709);
+            sws_setColorspaceDetails(this->swsContext, matrix, 1, matrix, 0, 0,
+                                     1 << 16, 1 << 16);
+            contextFormat = dstFormat;
         }
 
-        // Source data and line sizes
-        const uint8_t* srcData[4] = {nullptr};
-        int srcLineSize[4] = {0};
-
-        srcData[0] = frame.getData(0);
-        srcLineSize[0] = frame.getLineSize(0);
-
-        // Destination data and line sizes
-        uint8_t* dstData[4] = {nullptr};
-        int dstLineSize[4] = {0};
-
-        // Calculate the required buffer size
-        int numBytes = av_image_get_buffer_size(AV_PIX_FMT_NV12, frame.getWidth(),
-                                                frame.getHeight(), 1);
-        if (numBytes < 0)
+        const size_t count = static_cast<size_t>(width) * height * 3;
+        const uint8_t* rgb = static_cast<const uint8_t*>(buffer);
+        if constexpr (std::is_same<T, float>::value)
         {
-            throw std::runtime_error("Could not get buffer size");
-        }
-
-        // Initialize the destination data pointers and line sizes
-        int ret = av_image_fill_arrays(dstData, dstLineSize,
-                                       static_cast<uint8_t*>(buffer), AV_PIX_FMT_NV12,
-                                       frame.getWidth(), frame.getHeight(), 1);
-        if (ret < 0)
-        {
-            throw std::runtime_error("Could not fill destination image arrays");
+            // swscale has no float RGB input; quantize once into the scratch buffer
+            this->scratch.resize(count);
+            const float* src = static_cast<const float*>(buffer);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float v = std::fmin(std::fmax(src[i], 0.0f), 1.0f);
+                this->scratch[i] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+            }
+            rgb = this->scratch.data();
         }
 
-        // Perform the conversion from BGR to NV12
-        int result = sws_scale(swsContext, srcData, srcLineSize, 0, frame.getHeight(),
-                               dstData, dstLineSize);
+        const uint8_t* srcData[4] = {rgb, nullptr, nullptr, nullptr};
+        const int srcLineSize[4] = {width * 3, 0, 0, 0};
+        int result = sws_scale(this->swsContext, srcData, srcLineSize, 0, height,
+                               frame.get()->data, frame.get()->linesize);
         if (result <= 0)
         {
             throw std::runtime_error("sws_scale failed during conversion");
         }
     }
 
+  protected:
+    /**
+     * @brief Read `inputFormat` (RGB24 or BGR24) instead of RGB24.
+     */
+    explicit RGBToNV12(AVPixelFormat inputFormat)
+        : ConverterBase<T>(), inputFormat(inputFormat)
+    {
+    }
+
   private:
-    struct SwsContext* swsContext = nullptr;
+    AVPixelFormat inputFormat;
+    AVPixelFormat contextFormat = AV_PIX_FMT_NONE; // Format swsContext writes
 };
 
 } // namespace cpu
@@ -0,0 +1,83 @@
+// YUVToRGBKernels.hpp
+#pragma once
+
+#include "ColorSpace.hpp"
+#include <cstdint>
+
+namespace celux
+{
+namespace conversion
+{
+namespace cpu
+{
+
+/**
+ * @brief Instruction set used by the CPU YUV to RGB kernels.
+ */
+enum class SimdLevel
+{
+    Scalar,
+    NEON,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Best kernel variant for the running CPU, detected once.
+ */
+SimdLevel activeSimdLevel();
+
+/**
+ * @brief Name of a SimdLevel ("scalar", "neon", "avx2", "avx512").
+ */
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @brief Source planes of an 8-bit 4:2:0 frame.
+ *
+ * NV12 stores interleaved chroma: `u` points at the UV plane and `v` is unused.
+ * YUV420P stores separate U and V planes.
+ */
+struct Yuv420Image
+{
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+    int yStride;
+    int uStride;
+    int vStride;
+    bool nv12;
+    int width;
+    int height;
+};
+
+/**
+ * @brief Destination of a YUV to RGB conversion.
+ *
+ * Rows are tightly packed: width * 3 elements for HWC, width per plane for CHW.
+ * Float output is in [0, 1], uint8 output in [0, 255].
+ */
+struct RgbImage
+{
+    void* data;
+    bool isFloat; // float elements instead of uint8
+    bool planar;  // CHW instead of HWC
+    bool bgr;     // B, G, R channel order instead of R, G, B
+};
+
+/**
+ * @brief Convert rows [firstRow, firstRow + rows) of `src` in one pass.
+ *
+ * Follows the same formula as the CUDA kernels, so both backends agree (up to
+ * float rounding) for the same matrix. `firstRow` must be even so that chroma
+ * rows are not split. Safe to call concurrently on disjoint row ranges.
+ *
+ * @param level Kernel variant; must not exceed activeSimdLevel().
+ */
+void yuv420ToRgb(const Yuv420Image& src, const RgbImage& dst,
+                 const YuvToRgbMatrix& matrix, int firstRow, int rows,
+                 SimdLevel level = activeSimdLevel());
+
+} // namespace cpu
+} // namespace conversion
+} // namespace celux
@@ -6,6 +6,8 @@
 #include "cuda/BaseConverter.hpp"
 #include "cuda/NV12ToBGR.hpp"
 #include "cuda/NV12ToRGB.hpp"
+#include "cuda/NV12ToNV12.hpp"
+#include "cuda/P010ToRGB.hpp"
 #include "cuda/BGRToNV12.hpp"
 #include "cuda/RGBToNV12.hpp"
 
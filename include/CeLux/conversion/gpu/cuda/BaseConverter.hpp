@@ -20,14 +20,61 @@ template <typename T> class ConverterBase : public IConverter
 {
   public:
     ConverterBase();
+    /**
+     * @brief Run conversions on `stream`, e.g. the caller's current stream, so
+     * they are ordered with its other work. The stream is borrowed, not
+     * destroyed. Null creates a private stream.
+     */
     ConverterBase(cudaStream_t stream);
     virtual ~ConverterBase();
 
     virtual void synchronize() override;
+    void orderBefore(void* stream) override;
+    void orderAfter(void* stream) override;
+    void beginTiming(Stats& stats) override;
+    void endTiming() override;
     virtual cudaStream_t getStream() const;
 
   protected:
+    /**
+     * @brief Crop and output size to convert `frame` with.
+     *
+     * @return null when the options convert the whole frame at its own size.
+     * @throws std::runtime_error if the crop does not fit the frame.
+     */
+    const ResampleParams* resampleFor(const celux::Frame& frame);
+
     cudaStream_t conversionStream;
+
+  private:
+    /**
+     * @brief Record `event` on `from` and make `to` wait for it. Does nothing
+     * when both are the same stream, which is ordered already.
+     */
+    static void streamWait(cudaStream_t to, cudaStream_t from, cudaEvent_t event);
+
+    void createEvents();
+
+    /**
+     * @brief Add the measurements whose conversions have finished to `stats`.
+     */
+    void collectTimings(Stats& stats);
+
+    bool ownsStream = false;   // conversionStream was created here
+    // Recorded on conversionStream / the caller's stream by orderBefore() and
+    // orderAfter(). Waits capture the record made just before them, so one event
+    // per direction can be reused for every frame.
+    cudaEvent_t converted = nullptr;
+    cudaEvent_t consumed = nullptr;
+    // Measurements still running on the GPU, oldest first from
+    // timingNext - timingPending. Created on the first beginTiming().
+    static constexpr int TimingSlots = 8;
+    cudaEvent_t timingStart[TimingSlots] = {};
+    cudaEvent_t timingEnd[TimingSlots] = {};
+    int timingNext = 0;
+    int timingPending = 0;
+    bool timing = false; // Between beginTiming() and endTiming()
+    ResampleParams resample{}; // Storage behind resampleFor()
 };
 
 // Template Definitions
@@ -40,6 +87,8 @@ template <typename T> ConverterBase<T>::ConverterBase()
     {
         throw std::runtime_error("Failed to create CUDA stream");
     }
+    ownsStream = true;
+    createEvents();
 }
 
 // Constructor with Stream Parameter
@@ -53,17 +102,46 @@ ConverterBase<T>::ConverterBase(cudaStream_t stream) : conversionStream(stream)
         {
             throw std::runtime_error("Failed to create CUDA stream");
         }
+        ownsStream = true;
+    }
+    createEvents();
+}
+
+template <typename T> void ConverterBase<T>::createEvents()
+{
+    // These only order streams; timing would make every record more expensive
+    if (cudaEventCreateWithFlags(&converted, cudaEventDisableTiming) != cudaSuccess ||
+        cudaEventCreateWithFlags(&consumed, cudaEventDisableTiming) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to create CUDA events");
     }
 }
 
 // Destructor
 template <typename T> ConverterBase<T>::~ConverterBase()
 {
-    if (conversionStream)
+    if (conversionStream && ownsStream)
     {
         synchronize();
         cudaStreamDestroy(conversionStream);
     }
+    // Destroying an event with pending waits is safe; they complete normally
+    if (converted)
+    {
+        cudaEventDestroy(converted);
+    }
+    if (consumed)
+    {
+        cudaEventDestroy(consumed);
+    }
+    for (int i = 0; i < TimingSlots; ++i)
+    {
+        if (timingStart[i])
+        {
+            cudaEventDestroy(timingStart[i]);
+            cudaEventDestroy(timingEnd[i]);
+        }
+    }
 }
 
 // Synchronize Method
@@ -76,6 +154,103 @@ template <typename T> void ConverterBase<T>::synchronize()
     }
 }
 
+template <typename T> void ConverterBase<T>::orderBefore(void* stream)
+{
+    streamWait(static_cast<cudaStream_t>(stream), conversionStream, converted);
+}
+
+template <typename T> void ConverterBase<T>::orderAfter(void* stream)
+{
+    streamWait(conversionStream, static_cast<cudaStream_t>(stream), consumed);
+}
+
+template <typename T> void ConverterBase<T>::beginTiming(Stats& stats)
+{
+    if (!timingStart[0])
+    {
+        for (int i = 0; i < TimingSlots; ++i)
+        {
+            if (cudaEventCreate(&timingStart[i]) != cudaSuccess ||
+                cudaEventCreate(&timingEnd[i]) != cudaSuccess)
+            {
+                throw std::runtime_error("Failed to create CUDA events");
+            }
+        }
+    }
+    collectTimings(stats);
+    // With every slot still running the GPU is far behind; this conversion then
+    // goes unmeasured rather than making the host wait
+    timing = timingPending < TimingSlots;
+    if (timing && cudaEventRecord(timingStart[timingNext], conversionStream) !=
+                      cudaSuccess)
+    {
+        throw std::runtime_error("Failed to record CUDA event");
+    }
+}
+
+template <typename T> void ConverterBase<T>::endTiming()
+{
+    if (!timing)
+    {
+        return;
+    }
+    timing = false;
+    if (cudaEventRecord(timingEnd[timingNext], conversionStream) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to record CUDA event");
+    }
+    timingNext = (timingNext + 1) % TimingSlots;
+    ++timingPending;
+}
+
+template <typename T> void ConverterBase<T>::collectTimings(Stats& stats)
+{
+    while (timingPending > 0)
+    {
+        const int oldest = (timingNext - timingPending + TimingSlots) % TimingSlots;
+        if (cudaEventQuery(timingEnd[oldest]) != cudaSuccess)
+        {
+            // Not ready is no error, so keep it from the kernel launch checks
+            cudaGetLastError();
+            break; // Later ones finish after it on the same stream
+        }
+        float milliseconds = 0.0f;
+        if (cudaEventElapsedTime(&milliseconds, timingStart[oldest],
+                                 timingEnd[oldest]) == cudaSuccess)
+        {
+            stats.add(Stats::Stage::ConvertKernel,
+                      static_cast<int64_t>(milliseconds * 1e6));
+        }
+        --timingPending;
+    }
+}
+
+template <typename T>
+void ConverterBase<T>::streamWait(cudaStream_t to, cudaStream_t from,
+                                  cudaEvent_t event)
+{
+    if (to == from)
+    {
+        return;
+    }
+    if (cudaEventRecord(event, from) != cudaSuccess ||
+        cudaStreamWaitEvent(to, event, 0) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to order CUDA streams");
+    }
+}
+
+template <typename T>
+const ResampleParams* ConverterBase<T>::resampleFor(const celux::Frame& frame)
+{
+    if (!this->conversionOptions.resamples())
+    {
+        return nullptr;
+    }
+    resample = this->conversionOptions.resampleFor(frame.getWidth(), frame.getHeight());
+    return &resample;
+}
+
 // Get Stream Method
 template <typename T> cudaStream_t ConverterBase<T>::getStream() const
 {
@@ -0,0 +1,80 @@
+// NV12ToNV12.hpp
+
+#pragma once
+
+#include "Frame.hpp"
+#include "BaseConverter.hpp"
+
+namespace celux
+{
+namespace conversion
+{
+namespace gpu
+{
+namespace cuda
+{
+
+/**
+ * @brief Copies NV12 input into NV12 hardware frames.
+ *
+ * Reads packed NV12 (a [H * 3 / 2, W] uint8 buffer: the Y plane followed by the
+ * interleaved UV plane) and copies both planes into the frame's pitched surface
+ * on the conversion stream. No kernel runs and no intermediate buffer is used.
+ *
+ * @tparam T Data type of the input; only uint8_t is supported.
+ */
+template <typename T> class NV12ToNV12 : public ConverterBase<T>
+{
+    static_assert(std::is_same<T, uint8_t>::value, "NV12 input must be uint8");
+
+  public:
+    NV12ToNV12();
+    NV12ToNV12(cudaStream_t stream);
+    ~NV12ToNV12();
+
+    void convert(celux::Frame& frame, void* buffer) override;
+};
+
+// Template Definitions
+
+template <typename T> NV12ToNV12<T>::NV12ToNV12() : ConverterBase<T>()
+{
+}
+
+template <typename T>
+NV12ToNV12<T>::NV12ToNV12(cudaStream_t stream) : ConverterBase<T>(stream)
+{
+}
+
+template <typename T> NV12ToNV12<T>::~NV12ToNV12()
+{
+}
+
+template <typename T> void NV12ToNV12<T>::convert(celux::Frame& frame, void* buffer)
+{
+    const unsigned char* yInput = static_cast<const unsigned char*>(buffer);
+    int width = frame.getWidth();
+    int height = frame.getHeight();
+    const unsigned char* uvInput = yInput + static_cast<size_t>(width) * height;
+
+    // cudaMemcpyDefault also accepts pinned or managed host input
+    cudaError_t err = cudaMemcpy2DAsync(frame.getData(0), frame.getLineSize(0), yInput,
+                                        width, width, height, cudaMemcpyDefault,
+                                        this->conversionStream);
+    if (err == cudaSuccess)
+    {
+        err = cudaMemcpy2DAsync(frame.getData(1), frame.getLineSize(1), uvInput, width,
+                                width, height / 2, cudaMemcpyDefault,
+                                this->conversionStream);
+    }
+    if (err != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to copy NV12 frame: " +
+                                 std::string(cudaGetErrorString(err)));
+    }
+}
+
+} // namespace cuda
+} // namespace gpu
+} // namespace conversion
+} // namespace celux
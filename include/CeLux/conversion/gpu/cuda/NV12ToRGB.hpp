@@ -8,17 +8,32 @@
 extern "C"
 {
     // Host functions for different data types
+    // `planar` selects CHW output; `matrix` carries the source colorspace and
+    // range; `mean`/`stddev` (3 floats each, or null for none) normalize the
+    // [0, 1] floating point outputs per channel; `resample` (or null for the full
+    // frame) crops and resizes, with the output stride given for the output size
     void nv12_to_rgb(const unsigned char* yPlane, const unsigned char* uvPlane,
                      int width, int height, int yStride, int uvStride,
-                     unsigned char* rgbOutput, int rgbStride, cudaStream_t stream);
+                     unsigned char* rgbOutput, int rgbStride, bool planar,
+                     const celux::conversion::YuvToRgbMatrix* matrix,
+                     const celux::conversion::ResampleParams* resample,
+                     cudaStream_t stream);
 
     void nv12_to_rgb_float(const unsigned char* yPlane, const unsigned char* uvPlane,
                            int width, int height, int yStride, int uvStride,
-                           float* rgbOutput, int rgbStride, cudaStream_t stream);
+                           float* rgbOutput, int rgbStride, bool planar,
+                           const celux::conversion::YuvToRgbMatrix* matrix,
+                           const float* mean, const float* stddev,
+                           const celux::conversion::ResampleParams* resample,
+                           cudaStream_t stream);
 
     void nv12_to_rgb_half(const unsigned char* yPlane, const unsigned char* uvPlane,
                           int width, int height, int yStride, int uvStride,
-                          __half* rgbOutput, int rgbStride, cudaStream_t stream);
+                          __half* rgbOutput, int rgbStride, bool planar,
+                          const celux::conversion::YuvToRgbMatrix* matrix,
+                          const float* mean, const float* stddev,
+                          const celux::conversion::ResampleParams* resample,
+                          cudaStream_t stream);
 }
 namespace celux
 {
@@ -37,6 +52,7 @@ template <typename T> class NV12ToRGB : public ConverterBase<T>
     ~NV12ToRGB();
 
     void convert(celux::Frame& frame, void* buffer) override;
+    void setOptions(const ConversionOptions& options) override;
 };
 
 // Template Definitions
@@ -54,6 +70,15 @@ template <typename T> NV12ToRGB<T>::~NV12ToRGB()
 {
 }
 
+template <typename T> void NV12ToRGB<T>::setOptions(const ConversionOptions& options)
+{
+    if (options.normalize && std::is_same<T, uint8_t>::value)
+    {
+        throw std::runtime_error("Normalization requires a floating point output type");
+    }
+    this->conversionOptions = options;
+}
+
 template <typename T> void NV12ToRGB<T>::convert(celux::Frame& frame, void* buffer)
 {
     const unsigned char* yPlane = frame.getData(0);
@@ -62,27 +87,34 @@ template <typename T> void NV12ToRGB<T>::convert(celux::Frame& frame, void* buff
     int uvStride = frame.getLineSize(1);
     int width = frame.getWidth();
     int height = frame.getHeight();
-    int rgbStride = width * 3;
+    const ResampleParams* resample = this->resampleFor(frame);
+    int rgbStride = (resample ? resample->outputWidth : width) * 3;
+    const ConversionOptions& options = this->conversionOptions;
+    const float* mean = options.normalize ? options.mean : nullptr;
+    const float* stddev = options.normalize ? options.stddev : nullptr;
+    const YuvToRgbMatrix matrix =
+        makeYuvToRgbMatrix(colorStandardOf(frame.get()), isFullRange(frame.get()));
 
     if constexpr (std::is_same<T, uint8_t>::value)
     {
         // Call the kernel for uint8_t
         nv12_to_rgb(yPlane, uvPlane, width, height, yStride, uvStride,
-                    static_cast<uint8_t*>(buffer), rgbStride, this->conversionStream);
+                    static_cast<uint8_t*>(buffer), rgbStride, options.planar, &matrix,
+                    resample, this->conversionStream);
     }
     else if constexpr (std::is_same<T, float>::value)
     {
         // Call the kernel for float
         nv12_to_rgb_float(yPlane, uvPlane, width, height, yStride, uvStride,
-                          static_cast<float*>(buffer), rgbStride,
-                          this->conversionStream);
+                          static_cast<float*>(buffer), rgbStride, options.planar,
+                          &matrix, mean, stddev, resample, this->conversionStream);
     }
     else if constexpr (std::is_same<T, __half>::value)
     {
         // Call the kernel for __half
         nv12_to_rgb_half(yPlane, uvPlane, width, height, yStride, uvStride,
-                         static_cast<__half*>(buffer), rgbStride,
-                         this->conversionStream);
+                         static_cast<__half*>(buffer), rgbStride, options.planar,
+                         &matrix, mean, stddev, resample, this->conversionStream);
     }
     else
     {
@@ -0,0 +1,178 @@
+// P010ToRGB.hpp
+
+#pragma once
+
+#include "BaseConverter.hpp"
+#include "Frame.hpp"
+
+extern "C"
+{
+    // Host functions for different data types
+    // Planes hold 16-bit words (P010: 10 significant high bits, P016: 16 bits);
+    // strides are in bytes. `planar`, `matrix`, `mean`, `stddev` and `resample`
+    // behave as for nv12_to_rgb.
+    void p010_to_rgb(const unsigned char* yPlane, const unsigned char* uvPlane,
+                     int width, int height, int yStride, int uvStride,
+                     unsigned char* rgbOutput, int rgbStride, bool planar,
+                     const celux::conversion::YuvToRgbMatrix* matrix,
+                     const celux::conversion::ResampleParams* resample,
+                     cudaStream_t stream);
+
+    void p010_to_rgb_uint16(const unsigned char* yPlane, const unsigned char* uvPlane,
+                            int width, int height, int yStride, int uvStride,
+                            unsigned short* rgbOutput, int rgbStride, bool planar,
+                            const celux::conversion::YuvToRgbMatrix* matrix,
+                            const celux::conversion::ResampleParams* resample,
+                            cudaStream_t stream);
+
+    void p010_to_rgb_float(const unsigned char* yPlane, const unsigned char* uvPlane,
+                           int width, int height, int yStride, int uvStride,
+                           float* rgbOutput, int rgbStride, bool planar,
+                           const celux::conversion::YuvToRgbMatrix* matrix,
+                           const float* mean, const float* stddev,
+                           const celux::conversion::ResampleParams* resample,
+                           cudaStream_t stream);
+
+    void p010_to_rgb_half(const unsigned char* yPlane, const unsigned char* uvPlane,
+                          int width, int height, int yStride, int uvStride,
+                          __half* rgbOutput, int rgbStride, bool planar,
+                          const celux::conversion::YuvToRgbMatrix* matrix,
+                          const float* mean, const float* stddev,
+                          const celux::conversion::ResampleParams* resample,
+                          cudaStream_t stream);
+}
+namespace celux
+{
+namespace conversion
+{
+namespace gpu
+{
+namespace cuda
+{
+
+/**
+ * @brief Converts 10/16-bit hardware decoded frames (P010, P016) to RGB.
+ *
+ * uint16 output keeps the full precision of HDR sources; uint8, float and half
+ * outputs behave like NV12ToRGB.
+ *
+ * @tparam T Output element type (uint8_t, uint16_t, float or __half).
+ */
+template <typename T> class P010ToRGB : public ConverterBase<T>
+{
+  public:
+    P010ToRGB();
+    P010ToRGB(cudaStream_t stream);
+    ~P010ToRGB();
+
+    void convert(celux::Frame& frame, void* buffer) override;
+    void setOptions(const ConversionOptions& options) override;
+};
+
+// Template Definitions
+
+template <typename T> P010ToRGB<T>::P010ToRGB() : ConverterBase<T>()
+{
+}
+
+template <typename T>
+P010ToRGB<T>::P010ToRGB(cudaStream_t stream) : ConverterBase<T>(stream)
+{
+}
+
+template <typename T> P010ToRGB<T>::~P010ToRGB()
+{
+}
+
+template <typename T> void P010ToRGB<T>::setOptions(const ConversionOptions& options)
+{
+    if (options.normalize && std::is_integral<T>::value)
+    {
+        throw std::runtime_error("Normalization requires a floating point output type");
+    }
+    this->conversionOptions = options;
+}
+
+template <typename T> void P010ToRGB<T>::convert(celux::Frame& frame, void* buffer)
+{
+    // The sample layout comes from the frame's hardware pool
+    AVPixelFormat format = frame.getPixelFormat();
+    if (frame.get()->hw_frames_ctx)
+    {
+        format = reinterpret_cast<AVHWFramesContext*>(frame.get()->hw_frames_ctx->data)
+                     ->sw_format;
+    }
+    int bitDepth = 16;
+    int sampleShift = 0;
+    if (format == AV_PIX_FMT_P010LE)
+    {
+        bitDepth = 10;
+        sampleShift = 6;
+    }
+    else if (format != AV_PIX_FMT_P016LE)
+    {
+        throw std::runtime_error(std::string("P010ToRGB cannot convert ") +
+                                 av_get_pix_fmt_name(format) + " frames");
+    }
+
+    const unsigned char* yPlane = frame.getData(0);
+    const unsigned char* uvPlane = frame.getData(1);
+    int yStride = frame.getLineSize(0);
+    int uvStride = frame.getLineSize(1);
+    int width = frame.getWidth();
+    int height = frame.getHeight();
+    const ResampleParams* resample = this->resampleFor(frame);
+    int rgbStride = (resample ? resample->outputWidth : width) * 3;
+    const ConversionOptions& options = this->conversionOptions;
+    const float* mean = options.normalize ? options.mean : nullptr;
+    const float* stddev = options.normalize ? options.stddev : nullptr;
+    const YuvToRgbMatrix matrix =
+        makeYuvToRgbMatrix(colorStandardOf(frame.get()), isFullRange(frame.get()),
+                           bitDepth, sampleShift);
+
+    if constexpr (std::is_same<T, uint8_t>::value)
+    {
+        // Call the kernel for uint8_t
+        p010_to_rgb(yPlane, uvPlane, width, height, yStride, uvStride,
+                    static_cast<uint8_t*>(buffer), rgbStride, options.planar, &matrix,
+                    resample, this->conversionStream);
+    }
+    else if constexpr (std::is_same<T, uint16_t>::value)
+    {
+        // Call the kernel for uint16_t
+        p010_to_rgb_uint16(yPlane, uvPlane, width, height, yStride, uvStride,
+                           static_cast<uint16_t*>(buffer), rgbStride, options.planar,
+                           &matrix, resample, this->conversionStream);
+    }
+    else if constexpr (std::is_same<T, float>::value)
+    {
+        // Call the kernel for float
+        p010_to_rgb_float(yPlane, uvPlane, width, height, yStride, uvStride,
+                          static_cast<float*>(buffer), rgbStride, options.planar,
+                          &matrix, mean, stddev, resample, this->conversionStream);
+    }
+    else if constexpr (std::is_same<T, __half>::value)
+    {
+        // Call the kernel for __half
+        p010_to_rgb_half(yPlane, uvPlane, width, height, yStride, uvStride,
+                         static_cast<__half*>(buffer), rgbStride, options.planar,
+                         &matrix, mean, stddev, resample, this->conversionStream);
+    }
+    else
+    {
+        static_assert(sizeof(T) == 0, "Unsupported data type for P010ToRGB");
+    }
+
+    // Check for kernel launch errors
+    cudaError_t err = cudaGetLastError();
+    if (err != cudaSuccess)
+    {
+        throw std::runtime_error("CUDA kernel launch failed: " +
+                                 std::string(cudaGetErrorString(err)));
+    }
+}
+
+} // namespace cuda
+} // namespace gpu
+} // namespace conversion
+} // namespace celux
@@ -0,0 +1,40 @@
+// CudaDevice.hpp
+#ifndef CUDADEVICE_HPP
+#define CUDADEVICE_HPP
+
+#include <torch/extension.h>
+#include <stdexcept>
+#include <string>
+
+// Whether `device` names a GPU, "cuda" or "cuda:N"
+inline bool isCudaDevice(const std::string& device)
+{
+    return device == "cuda" || device.rfind("cuda:", 0) == 0;
+}
+
+// The GPU a "cuda" ("cuda:0") or "cuda:N" device string selects, checked to exist
+inline torch::Device parseCudaDevice(const std::string& device)
+{
+    if (!torch::cuda::is_available())
+    {
+        throw std::runtime_error("CUDA is not available. Please install a "
+                                 "CUDA-enabled version of celux.");
+    }
+    if (torch::cuda::device_count() == 0)
+    {
+        throw std::runtime_error(
+            "No CUDA devices found. Please check your CUDA installation.");
+    }
+
+    const torch::Device requested(device);
+    const int index = requested.has_index() ? requested.index() : 0;
+    if (index >= static_cast<int>(torch::cuda::device_count()))
+    {
+        throw std::invalid_argument("Unsupported device: " + device + " (" +
+                                    std::to_string(torch::cuda::device_count()) +
+                                    " CUDA devices available)");
+    }
+    return torch::Device(torch::kCUDA, index);
+}
+
+#endif // CUDADEVICE_HPP
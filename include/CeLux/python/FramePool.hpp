@@ -0,0 +1,107 @@
+// FramePool.hpp
+
+#ifndef FRAMEPOOL_HPP
+#define FRAMEPOOL_HPP
+
+#include <torch/extension.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class FramePool
+ * @brief Fixed set of preallocated frame tensors recycled between reads.
+ *
+ * A pooled tensor is handed out by acquire() and becomes reusable again either
+ * when every outside reference to it (including views sharing its storage) has
+ * been dropped, or when the caller returns it early with release(). Frames that
+ * are still referenced are therefore never overwritten.
+ *
+ * When every buffer is in use, acquire() falls back to a fresh allocation that is
+ * not added to the pool, so holding more frames than the pool size degrades to
+ * the unpooled behaviour instead of blocking.
+ *
+ * Device buffers can still be read by kernels queued before Python dropped them.
+ * For those, a free buffer is only handed out again once fence() has ordered
+ * later writes after the work queued so far; until then acquire() skips it.
+ * Buffers that were never handed out need no fence.
+ *
+ * acquire() and release() may be called from different threads.
+ */
+class FramePool
+{
+  public:
+    /**
+     * @brief Constructs a pool of `size` tensors.
+     *
+     * @param size Number of pooled buffers.
+     * @param shape Shape of every buffer.
+     * @param options dtype/device of every buffer.
+     */
+    FramePool(int size, std::vector<int64_t> shape, torch::TensorOptions options);
+
+    /**
+     * @brief Get a buffer that no one else references.
+     *
+     * @return torch::Tensor Pooled buffer, or a fresh one if the pool is exhausted.
+     */
+    torch::Tensor acquire();
+
+    /**
+     * @brief Return a buffer to the pool while references to it may still exist.
+     *
+     * After this call the buffer may be overwritten by a later read. Tensors that
+     * do not come from this pool are ignored.
+     *
+     * @param tensor Tensor previously returned by acquire() (or a view of it).
+     * @return true if the tensor belonged to the pool.
+     */
+    bool release(const torch::Tensor& tensor);
+
+    /**
+     * @brief Run `order`, then let acquire() reuse the buffers that were already
+     * free before it ran.
+     *
+     * `order` makes the writes of later acquirers wait for the work that may
+     * still read dropped frames, e.g. VideoReader::orderAfter() on the caller's
+     * stream. Host buffers need no ordering and are reusable as soon as they are
+     * free, so for them this only runs `order`.
+     */
+    void fence(const std::function<void()>& order);
+
+    /**
+     * @brief Number of pooled buffers.
+     */
+    int size() const;
+
+    /**
+     * @brief Number of pooled buffers currently free for reuse.
+     */
+    int available() const;
+
+    /**
+     * @brief Number of times acquire() had to allocate outside the pool.
+     */
+    int64_t fallbackAllocations() const;
+
+  private:
+    bool isFree(size_t index) const;
+    bool isReusable(size_t index) const;
+
+    struct Slot
+    {
+        torch::Tensor tensor;
+        bool released = false; // Returned early through release()
+        bool fenced = false;   // Free before the last fence(), device pools only
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int64_t> shape;
+    torch::TensorOptions options;
+    bool needsFence = false; // Buffers on a device, see fence()
+    size_t nextSlot = 0;
+    int64_t fallbacks = 0;
+    mutable std::mutex mutex;
+};
+
+#endif // FRAMEPOOL_HPP
@@ -0,0 +1,102 @@
+// PinnedStaging.hpp
+
+#ifndef PINNEDSTAGING_HPP
+#define PINNEDSTAGING_HPP
+
+#ifdef CUDA_ENABLED
+#include <torch/extension.h>
+#include <cuda_runtime.h>
+#include <vector>
+
+/**
+ * @class PinnedStaging
+ * @brief Ring of page-locked host frames that CPU conversions write into and
+ * that are copied to device tensors asynchronously.
+ *
+ * next() hands out the oldest slot once its last copy has finished and upload()
+ * queues its copy on the copy stream, so with two or more slots the CPU decodes
+ * and converts the next frame while the previous one crosses PCIe. Pinned
+ * memory lets cudaMemcpyAsync DMA from the buffer directly instead of staging
+ * it through a driver bounce buffer, as a pageable copy does.
+ *
+ * orderBefore() and orderAfter() order the copies with a consumer stream the
+ * same way IConverter's do with conversions, without blocking the host.
+ */
+class PinnedStaging
+{
+  public:
+    /**
+     * @brief Constructs `slots` pinned frames of `shape` and `dtype`.
+     *
+     * @param device CUDA device the frames are copied to.
+     * @param stream Stream to queue copies on, borrowed; null creates a
+     * private non-blocking stream.
+     */
+    PinnedStaging(int slots, std::vector<int64_t> shape, torch::ScalarType dtype,
+                  torch::Device device, void* stream = nullptr);
+    ~PinnedStaging();
+
+    PinnedStaging(const PinnedStaging&) = delete;
+    PinnedStaging& operator=(const PinnedStaging&) = delete;
+
+    /**
+     * @brief Host buffer to convert the next frame into, waiting for the copy
+     * that last read it.
+     */
+    void* next();
+
+    /**
+     * @brief Queue the copy of the buffer returned by next() into `output`.
+     *
+     * @param output Contiguous tensor on the device, of the staged frame size.
+     * @throws std::invalid_argument for a tensor of another size or layout.
+     */
+    void upload(const torch::Tensor& output);
+
+    /**
+     * @brief Make `stream` wait for the copies queued so far.
+     */
+    void orderBefore(void* stream);
+
+    /**
+     * @brief Make later copies wait for the work queued on `stream` so far, e.g.
+     * reads of device frames the next copies overwrite.
+     */
+    void orderAfter(void* stream);
+
+    /**
+     * @brief Block until every queued copy has finished.
+     */
+    void synchronize();
+
+  private:
+    /**
+     * @brief Record `event` on `from` and make `to` wait for it. Does nothing
+     * when both are the same stream.
+     */
+    static void streamWait(cudaStream_t to, cudaStream_t from, cudaEvent_t event);
+
+    /**
+     * @brief Destroy the events and owned stream; pinned frames free themselves.
+     */
+    void destroy();
+
+    struct Slot
+    {
+        torch::Tensor host;
+        cudaEvent_t copied = nullptr; // Recorded after the slot's last copy
+        bool pending = false;         // A copy was queued since the last wait
+    };
+
+    std::vector<Slot> slots;
+    size_t current = 0;
+    int deviceIndex = 0;
+    cudaStream_t copyStream = nullptr;
+    bool ownsStream = false;
+    // One event per direction, as a wait captures the record just before it
+    cudaEvent_t uploaded = nullptr;
+    cudaEvent_t consumed = nullptr;
+};
+
+#endif // CUDA_ENABLED
+#endif // PINNEDSTAGING_HPP
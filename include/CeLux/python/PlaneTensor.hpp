@@ -0,0 +1,42 @@
+// PlaneTensor.hpp
+#ifndef PLANETENSOR_HPP
+#define PLANETENSOR_HPP
+
+#include "CxCore.hpp"
+#include <torch/extension.h>
+
+// Wraps one plane of a decoded frame without copying. The tensor owns a
+// reference to the frame's buffers, returned when the tensor is freed.
+inline torch::Tensor wrapPlane(const AVFrame* frame, AVPixelFormat format, int plane,
+                               torch::Device device)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    const bool chroma = plane == 1 || plane == 2;
+    const int rows = chroma ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h)
+                            : frame->height;
+    const int rowBytes = av_image_get_linesize(format, frame->width, plane);
+    if (rowBytes <= 0)
+    {
+        throw std::runtime_error("Cannot describe plane " + std::to_string(plane) +
+                                 " of " + av_get_pix_fmt_name(format));
+    }
+
+    // 9-16 bit formats store one component per 16-bit word
+    const bool wide = desc->comp[0].depth > 8;
+    const int elementSize = wide ? 2 : 1;
+
+    AVFrame* ref = av_frame_clone(frame);
+    if (!ref)
+    {
+        throw std::runtime_error("Failed to reference decoded frame");
+    }
+    return torch::from_blob(
+        frame->data[plane], {rows, rowBytes / elementSize},
+        {frame->linesize[plane] / elementSize, 1},
+        [ref](void*) mutable { av_frame_free(&ref); },
+        torch::TensorOptions()
+            .dtype(wide ? torch::kUInt16 : torch::kUInt8)
+            .device(device));
+}
+
+#endif // PLANETENSOR_HPP
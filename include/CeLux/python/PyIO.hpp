@@ -0,0 +1,39 @@
+// PyIO.hpp
+#ifndef PYIO_HPP
+#define PYIO_HPP
+
+#include "backends/IOContext.hpp"
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+/**
+ * @brief Read callbacks over a Python source.
+ *
+ * A bytes-like object (bytes, bytearray, memoryview, numpy array) is read in
+ * place and can seek. Any other object is read as a binary file through
+ * readinto() or read(), and seeks through seek() and tell() when seekable()
+ * says so. The callbacks take the GIL themselves, so decoder threads can call
+ * them; a Python exception is reported as unraisable and read as an I/O error.
+ *
+ * @param source Bytes-like or file-like object, referenced by the callbacks.
+ * @param bufferSize Size of the buffer FFmpeg reads through.
+ * @throws std::invalid_argument if source has no read() method.
+ */
+std::shared_ptr<celux::IOCallbacks> inputFromPython(const py::object& source,
+                                                    int bufferSize);
+
+/**
+ * @brief Write callbacks over a Python binary file object.
+ *
+ * Data goes to write(); seek() and tell() are used when seekable() says so,
+ * which containers such as mp4 need to finish the file.
+ *
+ * @param sink File-like object, referenced by the callbacks.
+ * @param bufferSize Size of the buffer FFmpeg writes through.
+ * @throws std::invalid_argument if sink has no write() method.
+ */
+std::shared_ptr<celux::IOCallbacks> outputToPython(const py::object& sink,
+                                                   int bufferSize);
+
+#endif // PYIO_HPP
@@ -0,0 +1,30 @@
+// PyStats.hpp
+#ifndef PYSTATS_HPP
+#define PYSTATS_HPP
+
+#include "Stats.hpp"
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+// Per-stage {"seconds", "calls"} dicts by stage name, plus the frame count
+inline py::dict statsToDict(celux::Stats& stats, bool reset)
+{
+    py::dict result;
+    for (size_t i = 0; i < celux::Stats::StageCount; ++i)
+    {
+        const auto stage = static_cast<celux::Stats::Stage>(i);
+        py::dict entry;
+        entry["seconds"] = stats.seconds(stage);
+        entry["calls"] = stats.calls(stage);
+        result[celux::Stats::name(stage)] = entry;
+    }
+    result["frames"] = stats.frames();
+    if (reset)
+    {
+        stats.reset();
+    }
+    return result;
+}
+
+#endif // PYSTATS_HPP
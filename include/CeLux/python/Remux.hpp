@@ -0,0 +1,43 @@
+// Remux.hpp
+#ifndef REMUX_HPP
+#define REMUX_HPP
+
+#include "Factory.hpp"
+#include <utility>
+
+/**
+ * @brief Range and caching options for remux().
+ */
+struct RemuxOptions
+{
+    // Frames to copy, end exclusive; -1 copies to the end of the video
+    int startFrame = 0;
+    int endFrame = -1;
+    // Same range in seconds, used instead of the frame numbers when >= 0: from
+    // the frame on screen at startTime to the one on screen at endTime,
+    // exclusive. Seconds are on the timeline of the PTS returned with frames,
+    // see celux::Decoder::frameAtTime().
+    double startTime = -1.0;
+    double endTime = -1.0;
+    // Where to persist the seek index, see celux::Decoder::setSeekIndexCache()
+    std::string indexCache;
+};
+
+/**
+ * @brief Copy the video stream of `inputPath` into a new container without
+ * decoding or encoding it.
+ *
+ * Packets are copied as they are, so the cut is made on keyframes: the clip
+ * starts at the keyframe at or before the first requested frame and ends before
+ * the first keyframe at or after the end of the range. The output container is
+ * picked from the extension of `outputPath`.
+ *
+ * @return The copied range [first frame, end frame) in source frame numbers.
+ * @throws std::invalid_argument if the range is empty or outside the video.
+ * @throws CxException if the stream has no timestamps to cut on, or the output
+ * container can't carry its codec.
+ */
+std::pair<int, int> remux(const std::string& inputPath, const std::string& outputPath,
+                          const RemuxOptions& options);
+
+#endif // REMUX_HPP
@@ -0,0 +1,97 @@
+// Transcoder.hpp
+#ifndef TRANSCODER_HPP
+#define TRANSCODER_HPP
+
+#include "Factory.hpp"
+#include <torch/extension.h>
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+/**
+ * @brief Re-encodes a video without leaving the decoder's pixel format.
+ *
+ * Decoded frames go to the encoder as they are: on CUDA the NVDEC surfaces are
+ * read in place by NVENC through one shared device context, so no color
+ * conversion, host copy or Python call happens per frame. A resize or crop is
+ * done by NVDEC's scaler before the frames leave the decoder.
+ */
+class Transcoder
+{
+  public:
+    /**
+     * @brief Optional transcoder configuration.
+     */
+    struct Options
+    {
+        // Output encoder, see VideoWriter::Options::codec
+        std::string codec;
+        // Output frame rate, exact or as a decimal (29.97 reads as 30000/1001);
+        // {0, 1} and 0 keep the source's
+        AVRational frameRate = {0, 1};
+        double fps = 0.0;
+        // NVDEC crop/resize (hwCrop*, hwResize*) and decoder threading
+        celux::Decoder::Options decoder;
+        // Preset, tune, rate control, GOP and codec private options
+        celux::Encoder::Options encoder;
+        // Copy the input's audio, if it has any, into the output
+        bool copyAudio = true;
+    };
+
+    /**
+     * @brief Opens the input and creates the output.
+     *
+     * @param inputPath Video to read.
+     * @param outputPath Output file; the container is picked from its extension.
+     * @param device "cuda", "cuda:N" or "cpu". On CPU the decoded frames must be
+     * in a format the encoder takes (e.g. yuv420p for mpeg4 or libx264).
+     * @param options Optional configuration.
+     * @throws std::invalid_argument if the source is not 8-bit 4:2:0 on CUDA.
+     */
+    Transcoder(const std::string& inputPath, const std::string& outputPath,
+               const std::string& device, const Options& options);
+
+    ~Transcoder();
+
+    /**
+     * @brief Transcode until the end of the input or `maxFrames` frames.
+     *
+     * Without a callback the GIL is released for the whole run. A callback is
+     * called with the frame's planes as 2D tensors aliasing the decoded surface
+     * (see VideoReader::readRaw()): callback(y, uv) for the NV12 surfaces on
+     * CUDA, callback(y, u, v) for YUV420P on CPU. It may edit them in place and
+     * return None, or return a new [H * 3 / 2, W] uint8 NV12 tensor to encode
+     * instead. On CUDA its work on the current stream is finished before the
+     * frame is encoded.
+     *
+     * @param maxFrames Frames to write at most; negative for all.
+     * @return Number of frames written by this call.
+     */
+    int run(const py::object& callback, int maxFrames);
+
+    /**
+     * @brief Drain the encoder, write the trailer and release the codecs.
+     */
+    void close();
+
+    /**
+     * @brief Output size and frame rate.
+     */
+    py::dict getProperties() const;
+
+  private:
+    /**
+     * @brief Hand the planes of `frame` to `callback` and encode the result.
+     */
+    void process(const py::object& callback);
+
+    std::unique_ptr<celux::Decoder> decoder;
+    std::unique_ptr<celux::Encoder> encoder;
+    torch::Device torchDevice;
+    celux::Frame frame; // Decoded frame being transcoded
+    int width = 0;      // Output size
+    int height = 0;
+    double fps = 0.0;
+};
+
+#endif // TRANSCODER_HPP
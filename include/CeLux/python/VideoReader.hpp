@@ -4,8 +4,13 @@
 #define VIDEOREADER_HPP
 
 #include "Factory.hpp"
+#include "FramePool.hpp"
+#include "PinnedStaging.hpp"
+#include "SPSCQueue.hpp"
 #include <torch/extension.h>
 #include <pybind11/pybind11.h>
+#include <exception>
+#include <thread>
 namespace py = pybind11;
 
 // Enum for copy types
@@ -18,16 +23,57 @@ enum class CopyType
 class VideoReader
 {
   public:
+    /**
+     * @brief Optional reader configuration.
+     */
+    struct Options
+    {
+        // Frames to decode ahead on a background thread; 0 decodes synchronously
+        // on the calling thread
+        int prefetch = 0;
+        // When > 0, readFrame() and iteration return BHWC batches of this size
+        int batchSize = 0;
+        // Pooled output frames recycled once Python drops them (or hands them
+        // back with release())
+        int poolSize = 2;
+        // Where to persist the seek index: "sidecar", a directory, or empty to
+        // rebuild it on every open
+        std::string indexCache;
+        // Count frames exactly (container count for MP4/MOV, packet scan
+        // otherwise) instead of estimating them from duration and fps
+        bool exactFrameCount = false;
+        // Decoder threading and NVDEC scaling, see celux::Decoder::Options
+        celux::Decoder::Options decoder;
+        // Output layout (HWC/CHW), normalization, crop and resize fused into the
+        // conversion
+        celux::conversion::ConversionOptions conversion;
+        // CUDA: cudaStream_t to queue conversions on, e.g. the caller's current
+        // stream, so later work on it is ordered after each frame without a
+        // synchronize. Null uses a private stream. With outputDevice, the
+        // stream the host-to-device copies are queued on.
+        void* stream = nullptr;
+        // "cuda" or "cuda:N" to return frames decoded and converted on the CPU
+        // as tensors on that GPU, copied through pinned staging buffers while
+        // the next frame decodes. Empty returns frames on the decode device.
+        std::string outputDevice;
+        // CUDA: decode in the process-wide context on the primary CUDA context
+        // instead of creating a context per reader
+        bool shareDeviceContext = true;
+        // Return each frame's PTS along with it, see withPts()
+        bool returnPts = false;
+    };
+
     /**
      * @brief Constructs a VideoReader object.
      *
      * @param filePath Path to the video file.
-     * @param useHardware Flag to indicate whether to use hardware acceleration.
-     * @param hwType Type of hardware acceleration (e.g., "cuda").
-     * @param config Configuration for frame processing.
+     * @param device Decode backend, "cuda" or "cpu". Frames are returned on it
+     * unless Options::outputDevice moves them.
+     * @param dtype Output data type ("uint8", "float32" or "float16").
+     * @param options Optional configuration.
      */
-    VideoReader(const std::string& filePath, const std::string& device = "cuda",
-                const std::string& dtype = "uint8");
+    VideoReader(const std::string& filePath, const std::string& device,
+                const std::string& dtype, const Options& options);
 
     /**
      * @brief Destructor for VideoReader.
@@ -41,10 +87,88 @@ class VideoReader
      * py::array<uint8_t>. Shape is always HWC. If batch size is specified in Reader
      * config, output shape will be BHWC for Tensors.
      *
+     * On CUDA the conversion may still be running when this returns. Work queued
+     * afterwards on the calling thread's current torch stream waits for it, so no
+     * sync() is needed to use the frame from PyTorch.
+     *
      * @return  torch::Tensor (torch::Tensor or py::array<uint8_t>)
      */
     torch::Tensor readFrame();
 
+    /**
+     * @brief Read up to n frames into one BHWC tensor.
+     *
+     * Frames are decoded straight into slices of a pooled [n, H, W, 3]
+     * tensor with the GIL released once for the whole batch. On CUDA all
+     * conversions are queued on the converter stream and the caller's current
+     * stream is made to wait for them once, without blocking the host.
+     *
+     * @param n Number of frames to read.
+     * @return torch::Tensor of shape [k, H, W, 3] with k <= n (k < n only at the
+     * end of the stream). Batches come from a pool of Options::poolSize
+     * tensors and are never overwritten while still referenced.
+     */
+    torch::Tensor readBatch(int n);
+
+    /**
+     * @brief Read the next frame as the decoder's raw planes, without conversion.
+     *
+     * Each plane is returned as a 2D [rows, row elements] tensor (e.g. Y and
+     * interleaved UV for NV12) that aliases the decoded surface with its native
+     * pitch as the row stride. On CUDA the planes stay in device memory. The
+     * surface is kept referenced until every plane has been released.
+     *
+     * @param dlpack Return DLPack capsules instead of tensors.
+     * @return py::list One entry per plane.
+     */
+    py::list readRaw(bool dlpack);
+
+    /**
+     * @brief Read the frames on screen at each of `times`.
+     *
+     * The times are mapped to frames through the seek index and decoded in
+     * presentation order, so a GOP holding several requested frames is decoded
+     * once, and frames between two of them are not converted. A time asked for
+     * twice, or two times within one frame, share the frame.
+     *
+     * The reader then continues after the last frame decoded.
+     *
+     * @param times Seconds, on the timeline of the PTS returned with frames.
+     * @return [len(times), H, W, 3] tensor in the order of `times`.
+     * @throws std::out_of_range for a time outside the video.
+     * @throws std::runtime_error if the stream has no timestamps to index.
+     */
+    torch::Tensor getFramesAt(const std::vector<double>& times);
+
+    /**
+     * @brief What a read returns to Python: `frames` itself, or with
+     * Options::returnPts a (frames, seconds, pts) tuple for the frames just read.
+     *
+     * PTS are in the stream's time base (getProperties()["time_base"]), seconds
+     * are pts * time base. For a single frame they are a float and an int (None
+     * when the frame has no PTS); for batches, float64 and int64 tensors with
+     * NaN seconds for frames without one.
+     *
+     * @param batched Whether `frames` has a leading batch dimension.
+     */
+    py::object withPts(const torch::Tensor& frames, bool batched) const;
+
+    /**
+     * @brief Frames per readFrame() and iteration step; 0 for single frames.
+     */
+    int getBatchSize() const;
+
+    /**
+     * @brief Hand a frame back to the output pool before its last reference goes.
+     *
+     * The frame's memory may be overwritten by any later read.
+     *
+     * @param frame Frame or batch previously returned by readFrame() or
+     * readBatch().
+     * @return true if the frame belonged to the pool.
+     */
+    bool releaseFrame(const torch::Tensor& frame);
+
     /**
      * @brief Seek to a specific timestamp in the video.
      *
@@ -53,6 +177,18 @@ class VideoReader
      */
     bool seek(double timestamp);
 
+    /**
+     * @brief Seek so that the next frame read is exactly `frame_number`.
+     *
+     * Unlike seek(), this lands on the requested frame rather than on the
+     * keyframe before it. The first call scans the file's packets to build a
+     * keyframe index.
+     *
+     * @param frame_number Zero-based frame number in presentation order.
+     * @return true if seek was successful, false otherwise.
+     */
+    bool seekToFrame(int frame_number);
+
     /**
      * @brief Get a list of supported codecs.
      *
@@ -67,6 +203,22 @@ class VideoReader
      */
     py::dict getProperties() const;
 
+    /**
+     * @brief Time spent demuxing, decoding and converting since opening or the
+     * last reset, and the frames waiting in the prefetch queue.
+     *
+     * @param reset Zero the counters after reading them.
+     * @return Dict of {"seconds", "calls"} per stage (see celux::Stats), plus
+     * "frames" decoded and "queue_depth".
+     * @throws std::runtime_error once the reader is closed.
+     */
+    py::dict getStats(bool reset);
+
+    /**
+     * @brief Path the reader was opened with.
+     */
+    const std::string& getFilePath() const;
+
     /**
      * @brief Reset the video reader to the beginning.
      */
@@ -105,33 +257,144 @@ class VideoReader
 
     void sync();
 
+    /**
+     * @brief Parse an output data type name ("uint8", "uint16", "float32" or
+     * "float16").
+     *
+     * @param torchType Set to the matching tensor type.
+     * @throws std::invalid_argument for other names.
+     */
+    static celux::dataType parseDataType(const std::string& name,
+                                         torch::Dtype& torchType);
+
+    /**
+     * @brief Conversion for frames of `pixelFormat` decoded on `backend`.
+     *
+     * @throws std::invalid_argument if uint16 output is asked of a source that
+     * isn't 10-bit or deeper on cuda.
+     */
+    static celux::ConversionType conversionFor(celux::backend backend,
+                                               AVPixelFormat pixelFormat,
+                                               celux::dataType dtype);
+
   private:
 
-    bool seekToFrame(int frame_number);
+    /**
+     * @brief Start the decode-ahead worker (no-op when prefetch is disabled).
+     */
+    void startPrefetch();
+
+    /**
+     * @brief Stop and join the decode-ahead worker, discarding queued frames.
+     */
+    void stopPrefetch();
+
+    /**
+     * @brief Worker loop: decodes into pooled frames and publishes them.
+     */
+    void prefetchLoop();
+
+    /**
+     * @brief Put the decoder back where reads continue, after a failed seek or
+     * lookup moved it (e.g. by building the seek index) or stopPrefetch()
+     * discarded the frames decoded ahead.
+     */
+    void restorePosition();
 
     /**
      * @brief Close the video reader and release resources.
      */
     void close();
 
+    /**
+     * @brief Shape of one output frame ([H, W, 3] or [3, H, W]), optionally with a
+     * leading batch dimension.
+     */
+    std::vector<int64_t> frameShape(int64_t batch = 0) const;
+
+    /**
+     * @brief The calling thread's current torch CUDA stream, which returned frames
+     * are ordered with; null when frames are returned on the CPU.
+     */
+    void* consumerStream() const;
+
+    /**
+     * @brief Decode and convert the next frame into `output`, through the
+     * staging buffers when frames are returned on another device.
+     *
+     * @return false at the end of the stream.
+     */
+    bool decodeInto(const torch::Tensor& output);
+
+    /**
+     * @brief Make `stream` wait for the frames decoded so far, including their
+     * copies to the output device. See celux::Decoder::orderBefore().
+     */
+    void orderBefore(void* stream);
+
+    /**
+     * @brief Make later conversions and copies wait for the work queued on
+     * `stream`. See celux::Decoder::orderAfter().
+     */
+    void orderAfter(void* stream);
+
     // Member variables
     std::unique_ptr<celux::Decoder> decoder;
     celux::Decoder::VideoProperties properties;
+    int outputWidth = 0;  // Size of returned frames after crop/resize
+    int outputHeight = 0;
     std::string device;
+    std::string filePath;
 
-    torch::Device torchDevice;
+    torch::Device torchDevice;  // Decode device
+    torch::Device outputDevice; // Of returned frames
+
+#ifdef CUDA_ENABLED
+    // Pinned frames CPU conversions write into when outputDevice is a GPU
+    std::unique_ptr<PinnedStaging> staging;
+#endif // CUDA_ENABLED
 
     std::unique_ptr<celux::conversion::IConverter> convert;
 
     // Buffers
-    torch::Tensor RGBTensor; // For RGB conversion (GPU)
-    torch::Tensor cpuTensor; // For CPU conversion (CPU)
+    torch::TensorOptions outputOptions; // dtype/device of returned frames
+    bool planar = false;  // CHW frames, from Options::conversion
+    // Frames are decoded directly into pooled tensors and returned without a
+    // copy. A pooled frame is only reused once Python no longer references it.
+    std::unique_ptr<FramePool> framePool;
+    std::unique_ptr<FramePool> batchPool; // BHWC outputs of batched reads
+    int batchFrames = 0;                  // Frames per pooled batch
+    int batchSize = 0;
+    int poolSize = 2;
     celux::Frame frame;      // Decoded frame
+    celux::Frame rawFrame;   // Staging for readRaw()
     int start_frame = 0;
     int end_frame = -1; // -1 indicates no limit
 
     // Iterator state
     int currentIndex;
+    int stride = 1;             // Source frames per returned frame
+    bool keyframesOnly = false; // Frame numbers are then not tracked
+    bool returnPts = false;
+    AVRational timeBase = {0, 1};     // Of the video stream
+    std::vector<int64_t> returnedPts; // Frames returned by the last read
+    // Where reads continue, see restorePosition(): after resumePts, the last
+    // frame returned, or when none was returned since the last seek, at
+    // resumeTime for seek() and at currentIndex for seekToFrame()
+    int64_t resumePts = AV_NOPTS_VALUE;
+    double resumeTime = -1.0;
+
+    // Decode-ahead state. The worker fills frames taken from framePool and queues
+    // them; they return to the pool once the consumer lets go of them.
+    int prefetchDepth = 0;
+    struct DecodedFrame
+    {
+        torch::Tensor tensor;
+        int64_t pts = AV_NOPTS_VALUE;
+    };
+    std::unique_ptr<celux::SPSCQueue<DecodedFrame>> readyFrames;
+    std::thread prefetchThread;
+    std::exception_ptr prefetchError;
 };
 
 #endif // VIDEOREADER_HPP
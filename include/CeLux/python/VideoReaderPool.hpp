@@ -0,0 +1,141 @@
+// VideoReaderPool.hpp
+#ifndef VIDEOREADERPOOL_HPP
+#define VIDEOREADERPOOL_HPP
+
+#include "Factory.hpp"
+#include <torch/extension.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Reads clips from many videos on a pool of decode threads.
+ *
+ * Each worker thread keeps the decoders it opened last, so clips from the same
+ * files don't reopen them, and all CUDA decoders share one device context.
+ * Clips are grouped by file and handed to whichever worker is free next. Once
+ * every file is taken, an idle worker steals the later half of the clips left
+ * in the file with the most, so one long file doesn't leave the others idle.
+ */
+class VideoReaderPool
+{
+  public:
+    /**
+     * @brief Optional pool configuration.
+     */
+    struct Options
+    {
+        // Decode threads; 0 uses one per core
+        int workers = 0;
+        // Decoders each worker keeps open between files, least recently used
+        // first to close
+        int openDecoders = 1;
+        // Where to persist seek indexes, see VideoReader::Options::indexCache
+        std::string indexCache;
+        // Decoder threading and NVDEC scaling, see celux::Decoder::Options
+        celux::Decoder::Options decoder;
+        // Output layout, normalization, crop and resize, as in VideoReader
+        celux::conversion::ConversionOptions conversion;
+        // CUDA: decode in the process-wide device context
+        bool shareDeviceContext = true;
+    };
+
+    /**
+     * @brief `count` frames of `path` from frame `start` on.
+     */
+    struct Clip
+    {
+        std::string path;
+        int start = 0;
+        int count = 0;
+    };
+
+    /**
+     * @brief Starts the worker threads; files are opened by readClips().
+     *
+     * @param device "cuda", "cuda:N" or "cpu".
+     * @param dtype Output data type, see VideoReader.
+     * @param options Optional configuration.
+     */
+    VideoReaderPool(const std::string& device, const std::string& dtype,
+                    const Options& options);
+
+    ~VideoReaderPool();
+
+    VideoReaderPool(const VideoReaderPool&) = delete;
+    VideoReaderPool& operator=(const VideoReaderPool&) = delete;
+
+    /**
+     * @brief Decode every clip, in parallel across files.
+     *
+     * Clips of one file are read in order of their start frame by one worker,
+     * which seeks only when a clip doesn't follow the previous one. Workers left
+     * without a file take over the later clips of another one with a decoder of
+     * their own. Must be called without the GIL held by the workers, i.e. from
+     * Python through the binding, which releases it.
+     *
+     * @return One [count, H, W, 3] (or [count, 3, H, W]) tensor per clip, in the
+     * order of `clips`, ready to read on any stream. Clips running past the end
+     * of their file are shorter.
+     * @throws std::out_of_range if a clip starts outside its file; the first
+     * error of any clip is rethrown once all workers are done.
+     */
+    std::vector<torch::Tensor> readClips(const std::vector<Clip>& clips);
+
+    /**
+     * @brief Stop the workers and close their decoders.
+     */
+    void close();
+
+    int workerCount() const;
+
+  private:
+    // A file a worker has open
+    struct Source
+    {
+        std::string path;
+        std::unique_ptr<celux::Decoder> decoder;
+        std::vector<int64_t> frameShape; // One output frame
+        int nextFrame = 0;               // Frame the decoder reads next
+    };
+
+    // Clips of one file, or a run of them, by start frame
+    struct Group
+    {
+        std::string path;
+        std::vector<size_t> clips;
+        size_t next = 0; // Next clip to read, guarded by mutex
+        size_t end = 0;  // Clips from here on were stolen by another worker
+    };
+
+    void workerLoop();
+    void readGroup(std::list<Source>& sources, Group& group);
+    // With every group taken, the one with the most clips left to steal from;
+    // null if none has two. Called with mutex held.
+    Group* stealable();
+    Source& open(std::list<Source>& sources, const std::string& path);
+
+    celux::backend backend;
+    torch::Device torchDevice;
+    celux::dataType dtype;
+    torch::TensorOptions outputOptions;
+    Options options;
+
+    std::vector<std::thread> threads;
+    std::mutex callMutex; // One readClips() at a time
+    std::mutex mutex;     // Guards the job below
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    const std::vector<Clip>* clips = nullptr;
+    std::deque<Group> groups; // Grows while workers hold references into it
+    size_t nextGroup = 0;
+    size_t pendingGroups = 0;
+    std::vector<torch::Tensor> results;
+    std::exception_ptr error;
+};
+
+#endif // VIDEOREADERPOOL_HPP
@@ -3,34 +3,175 @@
 #define VIDEOWRITER_HPP
 
 #include "Factory.hpp"
+#include "SPSCQueue.hpp"
 #include <torch/extension.h>
 #include <pybind11/pybind11.h>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace py = pybind11;
 
 class VideoWriter
 {
   public:
-    VideoWriter(const std::string& filePath, int width, int height, float fps,
-                const std::string& device, const std::string& dtype);
+    /**
+     * @brief Optional writer configuration.
+     */
+    struct Options
+    {
+        // CUDA: cudaStream_t the input conversion is queued on, e.g. the stream
+        // that produced the frames. Null uses a private stream.
+        void* stream = nullptr;
+        // Frames writeFrame() may queue for a background thread that converts,
+        // encodes and muxes them; 0 writes on the calling thread
+        int queueSize = 0;
+        // "h264", "hevc" or "av1" select NVENC on CUDA and FFmpeg's default
+        // software encoder on CPU; any other FFmpeg encoder name is used as is.
+        // Empty is "h264".
+        std::string codec;
+        // Exact frame rate (e.g. 30000/1001); {0, 1} derives it from fps
+        AVRational frameRate = {0, 1};
+        // Layout of written frames: "rgb" or "bgr" [H, W, 3], or "nv12"
+        // [H * 3 / 2, W] uint8 copied into the encoder's frames as is.
+        // Empty is "rgb".
+        std::string inputFormat;
+        // Preset, tune, rate control, GOP and codec private options
+        celux::Encoder::Options encoder;
+    };
+
+    /**
+     * @brief Constructs a VideoWriter object.
+     *
+     * @param filePath Output file; the container is picked from its extension.
+     * @param device Encode backend, "cuda", "cuda:N" or "cpu".
+     * @param dtype Input data type ("uint8", "float32" or "float16").
+     * @param options Optional configuration.
+     */
+    VideoWriter(const std::string& filePath, int width, int height, double fps,
+                const std::string& device, const std::string& dtype,
+                const Options& options);
 
     ~VideoWriter();
 
-    bool writeFrame(torch::Tensor frame); // will ahve to determine what type of object frame is,
-                           // tensor vs numpy array, uint8_t vs float32, float16
+    /**
+     * @brief Encode a frame, or queue it when a queue size was given.
+     *
+     * A queued frame is referenced, not copied, so it must not be modified until
+     * flush() returns. Blocks while the queue is full. The GIL is released while
+     * waiting or encoding.
+     *
+     * @throws std::exception raised while writing an earlier queued frame.
+     */
+    bool writeFrame(torch::Tensor frame);
+
+    /**
+     * @brief Encode a batch of frames, [B, H, W, 3] or [B, H * 3 / 2, W] for
+     * NV12, in one call.
+     *
+     * The B conversions are queued back to back on one stream and waited for
+     * once before the frames go to the encoder. With a queue, the batch takes a
+     * single queue slot. See writeFrame().
+     */
+    bool writeBatch(torch::Tensor frames);
+
+    /**
+     * @brief Wait until every queued frame has been encoded and written.
+     *
+     * The encoder is not drained, so frames it still buffers are written by
+     * close().
+     *
+     * @throws std::exception raised while writing a queued frame.
+     */
+    void flush();
 
     std::vector<std::string> supportedCodecs();
 
+    /**
+     * @brief Time spent copying input to the device, converting, encoding and
+     * muxing since opening or the last reset, and the frames waiting in the
+     * write queue.
+     *
+     * @param reset Zero the counters after reading them.
+     * @return Dict of {"seconds", "calls"} per stage (see celux::Stats), plus
+     * "frames" encoded and "queue_depth".
+     */
+    py::dict getStats(bool reset);
+
     /**
      * @brief Close the video writer and release resources.
      */
     void close();
 
+    /**
+     * @brief FFmpeg encoder for `codec` on a backend: "h264", "hevc" and "av1"
+     * select NVENC on CUDA; other names, and every name on CPU, are used as is.
+     * Empty is "h264".
+     */
+    static std::string encoderName(const std::string& codec, bool cuda);
+
   private:
+    /**
+     * @brief Worker loop: encodes queued frames until the queue is closed.
+     */
+    void writeLoop();
+
+    /**
+     * @brief Stop and join the worker after it has written every queued frame.
+     */
+    void stopWriter();
+
+    /**
+     * @brief Rethrow (once) the first error raised by the worker.
+     */
+    void rethrowWriteError();
+
+    /**
+     * @brief Check that `frames` is one frame, or a batch of frames when `batch`,
+     * of the writer's size, input format and dtype, and make it contiguous on
+     * the writer's device.
+     *
+     * @throws std::invalid_argument on a shape or dtype mismatch.
+     */
+    torch::Tensor prepareInput(const torch::Tensor& frames, bool batch) const;
+
+    /**
+     * @brief Queue `frames`, or encode them right away without a queue.
+     */
+    void submit(torch::Tensor frames);
+
+    /**
+     * @brief Convert and encode one frame or a batch of frames.
+     */
+    void encode(const torch::Tensor& frames);
+
+    /**
+     * @brief The calling thread's current torch CUDA stream, which input frames
+     * are ordered after; null on the CPU backend.
+     */
+    void* producerStream() const;
+
     std::unique_ptr<celux::Encoder> encoder;
 
     std::unique_ptr<celux::conversion::IConverter> convert;
 
+    torch::Device torchDevice; // Device frames are encoded from
+    int width;                 // Expected frame size and type
+    int height;
+    torch::Dtype inputType = torch::kUInt8;
+    bool nv12Input = false;    // Frames are [H * 3 / 2, W] NV12
+
+    // Asynchronous write state. Frames stay referenced in the queue until the
+    // worker has encoded them.
+    std::unique_ptr<celux::SPSCQueue<torch::Tensor>> pendingFrames;
+    std::thread writeThread;
+    std::mutex writeMutex; // Guards the counters and writeError
+    std::condition_variable framesWritten;
+    int64_t queuedCount = 0;
+    int64_t writtenCount = 0;
+    std::exception_ptr writeError;
+
 };
 
 #endif // VideoWriter_HPP
@@ -0,0 +1,232 @@
+// Logger.cpp
+
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+extern "C"
+{
+#include <libavutil/log.h>
+}
+
+namespace celux
+{
+namespace
+{
+// Enough for a burst of per-stream messages when a file opens, few enough that
+// a message repeated per frame can't stall the pipeline on stderr
+constexpr int DefaultRateLimit = 100;
+
+LogLevel levelFromEnvironment()
+{
+    const char* name = std::getenv("CELUX_LOG_LEVEL");
+    if (!name)
+    {
+        return LogLevel::Off;
+    }
+    try
+    {
+        return Logger::parseLevel(name);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return LogLevel::Off;
+    }
+}
+
+// Token bucket, refilled at rateLimit per second up to rateLimit tokens
+struct RateLimiter
+{
+    std::mutex mutex;
+    int rateLimit = DefaultRateLimit;
+    double tokens = DefaultRateLimit;
+    std::chrono::steady_clock::time_point refilled = std::chrono::steady_clock::now();
+    int64_t suppressed = 0;
+    Logger::Sink sink;
+};
+
+RateLimiter& limiter()
+{
+    static RateLimiter instance;
+    return instance;
+}
+
+LogLevel fromFFmpeg(int level)
+{
+    if (level <= AV_LOG_ERROR)
+    {
+        return LogLevel::Error;
+    }
+    if (level <= AV_LOG_WARNING)
+    {
+        return LogLevel::Warning;
+    }
+    if (level <= AV_LOG_INFO)
+    {
+        return LogLevel::Info;
+    }
+    return LogLevel::Debug;
+}
+
+void ffmpegCallback(void* avcl, int level, const char* fmt, va_list vl)
+{
+    // AV_LOG_QUIET messages are never shown, AV_LOG_TRACE ones are too chatty
+    if (level < 0 || level > AV_LOG_DEBUG)
+    {
+        return;
+    }
+    const LogLevel mapped = fromFFmpeg(level);
+    if (!Logger::enabled(mapped))
+    {
+        return;
+    }
+
+    // FFmpeg may print one line over several calls; prefix state is per thread
+    // as each decoder thread logs its own lines
+    thread_local int printPrefix = 1;
+    thread_local std::string pending;
+    char line[1024];
+    av_log_format_line2(avcl, level, fmt, vl, line, sizeof(line), &printPrefix);
+    pending += line;
+    if (pending.empty() || pending.back() != '\n')
+    {
+        return;
+    }
+    pending.pop_back();
+    Logger::write(mapped, "[ffmpeg] " + pending);
+    pending.clear();
+}
+} // namespace
+
+std::atomic<LogLevel> Logger::currentLevel{levelFromEnvironment()};
+
+void Logger::setLevel(LogLevel level)
+{
+    currentLevel.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::level()
+{
+    return currentLevel.load(std::memory_order_relaxed);
+}
+
+void Logger::setRateLimit(int perSecond)
+{
+    if (perSecond < 0)
+    {
+        throw std::invalid_argument("Log rate limit must be 0 (none) or positive");
+    }
+    RateLimiter& state = limiter();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.rateLimit = perSecond;
+    state.tokens = perSecond;
+}
+
+void Logger::setSink(Sink sink)
+{
+    RateLimiter& state = limiter();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.sink = std::move(sink);
+}
+
+void Logger::write(LogLevel level, const std::string& message)
+{
+    RateLimiter& state = limiter();
+    int64_t suppressed = 0;
+    Sink sink;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.rateLimit > 0)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const double elapsed =
+                std::chrono::duration<double>(now - state.refilled).count();
+            state.refilled = now;
+            state.tokens = std::min<double>(state.rateLimit,
+                                            state.tokens + elapsed * state.rateLimit);
+            if (state.tokens < 1.0)
+            {
+                ++state.suppressed;
+                return;
+            }
+            state.tokens -= 1.0;
+        }
+        suppressed = state.suppressed;
+        state.suppressed = 0;
+        sink = state.sink;
+    }
+
+    std::string text = message;
+    if (suppressed > 0)
+    {
+        text += " (" + std::to_string(suppressed) +
+                " earlier messages suppressed by the rate limit)";
+    }
+    if (sink)
+    {
+        sink(level, text);
+        return;
+    }
+    // One unbuffered write per message, so lines from threads don't interleave
+    const std::string line =
+        std::string("[celux] [") + levelName(level) + "] " + text + "\n";
+    std::fwrite(line.data(), 1, line.size(), stderr);
+}
+
+void Logger::installFFmpegCallback()
+{
+    av_log_set_callback(ffmpegCallback);
+}
+
+LogLevel Logger::parseLevel(const std::string& name)
+{
+    if (name == "debug")
+    {
+        return LogLevel::Debug;
+    }
+    if (name == "info")
+    {
+        return LogLevel::Info;
+    }
+    if (name == "warning")
+    {
+        return LogLevel::Warning;
+    }
+    if (name == "error")
+    {
+        return LogLevel::Error;
+    }
+    if (name == "off")
+    {
+        return LogLevel::Off;
+    }
+    throw std::invalid_argument("Unknown log level: " + name +
+                                " (expected 'debug', 'info', 'warning', 'error' "
+                                "or 'off')");
+}
+
+const char* Logger::levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Debug:
+        return "debug";
+    case LogLevel::Info:
+        return "info";
+    case LogLevel::Warning:
+        return "warning";
+    case LogLevel::Error:
+        return "error";
+    case LogLevel::Off:
+        return "off";
+    }
+    return "off";
+}
+
+} // namespace celux
@@ -1,5 +1,7 @@
 // Decoder.cpp
 #include "Decoder.hpp"
+#include <cmath>
+#include <cstring>
 using namespace celux::error;
 namespace celux
 {
@@ -11,19 +13,35 @@ Decoder::Decoder(std::unique_ptr<celux::conversion::IConverter> converter)
     // Constructor does minimal work
 }
 
+Decoder::Decoder(std::unique_ptr<celux::conversion::IConverter> converter,
+                 const Options& options)
+    : Decoder(std::move(converter))
+{
+    this->options = options;
+}
+
 Decoder::~Decoder()
 {
     close();
 }
 
 Decoder::Decoder(Decoder&& other) noexcept
-    : formatCtx(std::move(other.formatCtx)), codecCtx(std::move(other.codecCtx)),
+    : ioContext(std::move(other.ioContext)), formatCtx(std::move(other.formatCtx)),
+      codecCtx(std::move(other.codecCtx)),
       pkt(std::move(other.pkt)), videoStreamIndex(other.videoStreamIndex),
       properties(std::move(other.properties)), frame(std::move(other.frame)),
+      options(other.options), draining(other.draining),
+      pendingFrame(other.pendingFrame), lastPts(other.lastPts),
+      seekIndex(std::move(other.seekIndex)),
+      seekIndexCache(std::move(other.seekIndexCache)),
       converter(std::move(other.converter)), hwDeviceCtx(std::move(other.hwDeviceCtx))
 {
+    stats.takeFrom(other.stats);
     other.videoStreamIndex = -1;
-    // Reset other members if necessary
+    other.draining = false;
+    other.pendingFrame = false;
+    other.lastPts = AV_NOPTS_VALUE;
+    other.seekIndexCache.clear();
 }
 
 Decoder& Decoder::operator=(Decoder&& other) noexcept
@@ -33,22 +51,37 @@ Decoder& Decoder::operator=(Decoder&& other) noexcept
         close();
 
         formatCtx = std::move(other.formatCtx);
+        ioContext = std::move(other.ioContext);
         codecCtx = std::move(other.codecCtx);
         pkt = std::move(other.pkt);
         videoStreamIndex = other.videoStreamIndex;
         properties = std::move(other.properties);
         frame = std::move(other.frame);
+        options = other.options;
+        draining = other.draining;
+        pendingFrame = other.pendingFrame;
+        lastPts = other.lastPts;
+        seekIndex = std::move(other.seekIndex);
+        seekIndexCache = std::move(other.seekIndexCache);
         converter = std::move(other.converter);
         hwDeviceCtx = std::move(other.hwDeviceCtx);
+        stats.takeFrom(other.stats);
 
         other.videoStreamIndex = -1;
-        // Reset other members if necessary
+        other.draining = false;
+        other.pendingFrame = false;
+        other.lastPts = AV_NOPTS_VALUE;
+        other.seekIndexCache.clear();
     }
     return *this;
 }
 
 void Decoder::initialize(const std::string& filePath)
 {
+    if (options.stride < 1)
+    {
+        throw std::invalid_argument("stride must be at least 1");
+    }
     openFile(filePath);
     initHWAccel(); // Virtual function
     findVideoStream();
@@ -70,11 +103,19 @@ void Decoder::initialize(const std::string& filePath)
     vp.duration = (formatCtx->duration != AV_NOPTS_VALUE)
                       ? static_cast<double>(formatCtx->duration) / AV_TIME_BASE
                       : 0.0;
+    // Hardware decoders that pick their output format at open report the
+    // surface format (e.g. CUDA); keep the stream's own sample format
     vp.pixelFormat = codecCtx->pix_fmt;
-    vp.hasAudio = (formatCtx->streams[videoStreamIndex]->codecpar->codec_type ==
-                   AVMEDIA_TYPE_AUDIO);
+    const AVPixFmtDescriptor* pixDesc = av_pix_fmt_desc_get(vp.pixelFormat);
+    if (!pixDesc || (pixDesc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+    {
+        vp.pixelFormat = static_cast<AVPixelFormat>(
+            formatCtx->streams[videoStreamIndex]->codecpar->format);
+    }
+    vp.hasAudio = av_find_best_stream(formatCtx.get(), AVMEDIA_TYPE_AUDIO, -1, -1,
+                                      nullptr, 0) >= 0;
 
-    // Calculate total frames if possible
+    // Calculate total frames if possible; countFrames() gives an exact value
     if (vp.fps > 0 && vp.duration > 0)
     {
         vp.totalFrames = vp.duration * vp.fps;
@@ -95,13 +136,130 @@ void Decoder::openFile(const std::string& filePath)
 {
     // Open input file
     AVFormatContext* fmt_ctx = nullptr;
-    FF_CHECK_MSG(avformat_open_input(&fmt_ctx, filePath.c_str(), nullptr, nullptr),
-                 std::string("Failure Opening Input:"));
+    const char* url = filePath.c_str();
+    if (options.io)
+    {
+        // The demuxer reads through the callbacks and probes the format itself
+        ioContext = std::make_unique<IOContext>(*options.io, false);
+        fmt_ctx = avformat_alloc_context();
+        if (!fmt_ctx)
+        {
+            throw CxException("Could not allocate input format context");
+        }
+        fmt_ctx->pb = ioContext->get();
+        fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        url = "";
+    }
+
+    const AVInputFormat* inputFormat = nullptr;
+    if (!options.inputFormat.empty())
+    {
+        inputFormat = av_find_input_format(options.inputFormat.c_str());
+        if (!inputFormat)
+        {
+            avformat_free_context(fmt_ctx);
+            throw std::invalid_argument("Unknown input format: " + options.inputFormat);
+        }
+    }
+    AVDictionary* formatOptions = nullptr;
+    for (const auto& [key, value] : options.formatOptions)
+    {
+        av_dict_set(&formatOptions, key.c_str(), value.c_str(), 0);
+    }
+
+    // Frees fmt_ctx on failure. Options it does not know are left in the
+    // dictionary.
+    const int ret = avformat_open_input(&fmt_ctx, url, inputFormat, &formatOptions);
+    const AVDictionaryEntry* unused =
+        av_dict_get(formatOptions, "", nullptr, AV_DICT_IGNORE_SUFFIX);
+    const std::string unusedKey = unused ? unused->key : "";
+    av_dict_free(&formatOptions);
+    FF_CHECK_MSG(ret, std::string("Failure Opening Input:"));
     formatCtx.reset(fmt_ctx);
+    if (!unusedKey.empty())
+    {
+        throw std::invalid_argument("Option '" + unusedKey +
+                                    "' is not supported by the " +
+                                    formatCtx->iformat->name + " demuxer");
+    }
 
-    // Retrieve stream information
-    FF_CHECK_MSG(avformat_find_stream_info(formatCtx.get(), nullptr),
-                 std::string("Failure Finding Stream Info:"));
+    // Retrieve stream information, unless the header already has it
+    if (!options.skipStreamInfo || !describedByHeader())
+    {
+        FF_CHECK_MSG(avformat_find_stream_info(formatCtx.get(), nullptr),
+                     std::string("Failure Finding Stream Info:"));
+    }
+}
+
+bool Decoder::describedByHeader()
+{
+    if (formatCtx->duration == AV_NOPTS_VALUE)
+    {
+        return false;
+    }
+    const int index =
+        av_find_best_stream(formatCtx.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (index < 0)
+    {
+        return false;
+    }
+    const AVStream* stream = formatCtx->streams[index];
+    AVCodecParameters* par = stream->codecpar;
+    if (par->codec_id == AV_CODEC_ID_NONE || par->width <= 0 || par->height <= 0 ||
+        stream->avg_frame_rate.num <= 0 || stream->avg_frame_rate.den <= 0)
+    {
+        return false;
+    }
+    if (par->format != AV_PIX_FMT_NONE)
+    {
+        return true;
+    }
+
+    // Most headers leave the pixel format to the bitstream (H.264, HEVC, AV1),
+    // so parse the first packet for it, then seek back to the start. Parsing
+    // reads the sequence header without decoding anything.
+    if (!formatCtx->pb || !(formatCtx->pb->seekable & AVIO_SEEKABLE_NORMAL))
+    {
+        return false;
+    }
+    AVCodecParserContext* parser = av_parser_init(par->codec_id);
+    if (!parser)
+    {
+        return false;
+    }
+    parser->flags |= PARSER_FLAG_COMPLETE_FRAMES;
+    AVCodecContextPtr parseCtx(avcodec_alloc_context3(nullptr));
+    AVPacketPtr packet(av_packet_alloc());
+    if (!parseCtx || !packet ||
+        avcodec_parameters_to_context(parseCtx.get(), par) < 0)
+    {
+        av_parser_close(parser);
+        return false;
+    }
+    while (av_read_frame(formatCtx.get(), packet.get()) >= 0)
+    {
+        const bool video = packet->stream_index == index;
+        if (video)
+        {
+            uint8_t* out = nullptr;
+            int outSize = 0;
+            av_parser_parse2(parser, parseCtx.get(), &out, &outSize, packet->data,
+                             packet->size, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+        }
+        av_packet_unref(packet.get());
+        if (video)
+        {
+            break;
+        }
+    }
+    par->format = parser->format;
+    av_parser_close(parser);
+
+    const int64_t start =
+        formatCtx->start_time != AV_NOPTS_VALUE ? formatCtx->start_time : 0;
+    FF_CHECK_MSG(avformat_seek_file(formatCtx.get(), -1, INT64_MIN, start, start, 0),
+                 std::string("Failure Rewinding Input:"));
+    return par->format != AV_PIX_FMT_NONE;
 }
 
 void Decoder::initHWAccel()
@@ -150,13 +308,40 @@ void Decoder::initCodecContext(const AVCodec* codec)
             throw CxException("Failed to reference HW device context");
         }
        // codecCtx->get_format = getHWFormat; // Assign the member function
+        if (options.extraHwFrames > 0)
+        {
+            codecCtx->extra_hw_frames = options.extraHwFrames;
+        }
+    }
+
+    // Threading is only picked up by avcodec_open2, so configure it first
+    codecCtx->thread_count = options.threadCount;
+    codecCtx->thread_type = options.threadType;
+    if (options.keyframesOnly)
+    {
+        codecCtx->skip_frame = AVDISCARD_NONKEY;
+    }
+
+    AVDictionary* codecOptions = nullptr;
+    try
+    {
+        configureCodec(&codecOptions);
+    }
+    catch (...)
+    {
+        av_dict_free(&codecOptions);
+        throw;
     }
 
     // Open codec
-    FF_CHECK_MSG(avcodec_open2(codecCtx.get(), codec, nullptr),
-                 std::string("Failed to open codec:"));
-    codecCtx->thread_count = std::thread::hardware_concurrency();
-    codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    const int ret = avcodec_open2(codecCtx.get(), codec, &codecOptions);
+    av_dict_free(&codecOptions);
+    FF_CHECK_MSG(ret, std::string("Failed to open codec:"));
+}
+
+void Decoder::configureCodec(AVDictionary** codecOptions)
+{
+    // Default implementation does nothing
 }
 
 enum AVPixelFormat Decoder::getHWFormat(AVCodecContext* ctx,
@@ -166,75 +351,143 @@ enum AVPixelFormat Decoder::getHWFormat(AVCodecContext* ctx,
     return pix_fmts[0];
 }
 
-bool Decoder::decodeNextFrame(void* buffer)
+bool Decoder::receiveFrame()
 {
-    bool frameProcessed = false;
-    if (buffer == nullptr)
+    while (true)
     {
-        throw CxException("Buffer is null");
-    }
+        // Drain frames the decoder already has before feeding it more input
+        int ret;
+        {
+            Stats::Scope timed(stats, Stats::Stage::ReceiveFrame);
+            ret = avcodec_receive_frame(codecCtx.get(), frame.get());
+        }
+        if (ret >= 0)
+        {
+            lastPts = frame.get()->best_effort_timestamp;
+            return true;
+        }
+        if (ret == AVERROR_EOF)
+        {
+            // No more frames to decode
+            return false;
+        }
+        if (ret != AVERROR(EAGAIN))
+        {
+            throw CxException("Error during decoding");
+        }
 
-    while (!frameProcessed)
-    {
         // Attempt to read a packet from the video file
-        int ret = av_read_frame(formatCtx.get(), pkt.get());
-        if (ret < 0)
         {
-            if (ret == AVERROR_EOF)
-            {
-                // End of file: flush the decoder
-                FF_CHECK(avcodec_send_packet(codecCtx.get(), nullptr));
-            }
-            else
-            {
-                throw CxException("Error reading frame");
-            }
+            Stats::Scope timed(stats, Stats::Stage::Demux);
+            ret = av_read_frame(formatCtx.get(), pkt.get());
+        }
+        if (ret == AVERROR_EOF)
+        {
+            // End of file: flush the decoder
+            Stats::Scope timed(stats, Stats::Stage::SendPacket);
+            FF_CHECK(avcodec_send_packet(codecCtx.get(), nullptr));
+            draining = true;
+        }
+        else if (ret < 0)
+        {
+            throw CxException("Error reading frame");
         }
         else
         {
             // If the packet belongs to the video stream, send it to the decoder
-            if (pkt->stream_index == videoStreamIndex)
+            if (pkt->stream_index == videoStreamIndex &&
+                (!options.keyframesOnly || (pkt->flags & AV_PKT_FLAG_KEY)))
             {
+                Stats::Scope timed(stats, Stats::Stage::SendPacket);
                 FF_CHECK(avcodec_send_packet(codecCtx.get(), pkt.get()));
             }
             // Release the packet back to FFmpeg
             av_packet_unref(pkt.get());
         }
+    }
+}
+
+bool Decoder::nextFrame()
+{
+    // A frame-accurate seek leaves its target frame decoded but unconverted
+    if (pendingFrame)
+    {
+        pendingFrame = false;
+        return true;
+    }
+    // The first frame after opening or seeking is always returned
+    const int64_t previous = lastPts;
+    if (options.stride <= 1 || previous == AV_NOPTS_VALUE)
+    {
+        return receiveFrame();
+    }
 
-        // Attempt to receive a decoded frame
-        while (true)
+    if (!options.keyframesOnly)
+    {
+        // Go straight to the next frame wanted: seekToFrame() decodes forward
+        // within its GOP, and seeks to it from an earlier one
+        const SeekIndex& index = getSeekIndex();
+        if (index.isValid())
         {
-            ret = avcodec_receive_frame(codecCtx.get(), frame.get());
-            if (ret == AVERROR(EAGAIN))
-            {
-                // Decoder needs more data; proceed to read the next packet
-                break;
-            }
-            else if (ret == AVERROR_EOF)
+            const int next = index.frameAt(previous) + options.stride;
+            if (next >= index.frameCount())
             {
-                // No more frames to decode
                 return false;
             }
-            else if (ret < 0)
+            if (!seekToFrame(next))
             {
-                throw CxException("Error during decoding");
+                throw CxException("Failed to seek to frame " + std::to_string(next));
             }
-
-                converter->convert(frame, buffer);
-
-            frameProcessed = true;
-            break; // Successfully processed one frame
+            pendingFrame = false;
+            return true;
         }
+    }
 
-        // Exit the outer loop if a frame was processed
-        if (frameProcessed)
+    // Without timestamps to seek by, count the frames instead
+    for (int skipped = 1; skipped < options.stride; ++skipped)
+    {
+        if (!receiveFrame())
         {
-            break;
+            return false;
         }
+        av_frame_unref(frame.get());
+    }
+    return receiveFrame();
+}
+
+bool Decoder::decodeNextFrame(void* buffer)
+{
+    if (buffer == nullptr)
+    {
+        throw CxException("Buffer is null");
+    }
+    if (!nextFrame())
+    {
+        return false;
+    }
+
+    {
+        Stats::Scope timed(stats, Stats::Stage::Convert);
+        converter->beginTiming(stats);
+        converter->convert(frame, buffer);
+        converter->endTiming();
     }
-    av_packet_unref(pkt.get());
     av_frame_unref(frame.get());
-    return frameProcessed;
+    stats.addFrames(1);
+    return true;
+}
+
+bool Decoder::decodeNextRawFrame(Frame& output)
+{
+    if (!nextFrame())
+    {
+        return false;
+    }
+
+    av_frame_unref(output.get());
+    av_frame_move_ref(output.get(), frame.get());
+    stats.addFrames(1);
+    return true;
 }
 
 bool Decoder::seek(double timestamp)
@@ -254,10 +507,253 @@ bool Decoder::seek(double timestamp)
 
     // Flush codec buffers
     avcodec_flush_buffers(codecCtx.get());
+    av_frame_unref(frame.get());
+    draining = false;
+    pendingFrame = false;
+    lastPts = AV_NOPTS_VALUE;
+
+    return true;
+}
+
+int Decoder::countFrames()
+{
+    // MP4/MOV sample tables list every frame, so there the header is exact.
+    // An index that is already available is at least as good and also honours
+    // edit lists.
+    const int64_t nbFrames = formatCtx->streams[videoStreamIndex]->nb_frames;
+    const bool sampleTable =
+        formatCtx->iformat && std::strstr(formatCtx->iformat->name, "mp4") != nullptr;
+    if (!seekIndex && sampleTable && nbFrames > 0)
+    {
+        properties.totalFrames = static_cast<int>(nbFrames);
+        return properties.totalFrames;
+    }
+
+    const bool scanned = !seekIndex;
+    const int count = getSeekIndex().frameCount();
+    if (scanned)
+    {
+        seek(0.0); // The scan left the demuxer at the end of the input
+    }
+    properties.totalFrames = count;
+    return count;
+}
+
+void Decoder::setSeekIndexCache(const std::string& cache)
+{
+    seekIndexCache = cache;
+    if (seekIndex || cache.empty() || !formatCtx)
+    {
+        return;
+    }
+
+    const std::string key = SeekIndex::sourceKey(formatCtx->url);
+    SeekIndex cached;
+    if (!key.empty() &&
+        SeekIndex::load(SeekIndex::cachePath(formatCtx->url, cache), key, cached))
+    {
+        seekIndex = std::make_unique<SeekIndex>(std::move(cached));
+    }
+}
+
+const SeekIndex& Decoder::getSeekIndex()
+{
+    if (!seekIndex)
+    {
+        seekIndex = std::make_unique<SeekIndex>(
+            SeekIndex::build(formatCtx.get(), videoStreamIndex));
+        // The scan moved the demuxer, so the decoder state no longer follows it
+        lastPts = AV_NOPTS_VALUE;
+
+        if (!seekIndexCache.empty())
+        {
+            // A failed write only costs a rescan on the next open
+            const std::string key = SeekIndex::sourceKey(formatCtx->url);
+            if (!key.empty())
+            {
+                seekIndex->save(SeekIndex::cachePath(formatCtx->url, seekIndexCache),
+                                key);
+            }
+        }
+    }
+    return *seekIndex;
+}
+
+bool Decoder::seekToFrame(int frameIndex)
+{
+    const SeekIndex& index = getSeekIndex();
+    if (!index.isValid())
+    {
+        // Without timestamps the best we can do is the fps estimate
+        return properties.fps > 0 && seek(frameIndex / properties.fps);
+    }
+    if (frameIndex < 0 || frameIndex >= index.frameCount())
+    {
+        return false;
+    }
+
+    const int64_t target = index.framePts(frameIndex);
+    const int64_t keyframe = index.keyframeBefore(target);
+
+    if (pendingFrame && lastPts == target)
+    {
+        return true; // Already positioned on the target
+    }
+
+    // Within the current GOP and ahead of the decoder: just decode forward
+    const bool forward = lastPts != AV_NOPTS_VALUE && !draining && target > lastPts &&
+                         keyframe <= lastPts;
+    if (!forward && !seekToKeyframePts(index, keyframe, target))
+    {
+        return false;
+    }
+    av_frame_unref(frame.get());
+    pendingFrame = false;
+
+    // Decode up to the target, dropping earlier frames before any conversion
+    while (receiveFrame())
+    {
+        if (frame.get()->best_effort_timestamp == AV_NOPTS_VALUE ||
+            frame.get()->best_effort_timestamp >= target)
+        {
+            pendingFrame = true;
+            return true;
+        }
+        av_frame_unref(frame.get());
+    }
+    return false;
+}
 
+int Decoder::frameAtTime(double timestamp)
+{
+    const SeekIndex& index = getSeekIndex();
+    if (!index.isValid() || timestamp < 0)
+    {
+        return -1;
+    }
+    const double start = formatCtx->start_time != AV_NOPTS_VALUE
+                             ? static_cast<double>(formatCtx->start_time) / AV_TIME_BASE
+                             : 0.0;
+    if (properties.duration > 0 && timestamp > start + properties.duration)
+    {
+        return -1;
+    }
+
+    // Rounded, so a time printed from a frame's own PTS finds that frame
+    const AVRational timeBase = formatCtx->streams[videoStreamIndex]->time_base;
+    const int64_t pts = std::llround(timestamp * timeBase.den / timeBase.num);
+    int frameIndex = index.frameAt(pts);
+    if (frameIndex >= index.frameCount() || index.framePts(frameIndex) > pts)
+    {
+        --frameIndex;
+    }
+    return std::max(frameIndex, 0);
+}
+
+int64_t Decoder::lastFramePts() const
+{
+    return lastPts;
+}
+
+bool Decoder::seekToKeyframePts(const SeekIndex& index, int64_t keyframe,
+                                int64_t target)
+{
+    if (av_seek_frame(formatCtx.get(), videoStreamIndex, keyframe,
+                      AVSEEK_FLAG_BACKWARD) < 0)
+    {
+        // Some demuxers can only seek by byte offset
+        const int64_t pos = index.keyframePositionBefore(target);
+        if (pos < 0 ||
+            av_seek_frame(formatCtx.get(), videoStreamIndex, pos, AVSEEK_FLAG_BYTE) < 0)
+        {
+            return false;
+        }
+    }
+    avcodec_flush_buffers(codecCtx.get());
+    draining = false;
     return true;
 }
 
+int Decoder::seekToKeyframe(int frameIndex)
+{
+    const SeekIndex& index = getSeekIndex();
+    if (!index.isValid() || frameIndex < 0 || frameIndex >= index.frameCount())
+    {
+        return -1;
+    }
+
+    const int64_t target = index.framePts(frameIndex);
+    const int64_t keyframe = index.keyframeBefore(target);
+    if (!seekToKeyframePts(index, keyframe, target))
+    {
+        return -1;
+    }
+    av_frame_unref(frame.get());
+    pendingFrame = false;
+    lastPts = AV_NOPTS_VALUE; // Packets read from here bypass the decoder
+    return index.frameAt(keyframe);
+}
+
+bool Decoder::readPacket(AVPacket* packet)
+{
+    while (true)
+    {
+        av_packet_unref(packet);
+        const int ret = av_read_frame(formatCtx.get(), packet);
+        if (ret == AVERROR_EOF)
+        {
+            return false;
+        }
+        FF_CHECK(ret);
+        if (packet->stream_index == videoStreamIndex)
+        {
+            lastPts = AV_NOPTS_VALUE;
+            return true;
+        }
+    }
+}
+
+const AVStream* Decoder::getVideoStream() const
+{
+    return formatCtx->streams[videoStreamIndex];
+}
+
+void Decoder::setConverter(std::unique_ptr<celux::conversion::IConverter> converter)
+{
+    synchronize();
+    this->converter = std::move(converter);
+}
+
+void Decoder::synchronize()
+{
+    // Wait for any asynchronous conversion work queued by decodeNextFrame
+    if (converter)
+    {
+        converter->synchronize();
+    }
+}
+
+void Decoder::orderBefore(void* stream)
+{
+    if (converter)
+    {
+        converter->orderBefore(stream);
+    }
+}
+
+void Decoder::orderAfter(void* stream)
+{
+    if (converter)
+    {
+        converter->orderAfter(stream);
+    }
+}
+
+Stats& Decoder::getStats()
+{
+    return stats;
+}
+
 Decoder::VideoProperties Decoder::getVideoProperties() const
 {
     return properties;
@@ -278,6 +774,7 @@ void Decoder::close()
     {
         formatCtx.reset();
     }
+    ioContext.reset();
     if (hwDeviceCtx)
     {
         hwDeviceCtx.reset();
@@ -1,13 +1,41 @@
 #include "backends/cpu/Encoder.hpp"
+#include <cmath>
 
 
 using namespace celux::error;
 
+namespace
+{
+// Recovers NTSC rates (30000/1001, 24000/1001, ...) from their rounded decimals,
+// which a plain av_d2q would turn into e.g. 2997/100
+AVRational toFrameRate(double fps)
+{
+    const double ntsc = fps * 1.001;
+    if (std::fabs(fps - std::round(fps)) > 0.005 &&
+        std::fabs(ntsc - std::round(ntsc)) < 0.005)
+    {
+        return {static_cast<int>(std::round(ntsc)) * 1000, 1001};
+    }
+    return av_d2q(fps, 1000000);
+}
+
+void setOption(AVDictionary** options, const char* key, int64_t value)
+{
+    av_dict_set(options, key, std::to_string(value).c_str(), 0);
+}
+} // namespace
+
 namespace celux
 {
 Encoder::Encoder(std::unique_ptr<celux::conversion::IConverter> converter)
-    : converter(std::move(converter)), formatCtx(nullptr), codecCtx(nullptr),
-      packet(av_packet_alloc()), stream(nullptr), pts(0)
+    : Encoder(std::move(converter), Options())
+{
+}
+
+Encoder::Encoder(std::unique_ptr<celux::conversion::IConverter> converter,
+                 const Options& options)
+    : converter(std::move(converter)), options(options), formatCtx(nullptr),
+      codecCtx(nullptr), packet(av_packet_alloc()), stream(nullptr), pts(0)
 {
     if (!packet)
     {
@@ -21,15 +49,28 @@ Encoder::~Encoder()
 }
 
 Encoder::Encoder(Encoder&& other) noexcept
-    : formatCtx(std::move(other.formatCtx)), codecCtx(std::move(other.codecCtx)),
-      hwDeviceCtx(std::move(other.hwDeviceCtx)),
+    : ioContext(std::move(other.ioContext)), formatCtx(std::move(other.formatCtx)),
+      codecCtx(std::move(other.codecCtx)), hwDeviceCtx(std::move(other.hwDeviceCtx)),
       hwFramesCtx(std::move(other.hwFramesCtx)), stream(other.stream),
-      packet(other.packet), properties(other.properties),
+      packet(other.packet), properties(other.properties), options(other.options),
       hwAccelType(std::move(other.hwAccelType)), pts(other.pts),
+      inputFrames(std::move(other.inputFrames)), maxBatchFrames(other.maxBatchFrames),
+      raw(std::move(other.raw)), streamCopy(other.streamCopy),
+      finalized(other.finalized), audioInput(std::move(other.audioInput)),
+      audioStream(other.audioStream), audioInputIndex(other.audioInputIndex),
+      audioPacket(other.audioPacket), audioPending(other.audioPending),
       converter(std::move(other.converter))
 {
+    stats.takeFrom(other.stats);
     other.stream = nullptr;
     other.packet = nullptr;
+    other.inputFrames.clear();
+    other.maxBatchFrames = 0;
+    other.streamCopy = false;
+    other.finalized = false;
+    other.audioStream = nullptr;
+    other.audioPacket = nullptr;
+    other.audioPending = false;
 }
 
 Encoder& Encoder::operator=(Encoder&& other) noexcept
@@ -39,18 +80,38 @@ Encoder& Encoder::operator=(Encoder&& other) noexcept
         close();
 
         formatCtx = std::move(other.formatCtx);
+        ioContext = std::move(other.ioContext);
         codecCtx = std::move(other.codecCtx);
         hwDeviceCtx = std::move(other.hwDeviceCtx);
         hwFramesCtx = std::move(other.hwFramesCtx);
         stream = other.stream;
         packet = other.packet;
         properties = other.properties;
+        options = other.options;
         hwAccelType = std::move(other.hwAccelType);
         pts = other.pts;
+        inputFrames = std::move(other.inputFrames);
+        maxBatchFrames = other.maxBatchFrames;
+        raw = std::move(other.raw);
+        streamCopy = other.streamCopy;
+        finalized = other.finalized;
         converter = std::move(other.converter);
+        audioInput = std::move(other.audioInput);
+        audioStream = other.audioStream;
+        audioInputIndex = other.audioInputIndex;
+        audioPacket = other.audioPacket;
+        audioPending = other.audioPending;
+        stats.takeFrom(other.stats);
 
         other.stream = nullptr;
         other.packet = nullptr;
+        other.inputFrames.clear();
+        other.maxBatchFrames = 0;
+        other.streamCopy = false;
+        other.finalized = false;
+        other.audioStream = nullptr;
+        other.audioPacket = nullptr;
+        other.audioPending = false;
     }
     return *this;
 }
@@ -62,6 +123,13 @@ void Encoder::initialize(const std::string& outputPath, const VideoProperties& p
     initHWAccel(); // Virtual function
     const AVCodec* codec = avcodec_find_encoder_by_name(props.codecName.c_str());
     if (!codec)
+    {
+        // A codec name rather than an encoder name, e.g. "h264" for libx264
+        const AVCodecDescriptor* desc =
+            avcodec_descriptor_get_by_name(props.codecName.c_str());
+        codec = desc ? avcodec_find_encoder(desc->id) : nullptr;
+    }
+    if (!codec)
     {
         throw CxException("Encoder not found: " + props.codecName);
     }
@@ -83,6 +151,11 @@ void Encoder::initialize(const std::string& outputPath, const VideoProperties& p
 
     stream->time_base = codecCtx->time_base;
 
+    if (!options.audioSource.empty())
+    {
+        openAudioSource();
+    }
+
     // Write the stream header
     ret = avformat_write_header(formatCtx.get(), nullptr);
     if (ret < 0)
@@ -95,6 +168,26 @@ void Encoder::openFile(const std::string& outputPath, const VideoProperties& pro
 {
     // Allocate output context
     AVFormatContext* fmt_ctx = nullptr;
+    if (options.io)
+    {
+        // No file to open; the path only names the container
+        const AVOutputFormat* format =
+            av_guess_format(outputPath.c_str(), outputPath.c_str(), nullptr);
+        if (!format)
+        {
+            throw CxException("Unknown output container: " + outputPath);
+        }
+        avformat_alloc_output_context2(&fmt_ctx, format, nullptr, nullptr);
+        if (!fmt_ctx)
+        {
+            throw CxException("Could not allocate output format context");
+        }
+        formatCtx.reset(fmt_ctx);
+        ioContext = std::make_unique<IOContext>(*options.io, true);
+        formatCtx->pb = ioContext->get();
+        formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        return;
+    }
     int ret =
         avformat_alloc_output_context2(&fmt_ctx, nullptr, nullptr, outputPath.c_str());
     if (!fmt_ctx)
@@ -129,22 +222,116 @@ void Encoder::initCodecContext(const AVCodec* codec, const VideoProperties& prop
     }
     codecCtx.reset(codec_ctx);
 
-    // Set codec parameters
+    // Set codec parameters. One tick per frame, so pts counts frames.
+    const AVRational frameRate =
+        props.frameRate.num > 0 ? props.frameRate : toFrameRate(props.fps);
+    if (frameRate.num <= 0 || frameRate.den <= 0)
+    {
+        throw std::invalid_argument("Frame rate must be positive");
+    }
     codecCtx->width = props.width;
     codecCtx->height = props.height;
-    codecCtx->time_base = {1, static_cast<int>(props.fps)};
-    codecCtx->framerate = {static_cast<int>(props.fps), 1};
-    codecCtx->gop_size = 12;
-    codecCtx->max_b_frames = 0;
-    codecCtx->pix_fmt = props.pixelFormat;
+    codecCtx->time_base = av_inv_q(frameRate);
+    codecCtx->framerate = frameRate;
+    if (options.gopSize >= 0)
+    {
+        codecCtx->gop_size = options.gopSize;
+    }
+    if (options.maxBFrames >= 0)
+    {
+        codecCtx->max_b_frames = options.maxBFrames;
+    }
+    if (options.bitrate > 0)
+    {
+        codecCtx->bit_rate = options.bitrate;
+    }
+    // Software encoders differ in what they take, e.g. libx265 has no NV12
+    codecCtx->pix_fmt = codec->pix_fmts
+                            ? avcodec_find_best_pix_fmt_of_list(
+                                  codec->pix_fmts, props.pixelFormat, 0, nullptr)
+                            : props.pixelFormat;
 
     // Multi-threaded encoding
     codecCtx->thread_count = static_cast<int>(
         std::min(static_cast<unsigned int>(std::thread::hardware_concurrency()), 16u));
     codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
-    // Open the codec
-    FF_CHECK(avcodec_open2(codecCtx.get(), codec, nullptr));
+    AVDictionary* codecOptions = nullptr;
+    try
+    {
+        if (!options.preset.empty())
+        {
+            av_dict_set(&codecOptions, "preset", options.preset.c_str(), 0);
+        }
+        if (!options.tune.empty())
+        {
+            av_dict_set(&codecOptions, "tune", options.tune.c_str(), 0);
+        }
+        configureCodec(&codecOptions);
+        for (const auto& [key, value] : options.codecOptions)
+        {
+            av_dict_set(&codecOptions, key.c_str(), value.c_str(), 0);
+        }
+    }
+    catch (...)
+    {
+        av_dict_free(&codecOptions);
+        throw;
+    }
+
+    // Open the codec. Options it does not know are left in the dictionary.
+    const int ret = avcodec_open2(codecCtx.get(), codec, &codecOptions);
+    const AVDictionaryEntry* unused = av_dict_get(codecOptions, "", nullptr,
+                                                  AV_DICT_IGNORE_SUFFIX);
+    const std::string unusedKey = unused ? unused->key : "";
+    av_dict_free(&codecOptions);
+    FF_CHECK(ret);
+    if (!unusedKey.empty())
+    {
+        throw std::invalid_argument("Option '" + unusedKey + "' is not supported by " +
+                                    codec->name);
+    }
+}
+
+void Encoder::configureCodec(AVDictionary** codecOptions)
+{
+    const std::string& mode = options.rateControl;
+    if (mode.empty() || mode == "vbr")
+    {
+        // Bitrate driven unless a quality is given, which x264/x265 read as CRF
+        if (options.quality >= 0)
+        {
+            setOption(codecOptions, "crf", options.quality);
+        }
+    }
+    else if (mode == "crf")
+    {
+        setOption(codecOptions, "crf", options.quality >= 0 ? options.quality : 23);
+    }
+    else if (mode == "constqp")
+    {
+        setOption(codecOptions, "qp", options.quality >= 0 ? options.quality : 23);
+    }
+    else if (mode == "cbr")
+    {
+        if (options.bitrate <= 0)
+        {
+            throw std::invalid_argument("rate_control='cbr' requires a bitrate");
+        }
+        codecCtx->rc_min_rate = options.bitrate;
+        codecCtx->rc_max_rate = options.bitrate;
+        codecCtx->rc_buffer_size = static_cast<int>(options.bitrate);
+    }
+    else
+    {
+        throw std::invalid_argument("Unsupported rate control: " + mode +
+                                    " (expected 'constqp', 'vbr', 'cbr' or 'crf')");
+    }
+}
+
+void Encoder::prepareFrame(celux::Frame& input)
+{
+    // Default implementation does nothing
 }
 
 enum AVPixelFormat Encoder::getHWFormat(AVCodecContext* ctx,
@@ -155,6 +342,11 @@ enum AVPixelFormat Encoder::getHWFormat(AVCodecContext* ctx,
 }
 
 bool Encoder::encodeFrame(void* buffer)
+{
+    return encodeFrames(buffer, 1, 0);
+}
+
+bool Encoder::encodeFrames(void* buffer, int count, size_t frameBytes)
 {
     try
     {
@@ -164,80 +356,307 @@ bool Encoder::encodeFrame(void* buffer)
             throw CxException("Encoder is not open");
         }
 
-        try
+        uint8_t* input = static_cast<uint8_t*>(buffer);
+        const int chunk = maxBatchFrames > 0 ? std::min(count, maxBatchFrames) : count;
+        while (static_cast<int>(inputFrames.size()) < chunk)
         {
-            converter->convert(frame, buffer);
+            inputFrames.emplace_back();
         }
-        catch (const std::exception& e)
+
+        for (int first = 0; first < count; first += chunk)
         {
-            throw CxException("Error converting frame");
+            const int n = std::min(chunk, count - first);
+            try
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    prepareFrame(inputFrames[i]);
+                    Stats::Scope timed(stats, Stats::Stage::Convert);
+                    converter->beginTiming(stats);
+                    converter->convert(inputFrames[i],
+                                       input + (first + i) * frameBytes);
+                    converter->endTiming();
+                }
+                // The encoder reads the surfaces outside the converter's stream,
+                // and the caller may free `buffer` once this returns
+                converter->synchronize();
+            }
+            catch (const std::exception& e)
+            {
+                throw CxException("Error converting frame");
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                sendFrame(inputFrames[i].get());
+            }
         }
 
-        // Set PTS
-        frame.get()->pts = pts++;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+		CELUX_ERROR("Error in Write Frame: " << e.what());
+		return false;
+	}
+}
+
+void Encoder::encodeRawFrame(const celux::Frame& input)
+{
+    if (!isOpen())
+    {
+        throw CxException("Encoder is not open");
+    }
+    const AVFrame* av = input.get();
+    if (av->format != codecCtx->pix_fmt || av->width != codecCtx->width ||
+        av->height != codecCtx->height)
+    {
+        const char* format =
+            av_get_pix_fmt_name(static_cast<AVPixelFormat>(av->format));
+        throw CxException(std::string("Frame does not match the encoder input: ") +
+                          (format ? format : "unknown") + " " +
+                          std::to_string(av->width) + "x" + std::to_string(av->height));
+    }
 
-        // Send the frame to the encoder
-        int ret = avcodec_send_frame(codecCtx.get(), frame.get());
+    // Send a reference, so the caller's frame keeps its own timestamps
+    av_frame_unref(raw.get());
+    FF_CHECK(av_frame_ref(raw.get(), av));
+    // A decoder's picture types would otherwise force its keyframes
+    raw.get()->pict_type = AV_PICTURE_TYPE_NONE;
+    sendFrame(raw.get());
+    av_frame_unref(raw.get());
+}
 
-        if (ret < 0)
-        {
-            throw CxException("error sending frame to encoder" + celux::errorToString(ret));
-        }
+void Encoder::openCopy(const std::string& outputPath, const AVStream* source)
+{
+    openFile(outputPath, properties);
 
-        // Receive and write packets
-        while (ret >= 0)
+    stream = avformat_new_stream(formatCtx.get(), nullptr);
+    if (!stream)
+    {
+        throw CxException("Failed allocating output stream");
+    }
+    FF_CHECK(avcodec_parameters_copy(stream->codecpar, source->codecpar));
+    // The source container's tag may mean nothing in the output container
+    stream->codecpar->codec_tag = 0;
+    stream->time_base = source->time_base;
+    stream->avg_frame_rate = source->avg_frame_rate;
+    // A clip starting on a keyframe may still have B-frames decoded before it
+    formatCtx->avoid_negative_ts = AVFMT_AVOID_NEG_TS_MAKE_ZERO;
+
+    const int ret = avformat_write_header(formatCtx.get(), nullptr);
+    if (ret < 0)
+    {
+        throw CxException("Error occurred when writing header to output file: " +
+                          celux::errorToString(ret));
+    }
+    streamCopy = true;
+}
+
+void Encoder::writePacket(AVPacket* packet, AVRational timeBase)
+{
+    if (!isOpen())
+    {
+        throw CxException("Encoder is not open");
+    }
+    av_packet_rescale_ts(packet, timeBase, stream->time_base);
+    packet->stream_index = stream->index;
+    packet->pos = -1;
+
+    // The muxer takes over the packet's reference
+    int ret;
+    {
+        Stats::Scope timed(stats, Stats::Stage::Mux);
+        ret = av_interleaved_write_frame(formatCtx.get(), packet);
+    }
+    if (ret < 0)
+    {
+        av_packet_unref(packet);
+        throw CxException("Error writing packet to output file");
+    }
+}
+
+void Encoder::openAudioSource()
+{
+    AVFormatContext* input = nullptr;
+    FF_CHECK_MSG(avformat_open_input(&input, options.audioSource.c_str(), nullptr,
+                                     nullptr),
+                 std::string("Failure Opening Audio Source: " + options.audioSource));
+    audioInput.reset(input);
+    FF_CHECK(avformat_find_stream_info(input, nullptr));
+
+    audioInputIndex =
+        av_find_best_stream(input, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (audioInputIndex < 0)
+    {
+        throw CxException("No audio stream in " + options.audioSource);
+    }
+    const AVStream* source = input->streams[audioInputIndex];
+
+    audioStream = avformat_new_stream(formatCtx.get(), nullptr);
+    if (!audioStream)
+    {
+        throw CxException("Failed allocating audio stream");
+    }
+    FF_CHECK(avcodec_parameters_copy(audioStream->codecpar, source->codecpar));
+    audioStream->codecpar->codec_tag = 0;
+    audioStream->time_base = source->time_base;
+
+    audioPacket = av_packet_alloc();
+    if (!audioPacket)
+    {
+        throw CxException("Could not allocate AVPacket");
+    }
+}
+
+void Encoder::copyAudioUntil(int64_t timestamp, AVRational timeBase)
+{
+    if (!audioInput)
+    {
+        return;
+    }
+    const AVStream* source = audioInput->streams[audioInputIndex];
+    // The video starts at zero, so the audio is moved to start there too
+    const int64_t start = source->start_time != AV_NOPTS_VALUE ? source->start_time : 0;
+
+    while (true)
+    {
+        if (!audioPending)
         {
-            ret = avcodec_receive_packet(codecCtx.get(), packet);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            int ret;
             {
-                break;
+                Stats::Scope timed(stats, Stats::Stage::Demux);
+                ret = av_read_frame(audioInput.get(), audioPacket);
             }
-            else if (ret < 0)
+            if (ret == AVERROR_EOF)
             {
-                throw CxException("Error during encoding");
+                audioInput.reset(); // Nothing left to copy
+                return;
             }
-
-            // Rescale PTS and DTS to stream time base
-            av_packet_rescale_ts(packet, codecCtx->time_base, stream->time_base);
-            packet->stream_index = stream->index;
-
-            // Write the packet
-            ret = av_interleaved_write_frame(formatCtx.get(), packet);
-            if (ret < 0)
+            FF_CHECK(ret);
+            if (audioPacket->stream_index != audioInputIndex ||
+                audioPacket->pts == AV_NOPTS_VALUE)
             {
-                av_packet_unref(packet);
-                throw CxException("Error writing packet to output file");
+                av_packet_unref(audioPacket);
+                continue;
             }
+            audioPacket->pts -= start;
+            if (audioPacket->dts != AV_NOPTS_VALUE)
+            {
+                audioPacket->dts -= start;
+            }
+            audioPending = true;
+        }
+        if (av_compare_ts(audioPacket->pts, source->time_base, timestamp,
+                          timeBase) >= 0)
+        {
+            return; // Held until the video gets there
+        }
+
+        av_packet_rescale_ts(audioPacket, source->time_base, audioStream->time_base);
+        audioPacket->stream_index = audioStream->index;
+        audioPacket->pos = -1;
+        audioPending = false;
+        Stats::Scope timed(stats, Stats::Stage::Mux);
+        const int ret = av_interleaved_write_frame(formatCtx.get(), audioPacket);
+        if (ret < 0)
+        {
+            av_packet_unref(audioPacket);
+            throw CxException("Error writing audio packet to output file");
+        }
+    }
+}
+
+void Encoder::sendFrame(AVFrame* input)
+{
+    // Copy the audio that plays before this frame
+    copyAudioUntil(pts, codecCtx->time_base);
+
+    // Set PTS
+    input->pts = pts++;
+
+    // Send the frame to the encoder
+    int ret;
+    {
+        Stats::Scope timed(stats, Stats::Stage::Encode);
+        ret = avcodec_send_frame(codecCtx.get(), input);
+    }
+    if (ret < 0)
+    {
+        throw CxException("error sending frame to encoder" + celux::errorToString(ret));
+    }
+    stats.addFrames(1);
+
+    // Receive and write packets
+    while (ret >= 0)
+    {
+        {
+            Stats::Scope timed(stats, Stats::Stage::Encode);
+            ret = avcodec_receive_packet(codecCtx.get(), packet);
+        }
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+        {
+            break;
+        }
+        else if (ret < 0)
+        {
+            throw CxException("Error during encoding");
+        }
+
+        // Rescale PTS and DTS to stream time base
+        av_packet_rescale_ts(packet, codecCtx->time_base, stream->time_base);
+        packet->stream_index = stream->index;
 
+        // Write the packet
+        {
+            Stats::Scope timed(stats, Stats::Stage::Mux);
+            ret = av_interleaved_write_frame(formatCtx.get(), packet);
+        }
+        if (ret < 0)
+        {
             av_packet_unref(packet);
+            throw CxException("Error writing packet to output file");
         }
 
-        return true;
+        av_packet_unref(packet);
     }
-    catch (const std::exception& e)
+}
+
+Stats& Encoder::getStats()
+{
+    return stats;
+}
+
+void Encoder::orderAfter(void* stream)
+{
+    if (converter)
     {
-		std::cerr << "Error in Write Frame: " << e.what() << std::endl;
-		return false;
-	}
+        converter->orderAfter(stream);
+    }
 }
 
 bool Encoder::finalize()
 {
-    if (!isOpen())
+    // The trailer may be written only once, e.g. not again by close()
+    if (!isOpen() || finalized)
     {
         return false;
     }
+    finalized = true;
 
-    // Flush the encoder
-    int ret = avcodec_send_frame(codecCtx.get(), nullptr);
-    if (ret < 0)
+    // Flush the encoder; copied streams have none
+    int ret = codecCtx ? avcodec_send_frame(codecCtx.get(), nullptr) : AVERROR_EOF;
+    if (ret < 0 && ret != AVERROR_EOF)
     {
         throw CxException("Error sending flush frame to encoder");
     }
 
     while (ret >= 0)
     {
-        ret = avcodec_receive_packet(codecCtx.get(), packet);
+        {
+            Stats::Scope timed(stats, Stats::Stage::Encode);
+            ret = avcodec_receive_packet(codecCtx.get(), packet);
+        }
         if (ret == AVERROR_EOF)
         {
             break;
@@ -256,7 +675,10 @@ bool Encoder::finalize()
         packet->stream_index = stream->index;
 
         // Write the packet
-        ret = av_interleaved_write_frame(formatCtx.get(), packet);
+        {
+            Stats::Scope timed(stats, Stats::Stage::Mux);
+            ret = av_interleaved_write_frame(formatCtx.get(), packet);
+        }
         if (ret < 0)
         {
             av_packet_unref(packet);
@@ -266,6 +688,12 @@ bool Encoder::finalize()
         av_packet_unref(packet);
     }
 
+    // The rest of the audio up to the end of the last frame
+    if (codecCtx)
+    {
+        copyAudioUntil(pts, codecCtx->time_base);
+    }
+
     // Write the trailer
     ret = av_write_trailer(formatCtx.get());
     if (ret < 0)
@@ -278,7 +706,7 @@ bool Encoder::finalize()
 
 bool Encoder::isOpen() const
 {
-    return formatCtx && codecCtx;
+    return formatCtx && (codecCtx || streamCopy);
 }
 
 void Encoder::close()
@@ -289,13 +717,23 @@ void Encoder::close()
         av_packet_free(&packet);
         packet = nullptr;
     }
+    if (audioPacket)
+    {
+        av_packet_free(&audioPacket);
+    }
+    audioInput.reset();
+    audioStream = nullptr;
+    audioPending = false;
 
     // Reset smart pointers to free resources
     codecCtx.reset();
     formatCtx.reset();
+    ioContext.reset();
     hwDeviceCtx.reset();
     hwFramesCtx.reset();
     stream = nullptr;
+    streamCopy = false;
+    finalized = false;
 }
 
 std::vector<std::string> Encoder::listSupportedEncoders() const
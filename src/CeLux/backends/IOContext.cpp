@@ -0,0 +1,70 @@
+#include "backends/IOContext.hpp"
+
+namespace celux
+{
+
+IOContext::IOContext(IOCallbacks callbacks, bool writable)
+    : callbacks(std::move(callbacks))
+{
+    const IOCallbacks& io = this->callbacks;
+    if (writable ? !io.write : !io.read)
+    {
+        throw std::invalid_argument(writable ? "Custom output needs a write callback"
+                                             : "Custom input needs a read callback");
+    }
+    if (io.bufferSize <= 0)
+    {
+        throw std::invalid_argument("IO buffer size must be positive");
+    }
+
+    // FFmpeg owns the buffer from here on and may replace it
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(io.bufferSize));
+    if (!buffer)
+    {
+        throw std::bad_alloc();
+    }
+    context = avio_alloc_context(buffer, io.bufferSize, writable ? 1 : 0, this,
+                                 writable ? nullptr : &IOContext::readPacket,
+                                 writable ? &IOContext::writePacket : nullptr,
+                                 io.seek ? &IOContext::seekTo : nullptr);
+    if (!context)
+    {
+        av_free(buffer);
+        throw std::bad_alloc();
+    }
+    context->seekable = io.seek ? AVIO_SEEKABLE_NORMAL : 0;
+}
+
+IOContext::~IOContext()
+{
+    if (context)
+    {
+        av_freep(&context->buffer);
+        avio_context_free(&context);
+    }
+}
+
+AVIOContext* IOContext::get() const
+{
+    return context;
+}
+
+int IOContext::readPacket(void* opaque, uint8_t* buffer, int size)
+{
+    const int count = static_cast<IOContext*>(opaque)->callbacks.read(buffer, size);
+    return count == 0 ? AVERROR_EOF : count;
+}
+
+int IOContext::writePacket(void* opaque, const uint8_t* buffer, int size)
+{
+    return static_cast<IOContext*>(opaque)->callbacks.write(buffer, size);
+}
+
+int64_t IOContext::seekTo(void* opaque, int64_t offset, int whence)
+{
+    // AVSEEK_FORCE only hints that seeking may be expensive
+    return static_cast<IOContext*>(opaque)->callbacks.seek(offset,
+                                                           whence & ~AVSEEK_FORCE);
+}
+
+} // namespace celux
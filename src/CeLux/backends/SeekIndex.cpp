@@ -0,0 +1,327 @@
+// SeekIndex.cpp
+#include "SeekIndex.hpp"
+#include "FFException.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+using namespace celux::error;
+
+namespace celux
+{
+
+namespace
+{
+// Bump whenever the on-disk layout or the meaning of its entries changes
+constexpr char indexMagic[8] = {'C', 'X', 'I', 'D', 'X', 0, 0, 3};
+
+// Suffix no other writer uses: dataloader workers are separate processes whose
+// thread ids may collide, so the process id and a random number are included
+std::string uniqueSuffix()
+{
+    static thread_local std::mt19937_64 random(
+        std::random_device{}() ^
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), ".tmp%ld.%016llx", static_cast<long>(getpid()),
+             static_cast<unsigned long long>(random()));
+    return suffix;
+}
+
+void writeVector(std::ostream& out, const std::vector<int64_t>& values)
+{
+    const uint64_t count = values.size();
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(count * sizeof(int64_t)));
+}
+
+bool readVector(std::istream& in, std::vector<int64_t>& values, uint64_t limit)
+{
+    uint64_t count = 0;
+    if (!in.read(reinterpret_cast<char*>(&count), sizeof(count)) || count > limit)
+    {
+        return false;
+    }
+    values.resize(count);
+    const auto bytes = static_cast<std::streamsize>(count * sizeof(int64_t));
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), bytes));
+}
+} // namespace
+
+SeekIndex SeekIndex::build(AVFormatContext* formatCtx, int streamIndex)
+{
+    SeekIndex index;
+    index.valid = true;
+
+    // Only the video stream's packets are needed, let the demuxer drop the rest
+    std::vector<AVDiscard> discard(formatCtx->nb_streams);
+    for (unsigned int i = 0; i < formatCtx->nb_streams; ++i)
+    {
+        discard[i] = formatCtx->streams[i]->discard;
+        if (static_cast<int>(i) != streamIndex)
+        {
+            formatCtx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVPacket* pkt = av_packet_alloc();
+    if (!pkt)
+    {
+        throw CxException("Could not allocate packet");
+    }
+
+    int ret;
+    while ((ret = av_read_frame(formatCtx, pkt)) >= 0)
+    {
+        if (pkt->stream_index == streamIndex && !(pkt->flags & AV_PKT_FLAG_DISCARD))
+        {
+            ++index.packetCount;
+            // A DTS is in decode order, which differs from display order once
+            // B-frames reorder, so it can't stand in for a missing PTS
+            const int64_t ts = pkt->pts;
+            if (ts == AV_NOPTS_VALUE)
+            {
+                index.valid = false;
+            }
+            else
+            {
+                index.pts.push_back(ts);
+                if (pkt->flags & AV_PKT_FLAG_KEY)
+                {
+                    index.keyframePts.push_back(ts);
+                    index.keyframePos.push_back(pkt->pos);
+                }
+            }
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+
+    for (unsigned int i = 0; i < formatCtx->nb_streams; ++i)
+    {
+        formatCtx->streams[i]->discard = discard[i];
+    }
+
+    if (ret != AVERROR_EOF)
+    {
+        throw CxException("Error scanning packets: " + celux::errorToString(ret));
+    }
+
+    // Packets arrive in decode order; frames are numbered in presentation order
+    std::sort(index.pts.begin(), index.pts.end());
+    if (!std::is_sorted(index.keyframePts.begin(), index.keyframePts.end()))
+    {
+        // Keep each keyframe's byte offset paired with its PTS
+        std::vector<size_t> order(index.keyframePts.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                  { return index.keyframePts[a] < index.keyframePts[b]; });
+        std::vector<int64_t> keyPts, keyPos;
+        for (size_t i : order)
+        {
+            keyPts.push_back(index.keyframePts[i]);
+            keyPos.push_back(index.keyframePos[i]);
+        }
+        index.keyframePts = std::move(keyPts);
+        index.keyframePos = std::move(keyPos);
+    }
+    if (index.pts.empty() || index.keyframePts.empty())
+    {
+        index.valid = false;
+    }
+    return index;
+}
+
+bool SeekIndex::isValid() const
+{
+    return valid;
+}
+
+int SeekIndex::frameCount() const
+{
+    return static_cast<int>(packetCount);
+}
+
+int64_t SeekIndex::framePts(int frameIndex) const
+{
+    if (frameIndex < 0 || frameIndex >= static_cast<int>(pts.size()))
+    {
+        throw CxException("Frame index out of range: " + std::to_string(frameIndex));
+    }
+    return pts[frameIndex];
+}
+
+int64_t SeekIndex::keyframeBefore(int64_t target) const
+{
+    auto it = std::upper_bound(keyframePts.begin(), keyframePts.end(), target);
+    // Leading frames before the first keyframe can only be reached from it
+    return it == keyframePts.begin() ? keyframePts.front() : *(it - 1);
+}
+
+int64_t SeekIndex::keyframePositionBefore(int64_t target) const
+{
+    auto it = std::upper_bound(keyframePts.begin(), keyframePts.end(), target);
+    const size_t i = it == keyframePts.begin() ? 0 : (it - keyframePts.begin()) - 1;
+    return keyframePos[i];
+}
+
+int SeekIndex::frameAt(int64_t target) const
+{
+    return static_cast<int>(std::lower_bound(pts.begin(), pts.end(), target) -
+                            pts.begin());
+}
+
+std::string SeekIndex::sourceKey(const std::string& filePath)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path path = fs::absolute(filePath, ec);
+    if (ec || !fs::is_regular_file(path, ec))
+    {
+        return "";
+    }
+    const auto size = fs::file_size(path, ec);
+    if (ec)
+    {
+        return "";
+    }
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec)
+    {
+        return "";
+    }
+    return path.generic_string() + "|" + std::to_string(size) + "|" +
+           std::to_string(mtime.time_since_epoch().count());
+}
+
+std::string SeekIndex::cachePath(const std::string& filePath, const std::string& cache)
+{
+    namespace fs = std::filesystem;
+    if (cache == "sidecar")
+    {
+        return filePath + ".cxidx";
+    }
+
+    // One directory serves many videos, so name entries after the full path
+    std::error_code ec;
+    const std::string absolute = fs::absolute(filePath, ec).generic_string();
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cxidx",
+             static_cast<unsigned long long>(std::hash<std::string>{}(absolute)));
+    return (fs::path(cache) / name).string();
+}
+
+bool SeekIndex::save(const std::string& indexPath, const std::string& key) const
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path target(indexPath);
+    if (target.has_parent_path())
+    {
+        fs::create_directories(target.parent_path(), ec);
+    }
+
+    // Unique per writer so concurrent workers don't clobber each other's file
+    const fs::path temp = target.string() + uniqueSuffix();
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return false;
+        }
+        const uint8_t isValid = valid ? 1 : 0;
+        const uint64_t keySize = key.size();
+        out.write(indexMagic, sizeof(indexMagic));
+        out.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+        out.write(key.data(), static_cast<std::streamsize>(keySize));
+        out.write(reinterpret_cast<const char*>(&isValid), sizeof(isValid));
+        out.write(reinterpret_cast<const char*>(&packetCount), sizeof(packetCount));
+        writeVector(out, pts);
+        writeVector(out, keyframePts);
+        writeVector(out, keyframePos);
+        if (!out.flush())
+        {
+            out.close();
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(temp, target, ec);
+    if (ec)
+    {
+        // Another worker may already have put the same index in place
+        fs::remove(temp, ec);
+        return fs::exists(target, ec);
+    }
+    return true;
+}
+
+bool SeekIndex::load(const std::string& indexPath, const std::string& key,
+                     SeekIndex& index)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const uint64_t fileSize = fs::file_size(indexPath, ec);
+    if (ec)
+    {
+        return false;
+    }
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+
+    char magic[sizeof(indexMagic)];
+    uint64_t keySize = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), indexMagic) ||
+        !in.read(reinterpret_cast<char*>(&keySize), sizeof(keySize)) ||
+        keySize != key.size())
+    {
+        return false;
+    }
+    std::string storedKey(keySize, '\0');
+    uint8_t isValid = 0;
+    SeekIndex loaded;
+    if (!in.read(&storedKey[0], static_cast<std::streamsize>(keySize)) ||
+        storedKey != key ||
+        !in.read(reinterpret_cast<char*>(&isValid), sizeof(isValid)) ||
+        !in.read(reinterpret_cast<char*>(&loaded.packetCount), sizeof(uint64_t)))
+    {
+        return false;
+    }
+
+    // Bound element counts by the file size so a corrupt header can't
+    // trigger a huge allocation
+    const uint64_t limit = fileSize / sizeof(int64_t);
+    loaded.valid = isValid != 0;
+    if (!readVector(in, loaded.pts, limit) ||
+        !readVector(in, loaded.keyframePts, limit) ||
+        !readVector(in, loaded.keyframePos, limit) ||
+        loaded.keyframePts.size() != loaded.keyframePos.size())
+    {
+        return false;
+    }
+    if (loaded.valid && (loaded.pts.empty() || loaded.keyframePts.empty()))
+    {
+        return false;
+    }
+
+    index = std::move(loaded);
+    return true;
+}
+
+} // namespace celux
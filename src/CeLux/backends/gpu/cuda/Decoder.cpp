@@ -4,20 +4,96 @@ using namespace celux::error;
 
 namespace celux::backends::gpu::cuda
 {
+namespace
+{
+// The NVDEC wrapper decoder for a codec, e.g. h264_cuvid or mpeg2_cuvid
+const AVCodec* findCuvidDecoder(AVCodecID id)
+{
+    std::string name = avcodec_get_name(id);
+    const std::string suffix = "video"; // mpeg1video, mpeg2video
+    if (name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+        name.erase(name.size() - suffix.size());
+    }
+    const AVCodec* codec = avcodec_find_decoder_by_name((name + "_cuvid").c_str());
+    if (!codec)
+    {
+        throw CxException("Hardware crop/resize needs the " + name +
+                          "_cuvid decoder, which this FFmpeg build does not have");
+    }
+    return codec;
+}
+} // namespace
+
 void Decoder::initCodecContext(const AVCodec* codec)
 {
+    // The generic hwaccel path decodes at the coded size; the cuvid decoders
+    // can crop and scale on the chip instead
+    if (options.hwScales())
+    {
+        codec = findCuvidDecoder(codec->id);
+    }
+
     // Call base class implementation
     celux::Decoder::initCodecContext(codec);
+}
 
-    // Set hardware-specific get_format
+void Decoder::configureCodec(AVDictionary** codecOptions)
+{
+    // cuvid decoders negotiate their output format while opening, so the
+    // hardware format must be requested before avcodec_open2
     if (hwDeviceCtx)
     {
         codecCtx->get_format = Decoder::getHWFormat; // Assign the static function
     }
+    if (!options.hwScales())
+    {
+        return;
+    }
+
+    const int width = codecCtx->width;
+    const int height = codecCtx->height;
+    const int cropWidth = options.hwCropWidth > 0 ? options.hwCropWidth
+                                                  : width - options.hwCropX;
+    const int cropHeight = options.hwCropHeight > 0 ? options.hwCropHeight
+                                                    : height - options.hwCropY;
+    if (options.hwCropX < 0 || options.hwCropY < 0 || options.hwCropX % 2 != 0 ||
+        options.hwCropY % 2 != 0 || cropWidth <= 0 || cropHeight <= 0 ||
+        options.hwCropX + cropWidth > width || options.hwCropY + cropHeight > height)
+    {
+        throw CxException("Hardware crop does not fit the " + std::to_string(width) +
+                          "x" + std::to_string(height) +
+                          " frame or has an odd origin");
+    }
+
+    // cuvid takes the crop as margins: top x bottom x left x right
+    const std::string crop =
+        std::to_string(options.hwCropY) + "x" +
+        std::to_string(height - options.hwCropY - cropHeight) + "x" +
+        std::to_string(options.hwCropX) + "x" +
+        std::to_string(width - options.hwCropX - cropWidth);
+    av_dict_set(codecOptions, "crop", crop.c_str(), 0);
+
+    scaledWidth = options.hwResizeWidth > 0 ? options.hwResizeWidth : cropWidth;
+    scaledHeight = options.hwResizeHeight > 0 ? options.hwResizeHeight : cropHeight;
+    const std::string resize =
+        std::to_string(scaledWidth) + "x" + std::to_string(scaledHeight);
+    av_dict_set(codecOptions, "resize", resize.c_str(), 0);
 }
 
 void Decoder::initHWAccel()
 {
+    if (options.hwDeviceCtx)
+    {
+        hwDeviceCtx.reset(av_buffer_ref(options.hwDeviceCtx));
+        if (!hwDeviceCtx)
+        {
+            throw CxException("Failed to reference HW device context");
+        }
+        return;
+    }
+
     // Find the hardware device type
     enum AVHWDeviceType type = av_hwdevice_find_type_by_name("cuda");
     if (type == AV_HWDEVICE_TYPE_NONE)
@@ -25,12 +101,13 @@ void Decoder::initHWAccel()
         throw CxException("Failed to find HW device type: cuda");
     }
 
-    // Initialize hardware device context
+    // Initialize hardware device context on the requested GPU
     AVBufferRef* hw_ctx = nullptr;
-    FF_CHECK_MSG(av_hwdevice_ctx_create(&hw_ctx, type, nullptr, nullptr, 0),
+    const std::string device = std::to_string(options.hwDevice);
+    FF_CHECK_MSG(av_hwdevice_ctx_create(&hw_ctx, type, device.c_str(), nullptr, 0),
                  std::string("Failed to create HW device context:"));
     hwDeviceCtx.reset(hw_ctx);
-    std::cout << "Created HW device context: cuda" << std::endl;
+    CELUX_DEBUG("Created HW device context: cuda:" << device);
 }
 
 enum AVPixelFormat Decoder::getHWFormat(AVCodecContext* ctx,
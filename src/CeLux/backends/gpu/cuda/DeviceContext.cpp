@@ -0,0 +1,38 @@
+// DeviceContext.cpp
+#include "backends/gpu/cuda/DeviceContext.hpp"
+#include <map>
+#include <mutex>
+using namespace celux::error;
+
+namespace celux::backends::gpu::cuda
+{
+AVBufferRef* sharedDeviceContext(int device)
+{
+    static std::mutex mutex;
+    // Never freed on purpose: readers and writers destroyed during interpreter
+    // shutdown may still hold references after static destructors have run
+    static auto* contexts = new std::map<int, AVBufferRef*>();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    AVBufferRef*& context = (*contexts)[device];
+    if (!context)
+    {
+        // Bind to the device's primary context instead of creating a new one
+        AVDictionary* deviceOptions = nullptr;
+        av_dict_set(&deviceOptions, "primary_ctx", "1", 0);
+        const int ret =
+            av_hwdevice_ctx_create(&context, AV_HWDEVICE_TYPE_CUDA,
+                                   std::to_string(device).c_str(), deviceOptions, 0);
+        av_dict_free(&deviceOptions);
+        if (ret < 0)
+        {
+            context = nullptr;
+            throw CxException("Failed to create CUDA device context for device " +
+                              std::to_string(device) + ": " +
+                              celux::errorToString(ret));
+        }
+    }
+
+    return context;
+}
+} // namespace celux::backends::gpu::cuda
@@ -4,7 +4,7 @@ namespace celux::backends::gpu::cuda
 {
 void Encoder::initHWAccel()
 {
-    std::cout << "Initializing HW Acceleration\n" << std::endl;
+    CELUX_DEBUG("Initializing CUDA hardware acceleration");
     // Find the hardware device type
     enum AVHWDeviceType type = av_hwdevice_find_type_by_name("cuda");
     if (type == AV_HWDEVICE_TYPE_NONE)
@@ -12,9 +12,23 @@ void Encoder::initHWAccel()
         throw CxException("Failed to find HW device type: CUDA");
     }
 
-    // Initialize hardware device context
+    // Initialize hardware device context, reusing the shared one if given
     AVBufferRef* hw_ctx = nullptr;
-    FF_CHECK(av_hwdevice_ctx_create(&hw_ctx, type, nullptr, nullptr, 0));
+    if (options.hwDeviceCtx)
+    {
+        hw_ctx = av_buffer_ref(options.hwDeviceCtx);
+        if (!hw_ctx)
+        {
+            throw CxException("Failed to reference HW device context");
+        }
+    }
+    else
+    {
+        // On the GPU the frames are on, not always the first one
+        const std::string device = std::to_string(options.hwDevice);
+        FF_CHECK_MSG(av_hwdevice_ctx_create(&hw_ctx, type, device.c_str(), nullptr, 0),
+                     std::string("Failed to create HW device context:"));
+    }
 
     hwDeviceCtx.reset(hw_ctx);
 
@@ -26,11 +40,11 @@ void Encoder::initHWAccel()
     }
 
     AVHWFramesContext* frames = reinterpret_cast<AVHWFramesContext*>(frames_ctx->data);
-    frames->format = codecCtx->pix_fmt;  // Hardware pixel format
+    frames->format = AV_PIX_FMT_CUDA;    // Hardware pixel format
     frames->sw_format = AV_PIX_FMT_NV12; // Software pixel format (input format)
     frames->width = properties.width;
     frames->height = properties.height;
-    frames->initial_pool_size = 20;
+    frames->initial_pool_size = InputPoolSize;
 
     int ret = av_hwframe_ctx_init(frames_ctx);
     if (ret < 0)
@@ -41,11 +55,8 @@ void Encoder::initHWAccel()
     hwFramesCtx.reset(frames_ctx);
 }
 
-void Encoder::initCodecContext(const AVCodec* codec, const VideoProperties& props)
+void Encoder::configureCodec(AVDictionary** codecOptions)
 {
-    // Call base class implementation
-    celux::Encoder::initCodecContext(codec, props);
-
     // If hardware acceleration is enabled, set hw_device_ctx and get_format callback
     if (hwDeviceCtx)
     {
@@ -60,18 +71,50 @@ void Encoder::initCodecContext(const AVCodec* codec, const VideoProperties& prop
 
     codecCtx->hw_frames_ctx = av_buffer_ref(hwFramesCtx.get());
 
-    // Set encoder options (these can be adjusted as needed)
-    av_opt_set(codecCtx->priv_data, "preset", "p5", 0);  // Example: NVENC preset
-    av_opt_set(codecCtx->priv_data, "rc", "constqp", 0); // Rate control mode
-    av_opt_set(codecCtx->priv_data, "qp", "23", 0);      // Quantization parameter
+    if (options.preset.empty())
+    {
+        av_dict_set(codecOptions, "preset", "p5", 0);
+    }
 
-    // Convert the raw buffer to AVFrame using the converter
-    frame.get()->hw_frames_ctx = av_buffer_ref(hwFramesCtx.get());
-    frame.get()->format = AV_PIX_FMT_CUDA;
-    FF_CHECK(av_hwframe_get_buffer(hwFramesCtx.get(), frame.get(), 0));
+    // NVENC has no CRF; its constant quality mode is VBR with a CQ target
+    const std::string& mode = options.rateControl;
+    const std::string quality = std::to_string(options.quality);
+    if (mode.empty() || mode == "constqp")
+    {
+        av_dict_set(codecOptions, "rc", "constqp", 0);
+        av_dict_set(codecOptions, "qp", options.quality >= 0 ? quality.c_str() : "23",
+                    0);
+    }
+    else if (mode == "vbr" || mode == "crf")
+    {
+        av_dict_set(codecOptions, "rc", "vbr", 0);
+        if (options.quality >= 0)
+        {
+            av_dict_set(codecOptions, "cq", quality.c_str(), 0);
+        }
+    }
+    else if (mode == "cbr")
+    {
+        if (options.bitrate <= 0)
+        {
+            throw std::invalid_argument("rate_control='cbr' requires a bitrate");
+        }
+        av_dict_set(codecOptions, "rc", "cbr", 0);
+    }
+    else
+    {
+        throw std::invalid_argument("Unsupported rate control: " + mode +
+                                    " (expected 'constqp', 'vbr', 'cbr' or 'crf')");
+    }
+}
 
-    // Open the codec
-    FF_CHECK(avcodec_open2(codecCtx.get(), codec, nullptr));
+void Encoder::prepareFrame(celux::Frame& input)
+{
+    // avcodec_send_frame leaves NVENC a reference to the previous surface, which
+    // it may still be reading. Convert into a free one from the pool instead; the
+    // previous surface returns to the pool once NVENC releases it.
+    av_frame_unref(input.get());
+    FF_CHECK(av_hwframe_get_buffer(hwFramesCtx.get(), input.get(), 0));
 }
 
 enum AVPixelFormat Encoder::getHWFormat(AVCodecContext* ctx,
@@ -0,0 +1,611 @@
+// YUVToRGBKernels.cpp
+#include "YUVToRGBKernels.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CELUX_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC accepts any intrinsic without per-function target flags
+#define CELUX_TARGET(features)
+#else
+#define CELUX_TARGET(features) __attribute__((target(features)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CELUX_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace celux
+{
+namespace conversion
+{
+namespace cpu
+{
+namespace
+{
+
+// One output row and the source rows it is computed from
+struct Row
+{
+    const uint8_t* y;
+    const uint8_t* u; // UV plane for NV12
+    const uint8_t* v;
+    bool nv12;
+    int width;
+    // HWC: out[0] is the row. CHW: one pointer per output channel slot.
+    void* out[3];
+    bool isFloat;
+    bool planar;
+    bool bgr;
+};
+
+// Per-pixel reference, also used for the columns left over by the SIMD loops.
+// Same formula as the CUDA kernels in yuv_to_rgb.cuh.
+void rowScalar(const Row& r, const YuvToRgbMatrix& m, int x)
+{
+    for (; x < r.width; ++x)
+    {
+        const int cx = x / 2;
+        const int uSample = r.nv12 ? r.u[2 * cx] : r.u[cx];
+        const int vSample = r.nv12 ? r.u[2 * cx + 1] : r.v[cx];
+        const float u = uSample * m.cScale + m.cBias;
+        const float v = vSample * m.cScale + m.cBias;
+        const float luma = r.y[x] * m.yScale + m.yBias;
+
+        float rgb[3] = {luma + m.rV * v, luma + (m.gU * u + m.gV * v), luma + m.bU * u};
+        if (r.bgr)
+        {
+            std::swap(rgb[0], rgb[2]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            const float value = std::min(std::max(rgb[c], 0.0f), 1.0f);
+            const size_t index = r.planar ? static_cast<size_t>(x) : 3 * x + c;
+            void* base = r.planar ? r.out[c] : r.out[0];
+            if (r.isFloat)
+            {
+                static_cast<float*>(base)[index] = value;
+            }
+            else
+            {
+                static_cast<uint8_t*>(base)[index] =
+                    static_cast<uint8_t>(value * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+// Gather indices and blend masks that interleave three N-lane channel vectors
+// into three N-lane HWC vectors: lane k of output j holds pixel (N*j + k) / 3,
+// channel (N*j + k) % 3.
+template <int N> struct InterleaveTable
+{
+    int index[3][N];
+    unsigned mask1[3]; // lanes taken from channel 1
+    unsigned mask2[3]; // lanes taken from channel 2
+};
+
+template <int N> constexpr InterleaveTable<N> makeInterleaveTable()
+{
+    InterleaveTable<N> table{};
+    for (int j = 0; j < 3; ++j)
+    {
+        table.mask1[j] = 0;
+        table.mask2[j] = 0;
+        for (int k = 0; k < N; ++k)
+        {
+            const int position = N * j + k;
+            table.index[j][k] = position / 3;
+            if (position % 3 == 1)
+            {
+                table.mask1[j] |= 1u << k;
+            }
+            else if (position % 3 == 2)
+            {
+                table.mask2[j] |= 1u << k;
+            }
+        }
+    }
+    return table;
+}
+
+#ifdef CELUX_X86
+
+constexpr InterleaveTable<8> kInterleave8 = makeInterleaveTable<8>();
+constexpr InterleaveTable<16> kInterleave16 = makeInterleaveTable<16>();
+
+inline int loadU32(const uint8_t* p)
+{
+    int value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// ---- AVX2: 8 pixels per iteration ----
+
+CELUX_TARGET("avx2")
+inline __m256i packBytes8(__m256i a, __m256i b, __m256i c)
+{
+    // int32 lanes -> bytes a[0..7], b[0..7], c[0..7] in the low 24 bytes
+    const __m256i words = _mm256_packus_epi32(a, b);
+    const __m256i words2 = _mm256_packus_epi32(c, c);
+    const __m256i bytes = _mm256_packus_epi16(words, words2);
+    return _mm256_permutevar8x32_epi32(bytes,
+                                       _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+CELUX_TARGET("avx2")
+inline __m256i toBytes(__m256 value)
+{
+    return _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)),
+                      _mm256_set1_ps(0.5f)));
+}
+
+// Output vector J of the HWC interleave of three channel vectors. J is a
+// template parameter because blend masks must be compile-time constants.
+template <int J> CELUX_TARGET("avx2") inline __m256 interleave8(const __m256* channel)
+{
+    const __m256i gather =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kInterleave8.index[J]));
+    const __m256 c0 = _mm256_permutevar8x32_ps(channel[0], gather);
+    const __m256 c1 = _mm256_permutevar8x32_ps(channel[1], gather);
+    const __m256 c2 = _mm256_permutevar8x32_ps(channel[2], gather);
+    constexpr int mask1 = kInterleave8.mask1[J];
+    constexpr int mask2 = kInterleave8.mask2[J];
+    return _mm256_blend_ps(_mm256_blend_ps(c0, c1, mask1), c2, mask2);
+}
+
+CELUX_TARGET("avx2")
+void rowAvx2(const Row& r, const YuvToRgbMatrix& m)
+{
+    const __m256 yScale = _mm256_set1_ps(m.yScale);
+    const __m256 yBias = _mm256_set1_ps(m.yBias);
+    const __m256 cScale = _mm256_set1_ps(m.cScale);
+    const __m256 cBias = _mm256_set1_ps(m.cBias);
+    const __m256 rV = _mm256_set1_ps(m.rV);
+    const __m256 gU = _mm256_set1_ps(m.gU);
+    const __m256 gV = _mm256_set1_ps(m.gV);
+    const __m256 bU = _mm256_set1_ps(m.bU);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i uIndex = _mm256_setr_epi32(0, 0, 2, 2, 4, 4, 6, 6);
+    const __m256i vIndex = _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 7, 7);
+
+    int x = 0;
+    for (; x + 8 <= r.width; x += 8)
+    {
+        const __m256 yy = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r.y + x))));
+
+        // Four chroma pairs as u0 v0 u1 v1 u2 v2 u3 v3
+        __m128i uvBytes;
+        if (r.nv12)
+        {
+            uvBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r.u + x));
+        }
+        else
+        {
+            uvBytes = _mm_unpacklo_epi8(_mm_cvtsi32_si128(loadU32(r.u + x / 2)),
+                                        _mm_cvtsi32_si128(loadU32(r.v + x / 2)));
+        }
+        const __m256 uv = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(uvBytes));
+        const __m256 u =
+            _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(uv, uIndex), cScale),
+                          cBias);
+        const __m256 v =
+            _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(uv, vIndex), cScale),
+                          cBias);
+
+        const __m256 luma = _mm256_add_ps(_mm256_mul_ps(yy, yScale), yBias);
+        const __m256 red = _mm256_add_ps(luma, _mm256_mul_ps(rV, v));
+        const __m256 green = _mm256_add_ps(
+            luma, _mm256_add_ps(_mm256_mul_ps(gU, u), _mm256_mul_ps(gV, v)));
+        const __m256 blue = _mm256_add_ps(luma, _mm256_mul_ps(bU, u));
+
+        __m256 channel[3] = {r.bgr ? blue : red, green, r.bgr ? red : blue};
+        for (int c = 0; c < 3; ++c)
+        {
+            channel[c] = _mm256_min_ps(_mm256_max_ps(channel[c], zero), one);
+        }
+
+        if (r.planar)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                if (r.isFloat)
+                {
+                    _mm256_storeu_ps(static_cast<float*>(r.out[c]) + x, channel[c]);
+                }
+                else
+                {
+                    const __m256i bytes = toBytes(channel[c]);
+                    _mm_storel_epi64(
+                        reinterpret_cast<__m128i*>(static_cast<uint8_t*>(r.out[c]) + x),
+                        _mm256_castsi256_si128(packBytes8(bytes, bytes, bytes)));
+                }
+            }
+            continue;
+        }
+
+        const __m256 hwc[3] = {interleave8<0>(channel), interleave8<1>(channel),
+                               interleave8<2>(channel)};
+
+        if (r.isFloat)
+        {
+            float* dst = static_cast<float*>(r.out[0]) + 3 * x;
+            _mm256_storeu_ps(dst, hwc[0]);
+            _mm256_storeu_ps(dst + 8, hwc[1]);
+            _mm256_storeu_ps(dst + 16, hwc[2]);
+        }
+        else
+        {
+            uint8_t* dst = static_cast<uint8_t*>(r.out[0]) + 3 * x;
+            const __m256i bytes =
+                packBytes8(toBytes(hwc[0]), toBytes(hwc[1]), toBytes(hwc[2]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                             _mm256_castsi256_si128(bytes));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16),
+                             _mm256_extracti128_si256(bytes, 1));
+        }
+    }
+    rowScalar(r, m, x);
+}
+
+// ---- AVX-512: 16 pixels per iteration ----
+
+CELUX_TARGET("avx512f")
+inline __m128i toBytes16(__m512 value)
+{
+    return _mm512_cvtusepi32_epi8(_mm512_cvttps_epi32(_mm512_add_ps(
+        _mm512_mul_ps(value, _mm512_set1_ps(255.0f)), _mm512_set1_ps(0.5f))));
+}
+
+CELUX_TARGET("avx512f")
+void rowAvx512(const Row& r, const YuvToRgbMatrix& m)
+{
+    const __m512 yScale = _mm512_set1_ps(m.yScale);
+    const __m512 yBias = _mm512_set1_ps(m.yBias);
+    const __m512 cScale = _mm512_set1_ps(m.cScale);
+    const __m512 cBias = _mm512_set1_ps(m.cBias);
+    const __m512 rV = _mm512_set1_ps(m.rV);
+    const __m512 gU = _mm512_set1_ps(m.gU);
+    const __m512 gV = _mm512_set1_ps(m.gV);
+    const __m512 bU = _mm512_set1_ps(m.bU);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512i uIndex =
+        _mm512_setr_epi32(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m512i vIndex =
+        _mm512_setr_epi32(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+    __m512i gather[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        gather[j] = _mm512_loadu_si512(kInterleave16.index[j]);
+    }
+
+    int x = 0;
+    for (; x + 16 <= r.width; x += 16)
+    {
+        const __m512 yy = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(r.y + x))));
+
+        __m128i uvBytes;
+        if (r.nv12)
+        {
+            uvBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r.u + x));
+        }
+        else
+        {
+            uvBytes = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r.u + x / 2)),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r.v + x / 2)));
+        }
+        const __m512 uv = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(uvBytes));
+        const __m512 u =
+            _mm512_add_ps(_mm512_mul_ps(_mm512_permutexvar_ps(uIndex, uv), cScale),
+                          cBias);
+        const __m512 v =
+            _mm512_add_ps(_mm512_mul_ps(_mm512_permutexvar_ps(vIndex, uv), cScale),
+                          cBias);
+
+        const __m512 luma = _mm512_add_ps(_mm512_mul_ps(yy, yScale), yBias);
+        const __m512 red = _mm512_add_ps(luma, _mm512_mul_ps(rV, v));
+        const __m512 green = _mm512_add_ps(
+            luma, _mm512_add_ps(_mm512_mul_ps(gU, u), _mm512_mul_ps(gV, v)));
+        const __m512 blue = _mm512_add_ps(luma, _mm512_mul_ps(bU, u));
+
+        __m512 channel[3] = {r.bgr ? blue : red, green, r.bgr ? red : blue};
+        for (int c = 0; c < 3; ++c)
+        {
+            channel[c] = _mm512_min_ps(_mm512_max_ps(channel[c], zero), one);
+        }
+
+        if (r.planar)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                if (r.isFloat)
+                {
+                    _mm512_storeu_ps(static_cast<float*>(r.out[c]) + x, channel[c]);
+                }
+                else
+                {
+                    _mm_storeu_si128(
+                        reinterpret_cast<__m128i*>(static_cast<uint8_t*>(r.out[c]) + x),
+                        toBytes16(channel[c]));
+                }
+            }
+            continue;
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+            const __m512 c0 = _mm512_permutexvar_ps(gather[j], channel[0]);
+            const __m512 c1 = _mm512_permutexvar_ps(gather[j], channel[1]);
+            const __m512 c2 = _mm512_permutexvar_ps(gather[j], channel[2]);
+            const __m512 hwc = _mm512_mask_blend_ps(
+                static_cast<__mmask16>(kInterleave16.mask2[j]),
+                _mm512_mask_blend_ps(static_cast<__mmask16>(kInterleave16.mask1[j]),
+                                     c0, c1),
+                c2);
+            if (r.isFloat)
+            {
+                _mm512_storeu_ps(static_cast<float*>(r.out[0]) + 3 * x + 16 * j, hwc);
+            }
+            else
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(
+                                     static_cast<uint8_t*>(r.out[0]) + 3 * x + 16 * j),
+                                 toBytes16(hwc));
+            }
+        }
+    }
+    rowScalar(r, m, x);
+}
+
+#endif // CELUX_X86
+
+#ifdef CELUX_NEON
+
+// ---- NEON: 8 pixels per iteration ----
+
+inline uint8x8_t toBytes(float32x4_t lo, float32x4_t hi)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const uint32x4_t a = vcvtq_u32_f32(vmlaq_n_f32(half, lo, 255.0f));
+    const uint32x4_t b = vcvtq_u32_f32(vmlaq_n_f32(half, hi, 255.0f));
+    return vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b)));
+}
+
+void rowNeon(const Row& r, const YuvToRgbMatrix& m)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t yBias = vdupq_n_f32(m.yBias);
+    const float32x4_t cBias = vdupq_n_f32(m.cBias);
+
+    int x = 0;
+    for (; x + 8 <= r.width; x += 8)
+    {
+        const uint16x8_t y16 = vmovl_u8(vld1_u8(r.y + x));
+
+        uint16x4_t u4, v4;
+        if (r.nv12)
+        {
+            // Little endian: each 16-bit lane holds u | v << 8
+            const uint16x4_t uv16 = vreinterpret_u16_u8(vld1_u8(r.u + x));
+            u4 = vand_u16(uv16, vdup_n_u16(0xff));
+            v4 = vshr_n_u16(uv16, 8);
+        }
+        else
+        {
+            uint32_t uBits, vBits;
+            std::memcpy(&uBits, r.u + x / 2, sizeof(uBits));
+            std::memcpy(&vBits, r.v + x / 2, sizeof(vBits));
+            u4 = vget_low_u16(vmovl_u8(vcreate_u8(uBits)));
+            v4 = vget_low_u16(vmovl_u8(vcreate_u8(vBits)));
+        }
+        // Each chroma sample covers two horizontal pixels
+        const uint16x4x2_t uPairs = vzip_u16(u4, u4);
+        const uint16x4x2_t vPairs = vzip_u16(v4, v4);
+
+        float32x4_t channel[2][3];
+        for (int h = 0; h < 2; ++h)
+        {
+            const float32x4_t yy = vcvtq_f32_u32(
+                vmovl_u16(h == 0 ? vget_low_u16(y16) : vget_high_u16(y16)));
+            const float32x4_t u = vfmaq_n_f32(
+                cBias, vcvtq_f32_u32(vmovl_u16(uPairs.val[h])), m.cScale);
+            const float32x4_t v = vfmaq_n_f32(
+                cBias, vcvtq_f32_u32(vmovl_u16(vPairs.val[h])), m.cScale);
+            const float32x4_t luma = vfmaq_n_f32(yBias, yy, m.yScale);
+
+            const float32x4_t red = vaddq_f32(luma, vmulq_n_f32(v, m.rV));
+            const float32x4_t green =
+                vaddq_f32(luma, vfmaq_n_f32(vmulq_n_f32(v, m.gV), u, m.gU));
+            const float32x4_t blue = vaddq_f32(luma, vmulq_n_f32(u, m.bU));
+
+            channel[h][0] = vminq_f32(vmaxq_f32(r.bgr ? blue : red, zero), one);
+            channel[h][1] = vminq_f32(vmaxq_f32(green, zero), one);
+            channel[h][2] = vminq_f32(vmaxq_f32(r.bgr ? red : blue, zero), one);
+        }
+
+        if (r.isFloat)
+        {
+            if (r.planar)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    float* dst = static_cast<float*>(r.out[c]) + x;
+                    vst1q_f32(dst, channel[0][c]);
+                    vst1q_f32(dst + 4, channel[1][c]);
+                }
+            }
+            else
+            {
+                float* dst = static_cast<float*>(r.out[0]) + 3 * x;
+                for (int h = 0; h < 2; ++h)
+                {
+                    float32x4x3_t hwc = {{channel[h][0], channel[h][1], channel[h][2]}};
+                    vst3q_f32(dst + 12 * h, hwc);
+                }
+            }
+        }
+        else
+        {
+            uint8x8x3_t bytes;
+            for (int c = 0; c < 3; ++c)
+            {
+                bytes.val[c] = toBytes(channel[0][c], channel[1][c]);
+            }
+            if (r.planar)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    vst1_u8(static_cast<uint8_t*>(r.out[c]) + x, bytes.val[c]);
+                }
+            }
+            else
+            {
+                vst3_u8(static_cast<uint8_t*>(r.out[0]) + 3 * x, bytes);
+            }
+        }
+    }
+    rowScalar(r, m, x);
+}
+
+#endif // CELUX_NEON
+
+SimdLevel detectSimdLevel()
+{
+#if defined(CELUX_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return SimdLevel::Scalar;
+    }
+    __cpuidex(info, 1, 0);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+    {
+        return SimdLevel::Scalar;
+    }
+    // The OS must save the YMM (and for AVX-512 the ZMM/opmask) state
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512f = (info[1] & (1 << 16)) != 0;
+    if (avx512f && (xcr0 & 0xe6) == 0xe6)
+    {
+        return SimdLevel::AVX512;
+    }
+    if (avx2 && (xcr0 & 0x6) == 0x6)
+    {
+        return SimdLevel::AVX2;
+    }
+#elif defined(CELUX_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::AVX2;
+    }
+#elif defined(CELUX_NEON)
+    return SimdLevel::NEON; // Baseline on AArch64
+#endif
+    return SimdLevel::Scalar;
+}
+
+} // namespace
+
+SimdLevel activeSimdLevel()
+{
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::NEON:
+        return "neon";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+void yuv420ToRgb(const Yuv420Image& src, const RgbImage& dst,
+                 const YuvToRgbMatrix& matrix, int firstRow, int rows,
+                 SimdLevel level)
+{
+    const size_t elementSize = dst.isFloat ? sizeof(float) : sizeof(uint8_t);
+    const size_t planeElements = static_cast<size_t>(src.width) * src.height;
+    uint8_t* base = static_cast<uint8_t*>(dst.data);
+
+    Row r;
+    r.nv12 = src.nv12;
+    r.width = src.width;
+    r.isFloat = dst.isFloat;
+    r.planar = dst.planar;
+    r.bgr = dst.bgr;
+
+    const int lastRow = std::min(firstRow + rows, src.height);
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        r.y = src.y + static_cast<ptrdiff_t>(y) * src.yStride;
+        r.u = src.u + static_cast<ptrdiff_t>(y / 2) * src.uStride;
+        r.v = src.nv12 ? nullptr : src.v + static_cast<ptrdiff_t>(y / 2) * src.vStride;
+        if (dst.planar)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                r.out[c] = base + (c * planeElements +
+                                   static_cast<size_t>(y) * src.width) *
+                                      elementSize;
+            }
+        }
+        else
+        {
+            r.out[0] = base + static_cast<size_t>(y) * src.width * 3 * elementSize;
+            r.out[1] = r.out[2] = nullptr;
+        }
+
+        switch (level)
+        {
+#ifdef CELUX_X86
+        case SimdLevel::AVX512:
+            rowAvx512(r, matrix);
+            break;
+        case SimdLevel::AVX2:
+            rowAvx2(r, matrix);
+            break;
+#endif
+#ifdef CELUX_NEON
+        case SimdLevel::NEON:
+            rowNeon(r, matrix);
+            break;
+#endif
+        default:
+            rowScalar(r, matrix, 0);
+            break;
+        }
+    }
+}
+
+} // namespace cpu
+} // namespace conversion
+} // namespace celux
@@ -0,0 +1,79 @@
+// p010_to_rgb.cu
+#include "yuv_to_rgb.cuh"
+#include <stdexcept>
+#include <string>
+
+using celux::conversion::ResampleParams;
+using celux::conversion::YuvToRgbMatrix;
+using celux::kernels::launchSemiPlanarToRgb;
+
+namespace
+{
+void checkLaunch(cudaError_t err, const char* type)
+{
+    if (err != cudaSuccess)
+    {
+        throw std::runtime_error(std::string("CUDA kernel launch failed (") + type +
+                                 "): " + cudaGetErrorString(err));
+    }
+}
+} // namespace
+
+extern "C"
+{
+
+    // Host function to launch the unsigned char kernel
+    void p010_to_rgb(const unsigned char* yPlane, const unsigned char* uvPlane,
+                     int width, int height, int yStride, int uvStride,
+                     unsigned char* rgbOutput, int rgbStride, bool planar,
+                     const YuvToRgbMatrix* matrix, const ResampleParams* resample,
+                     cudaStream_t stream = 0)
+    {
+        checkLaunch(launchSemiPlanarToRgb<unsigned short, unsigned char, false>(
+                        yPlane, uvPlane, width, height, yStride, uvStride, rgbOutput,
+                        rgbStride, planar, *matrix, nullptr, nullptr, resample, stream),
+                    "uchar");
+    }
+
+    // Host function to launch the unsigned short kernel
+    void p010_to_rgb_uint16(const unsigned char* yPlane, const unsigned char* uvPlane,
+                            int width, int height, int yStride, int uvStride,
+                            unsigned short* rgbOutput, int rgbStride, bool planar,
+                            const YuvToRgbMatrix* matrix,
+                            const ResampleParams* resample, cudaStream_t stream = 0)
+    {
+        checkLaunch(launchSemiPlanarToRgb<unsigned short, unsigned short, false>(
+                        yPlane, uvPlane, width, height, yStride, uvStride, rgbOutput,
+                        rgbStride, planar, *matrix, nullptr, nullptr, resample, stream),
+                    "ushort");
+    }
+
+    // Host function to launch the float kernel
+    void p010_to_rgb_float(const unsigned char* yPlane, const unsigned char* uvPlane,
+                           int width, int height, int yStride, int uvStride,
+                           float* rgbOutput, int rgbStride, bool planar,
+                           const YuvToRgbMatrix* matrix, const float* mean,
+                           const float* stddev, const ResampleParams* resample,
+                           cudaStream_t stream = 0)
+    {
+        checkLaunch(launchSemiPlanarToRgb<unsigned short, float, false>(
+                        yPlane, uvPlane, width, height, yStride, uvStride, rgbOutput,
+                        rgbStride, planar, *matrix, mean, stddev, resample, stream),
+                    "float");
+    }
+
+    // Host function to launch the __half kernel
+    void p010_to_rgb_half(const unsigned char* yPlane, const unsigned char* uvPlane,
+                          int width, int height, int yStride, int uvStride,
+                          __half* rgbOutput, int rgbStride, bool planar,
+                          const YuvToRgbMatrix* matrix, const float* mean,
+                          const float* stddev, const ResampleParams* resample,
+                          cudaStream_t stream = 0)
+    {
+        checkLaunch(launchSemiPlanarToRgb<unsigned short, __half, false>(
+                        yPlane, uvPlane, width, height, yStride, uvStride, rgbOutput,
+                        rgbStride, planar, *matrix, mean, stddev, resample, stream),
+                    "__half");
+    }
+
+} // extern "C"
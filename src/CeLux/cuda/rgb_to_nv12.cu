@@ -3,6 +3,7 @@
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>
 #include <stdexcept>
+#include <string>
 
 extern "C"
 {
@@ -135,9 +136,9 @@ extern "C"
         cudaError_t err = cudaGetLastError();
         if (err != cudaSuccess)
         {
-            fprintf(stderr, "CUDA kernel launch error (uchar): %s\n",
-                    cudaGetErrorString(err));
-            throw std::runtime_error("CUDA kernel launch failed (uchar).\n");
+            throw std::runtime_error(
+                std::string("CUDA kernel launch failed (uchar): ") +
+                cudaGetErrorString(err));
         }
     }
 
@@ -156,9 +157,9 @@ extern "C"
         cudaError_t err = cudaGetLastError();
         if (err != cudaSuccess)
         {
-            fprintf(stderr, "CUDA kernel launch error (float): %s\n",
-                    cudaGetErrorString(err));
-            throw std::runtime_error("CUDA kernel launch failed (float).\n");
+            throw std::runtime_error(
+                std::string("CUDA kernel launch failed (float): ") +
+                cudaGetErrorString(err));
         }
     }
 
@@ -177,9 +178,9 @@ extern "C"
         cudaError_t err = cudaGetLastError();
         if (err != cudaSuccess)
         {
-            fprintf(stderr, "CUDA kernel launch error (__half): %s\n",
-                    cudaGetErrorString(err));
-            throw std::runtime_error("CUDA kernel launch failed (__half).\n");
+            throw std::runtime_error(
+                std::string("CUDA kernel launch failed (__half): ") +
+                cudaGetErrorString(err));
         }
     }
 
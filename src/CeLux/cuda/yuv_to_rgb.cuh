@@ -0,0 +1,466 @@
+// yuv_to_rgb.cuh
+// Shared semi-planar YUV 4:2:0 (NV12, P010, P016) -> RGB/BGR kernels. At source
+// size each thread converts one 2x2 block, which shares a single UV sample, and
+// writes pairs of elements with 2-wide vector stores whenever the output is
+// suitably aligned. When resizing, each thread filters Y and UV for one output
+// pixel straight from the source planes, so no full size RGB image is written.
+#pragma once
+
+#include "ColorSpace.hpp"
+#include "Resample.hpp"
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+#include <device_launch_parameters.h>
+#include <cstdint>
+
+namespace celux
+{
+namespace kernels
+{
+
+using celux::conversion::ResampleParams;
+using celux::conversion::ResizeFilter;
+using celux::conversion::YuvToRgbMatrix;
+
+// Per-channel affine applied after conversion: out = value * scale + bias.
+// Encodes (value - mean) / std; identity when normalization is off.
+struct ChannelAffine
+{
+    float scale[3];
+    float bias[3];
+};
+
+inline ChannelAffine makeAffine(const float* mean, const float* stddev)
+{
+    ChannelAffine affine;
+    for (int c = 0; c < 3; ++c)
+    {
+        affine.scale[c] = (mean && stddev) ? 1.0f / stddev[c] : 1.0f;
+        affine.bias[c] = (mean && stddev) ? -mean[c] / stddev[c] : 0.0f;
+    }
+    return affine;
+}
+
+// Source sample types (8-bit NV12, 16-bit words for P010/P016) and the 2-wide
+// vector used to read a luma pair or an interleaved UV sample
+template <typename S> struct SourceTraits;
+
+template <> struct SourceTraits<unsigned char>
+{
+    using Vec2 = uchar2;
+};
+
+template <> struct SourceTraits<unsigned short>
+{
+    using Vec2 = ushort2;
+};
+
+// Output element types and their 2-wide vector counterparts
+template <typename T> struct OutputTraits;
+
+template <> struct OutputTraits<unsigned char>
+{
+    using Vec2 = uchar2;
+    static __device__ unsigned char store(float value, float, float)
+    {
+        // Affine is never used for integer output
+        return static_cast<unsigned char>(__saturatef(value) * 255.0f + 0.5f);
+    }
+    static __device__ Vec2 pack(unsigned char a, unsigned char b)
+    {
+        return make_uchar2(a, b);
+    }
+};
+
+template <> struct OutputTraits<unsigned short>
+{
+    using Vec2 = ushort2;
+    static __device__ unsigned short store(float value, float, float)
+    {
+        return static_cast<unsigned short>(__saturatef(value) * 65535.0f + 0.5f);
+    }
+    static __device__ Vec2 pack(unsigned short a, unsigned short b)
+    {
+        return make_ushort2(a, b);
+    }
+};
+
+template <> struct OutputTraits<float>
+{
+    using Vec2 = float2;
+    static __device__ float store(float value, float scale, float bias)
+    {
+        return fmaf(__saturatef(value), scale, bias);
+    }
+    static __device__ Vec2 pack(float a, float b)
+    {
+        return make_float2(a, b);
+    }
+};
+
+template <> struct OutputTraits<__half>
+{
+    using Vec2 = __half2;
+    static __device__ __half store(float value, float scale, float bias)
+    {
+        // Normalize in float so small std values don't lose precision
+        return __float2half(fmaf(__saturatef(value), scale, bias));
+    }
+    static __device__ Vec2 pack(__half a, __half b)
+    {
+        return __halves2half2(a, b);
+    }
+};
+
+// Writes two horizontally adjacent values, vectorized when both exist and
+// the destination is aligned for the pair
+template <typename T>
+__device__ __forceinline__ void storePair(T* dst, T a, T b, bool pair, bool vector)
+{
+    if (pair && vector)
+    {
+        *reinterpret_cast<typename OutputTraits<T>::Vec2*>(dst) =
+            OutputTraits<T>::pack(a, b);
+    }
+    else
+    {
+        dst[0] = a;
+        if (pair)
+        {
+            dst[1] = b;
+        }
+    }
+}
+
+/**
+ * @brief Semi-planar 4:2:0 YUV to packed (HWC) or planar (CHW) RGB/BGR.
+ *
+ * @tparam S Source sample type; strides are always in bytes.
+ * @param vectorStores Host-verified: width is even and `output` is aligned
+ * for 2-element vector stores.
+ */
+template <typename S, typename T, bool BGR>
+__global__ void semiPlanarToRgbKernel(const unsigned char* __restrict__ yPlane,
+                                      const unsigned char* __restrict__ uvPlane,
+                                      int width, int height, int yStride, int uvStride,
+                                      T* __restrict__ output, int outputStride,
+                                      bool planar, bool vectorStores, YuvToRgbMatrix m,
+                                      ChannelAffine affine)
+{
+    using SrcVec2 = typename SourceTraits<S>::Vec2;
+
+    const int x0 = 2 * (blockIdx.x * blockDim.x + threadIdx.x);
+    const int y0 = 2 * (blockIdx.y * blockDim.y + threadIdx.y);
+    if (x0 >= width || y0 >= height)
+    {
+        return;
+    }
+    const bool pair = x0 + 1 < width;
+
+    // One chroma sample serves the whole block; x0 is even so the read is aligned
+    const S* uvRow = reinterpret_cast<const S*>(uvPlane + (y0 / 2) * uvStride);
+    const SrcVec2 uv = *reinterpret_cast<const SrcVec2*>(&uvRow[x0]);
+    const float u = fmaf(uv.x, m.cScale, m.cBias);
+    const float v = fmaf(uv.y, m.cScale, m.cBias);
+    const float dr = m.rV * v;
+    const float dg = fmaf(m.gU, u, m.gV * v);
+    const float db = m.bU * u;
+
+    // Channel slots in the output; BGR just swaps the outer two
+    const int cr = BGR ? 2 : 0;
+    const int cb = BGR ? 0 : 2;
+    const size_t planeSize = static_cast<size_t>(width) * height;
+
+    for (int dy = 0; dy < 2 && y0 + dy < height; ++dy)
+    {
+        const int y = y0 + dy;
+        const S* yRow =
+            reinterpret_cast<const S*>(yPlane + static_cast<size_t>(y) * yStride);
+        float luma[2];
+        if (pair)
+        {
+            const SrcVec2 yy = *reinterpret_cast<const SrcVec2*>(&yRow[x0]);
+            luma[0] = fmaf(yy.x, m.yScale, m.yBias);
+            luma[1] = fmaf(yy.y, m.yScale, m.yBias);
+        }
+        else
+        {
+            luma[0] = fmaf(yRow[x0], m.yScale, m.yBias);
+            luma[1] = 0.0f;
+        }
+
+        // Normalization parameters are given in R, G, B order
+        using Out = OutputTraits<T>;
+        T px[2][3];
+        for (int i = 0; i < 2; ++i)
+        {
+            px[i][cr] = Out::store(luma[i] + dr, affine.scale[0], affine.bias[0]);
+            px[i][1] = Out::store(luma[i] + dg, affine.scale[1], affine.bias[1]);
+            px[i][cb] = Out::store(luma[i] + db, affine.scale[2], affine.bias[2]);
+        }
+
+        if (planar)
+        {
+            T* dst = output + static_cast<size_t>(y) * width + x0;
+            for (int c = 0; c < 3; ++c)
+            {
+                storePair(dst + c * planeSize, px[0][c], px[1][c], pair, vectorStores);
+            }
+        }
+        else
+        {
+            T* dst = output + static_cast<size_t>(y) * outputStride + 3 * x0;
+            if (pair && vectorStores)
+            {
+                // Six consecutive elements as three aligned pairs
+                storePair(dst + 0, px[0][0], px[0][1], true, true);
+                storePair(dst + 2, px[0][2], px[1][0], true, true);
+                storePair(dst + 4, px[1][1], px[1][2], true, true);
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    dst[c] = px[0][c];
+                }
+                if (pair)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        dst[3 + c] = px[1][c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Source samples contributing to one output pixel along one axis of a plane
+struct AxisTaps
+{
+    int first;    // First source index
+    int count;    // Number of taps
+    int last;     // Indices are clamped to [.., last] (the crop edge)
+    int lowest;   // and to [lowest, ..]
+    float start;  // Area: covered interval [start, end); bilinear: fraction
+    float end;
+    float norm;   // Area: 1 / interval length
+    bool area;
+
+    __device__ int index(int k) const
+    {
+        return min(max(first + k, lowest), last);
+    }
+
+    __device__ float weight(int k) const
+    {
+        if (area)
+        {
+            const float lo = fmaxf(start, static_cast<float>(first + k));
+            const float hi = fminf(end, static_cast<float>(first + k + 1));
+            return (hi - lo) * norm;
+        }
+        return k == 0 ? 1.0f - start : start;
+    }
+};
+
+/**
+ * @brief Taps for output index `o` of a plane axis.
+ *
+ * @param base First source sample of the crop in this plane.
+ * @param length Crop length in this plane's samples (may be fractional for
+ * subsampled chroma).
+ * @param scale Source samples per output pixel.
+ */
+__device__ __forceinline__ AxisTaps makeTaps(int o, float base, float length,
+                                             float scale, bool area)
+{
+    AxisTaps taps;
+    taps.lowest = static_cast<int>(base);
+    taps.last = max(static_cast<int>(ceilf(base + length)) - 1, taps.lowest);
+    taps.area = area && scale > 1.0f;
+    if (taps.area)
+    {
+        taps.start = base + o * scale;
+        taps.end = fminf(taps.start + scale, base + length);
+        taps.first = static_cast<int>(floorf(taps.start));
+        taps.count = static_cast<int>(ceilf(taps.end)) - taps.first;
+        taps.norm = 1.0f / (taps.end - taps.start);
+    }
+    else
+    {
+        // Sample centers line up: output pixel o covers the source interval
+        // [o, o + 1) * scale
+        const float position = fmaxf(base + (o + 0.5f) * scale - 0.5f, base);
+        taps.first = static_cast<int>(floorf(position));
+        taps.start = position - taps.first;
+        taps.count = 2;
+        taps.end = 0.0f;
+        taps.norm = 0.0f;
+    }
+    return taps;
+}
+
+// Filters N interleaved components of a plane of S samples
+template <typename S, int N>
+__device__ __forceinline__ void filterPlane(const unsigned char* __restrict__ plane,
+                                            int stride, const AxisTaps& tx,
+                                            const AxisTaps& ty, float* out)
+{
+    for (int n = 0; n < N; ++n)
+    {
+        out[n] = 0.0f;
+    }
+    for (int j = 0; j < ty.count; ++j)
+    {
+        const float wy = ty.weight(j);
+        const size_t offset = static_cast<size_t>(ty.index(j)) * stride;
+        const S* row = reinterpret_cast<const S*>(plane + offset);
+        for (int i = 0; i < tx.count; ++i)
+        {
+            const float w = wy * tx.weight(i);
+            const S* sample = row + tx.index(i) * N;
+            for (int n = 0; n < N; ++n)
+            {
+                out[n] = fmaf(w, static_cast<float>(sample[n]), out[n]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Semi-planar 4:2:0 YUV crop/resize fused with the conversion to RGB/BGR.
+ *
+ * Each thread produces one output pixel. Y and UV are filtered separately on
+ * their own sample grids and then converted; the conversion is affine, so this
+ * matches filtering the RGB image apart from clamping.
+ */
+template <typename S, typename T, bool BGR>
+__global__ void resampleToRgbKernel(const unsigned char* __restrict__ yPlane,
+                                    const unsigned char* __restrict__ uvPlane,
+                                    int yStride, int uvStride, ResampleParams p,
+                                    T* __restrict__ output, int outputStride,
+                                    bool planar, YuvToRgbMatrix m, ChannelAffine affine)
+{
+    const int ox = blockIdx.x * blockDim.x + threadIdx.x;
+    const int oy = blockIdx.y * blockDim.y + threadIdx.y;
+    if (ox >= p.outputWidth || oy >= p.outputHeight)
+    {
+        return;
+    }
+
+    const bool area = p.filter == ResizeFilter::Area;
+    const float scaleX = static_cast<float>(p.cropWidth) / p.outputWidth;
+    const float scaleY = static_cast<float>(p.cropHeight) / p.outputHeight;
+
+    float luma;
+    filterPlane<S, 1>(yPlane, yStride,
+                      makeTaps(ox, p.cropX, p.cropWidth, scaleX, area),
+                      makeTaps(oy, p.cropY, p.cropHeight, scaleY, area), &luma);
+    // Chroma has half the samples per axis, centered between luma pairs
+    float uv[2];
+    filterPlane<S, 2>(
+        uvPlane, uvStride,
+        makeTaps(ox, p.cropX / 2, 0.5f * p.cropWidth, 0.5f * scaleX, area),
+        makeTaps(oy, p.cropY / 2, 0.5f * p.cropHeight, 0.5f * scaleY, area), uv);
+
+    const float y = fmaf(luma, m.yScale, m.yBias);
+    const float u = fmaf(uv[0], m.cScale, m.cBias);
+    const float v = fmaf(uv[1], m.cScale, m.cBias);
+
+    // Normalization parameters are given in R, G, B order
+    using Out = OutputTraits<T>;
+    T px[3];
+    px[BGR ? 2 : 0] = Out::store(y + m.rV * v, affine.scale[0], affine.bias[0]);
+    px[1] = Out::store(y + fmaf(m.gU, u, m.gV * v), affine.scale[1], affine.bias[1]);
+    px[BGR ? 0 : 2] = Out::store(y + m.bU * u, affine.scale[2], affine.bias[2]);
+
+    if (planar)
+    {
+        const size_t planeSize = static_cast<size_t>(p.outputWidth) * p.outputHeight;
+        T* dst = output + static_cast<size_t>(oy) * p.outputWidth + ox;
+        for (int c = 0; c < 3; ++c)
+        {
+            dst[c * planeSize] = px[c];
+        }
+    }
+    else
+    {
+        T* dst = output + static_cast<size_t>(oy) * outputStride + 3 * ox;
+        for (int c = 0; c < 3; ++c)
+        {
+            dst[c] = px[c];
+        }
+    }
+}
+
+/**
+ * @brief Launch the conversion on a stream and report launch errors.
+ *
+ * @param resample Crop and output size, or null to convert the whole frame at
+ * its own size. A crop without resize runs the 2x2 block kernel on the cropped
+ * planes; `outputStride` always refers to the output size.
+ */
+template <typename S, typename T, bool BGR>
+cudaError_t launchSemiPlanarToRgb(const unsigned char* yPlane,
+                                  const unsigned char* uvPlane, int width, int height,
+                                  int yStride, int uvStride, T* output,
+                                  int outputStride, bool planar,
+                                  const YuvToRgbMatrix& matrix, const float* mean,
+                                  const float* stddev,
+                                  const ResampleParams* resample, cudaStream_t stream)
+{
+    if (resample && resample->resizes())
+    {
+        const dim3 block(32, 8);
+        const dim3 grid((resample->outputWidth + block.x - 1) / block.x,
+                        (resample->outputHeight + block.y - 1) / block.y);
+        resampleToRgbKernel<S, T, BGR><<<grid, block, 0, stream>>>(
+            yPlane, uvPlane, yStride, uvStride, *resample, output, outputStride,
+            planar, matrix, makeAffine(mean, stddev));
+        return cudaGetLastError();
+    }
+    if (resample)
+    {
+        // Even crop origins keep the 2x2 blocks aligned with the chroma samples
+        yPlane += static_cast<size_t>(resample->cropY) * yStride +
+                  resample->cropX * sizeof(S);
+        uvPlane += static_cast<size_t>(resample->cropY / 2) * uvStride +
+                   resample->cropX * sizeof(S);
+        width = resample->cropWidth;
+        height = resample->cropHeight;
+    }
+
+    // 16x16 threads cover a 32x32 pixel tile
+    const dim3 block(16, 16);
+    const dim3 grid(((width + 1) / 2 + block.x - 1) / block.x,
+                    ((height + 1) / 2 + block.y - 1) / block.y);
+
+    const bool aligned =
+        reinterpret_cast<uintptr_t>(output) % (2 * sizeof(T)) == 0 && width % 2 == 0 &&
+        (planar || outputStride % 2 == 0);
+
+    semiPlanarToRgbKernel<S, T, BGR><<<grid, block, 0, stream>>>(
+        yPlane, uvPlane, width, height, yStride, uvStride, output, outputStride, planar,
+        aligned, matrix, makeAffine(mean, stddev));
+    return cudaGetLastError();
+}
+
+/**
+ * @brief NV12 (8-bit) entry point of launchSemiPlanarToRgb.
+ */
+template <typename T, bool BGR>
+cudaError_t launchNv12ToRgb(const unsigned char* yPlane, const unsigned char* uvPlane,
+                            int width, int height, int yStride, int uvStride,
+                            T* output, int outputStride, bool planar,
+                            const YuvToRgbMatrix& matrix, const float* mean,
+                            const float* stddev, const ResampleParams* resample,
+                            cudaStream_t stream)
+{
+    return launchSemiPlanarToRgb<unsigned char, T, BGR>(
+        yPlane, uvPlane, width, height, yStride, uvStride, output, outputStride,
+        planar, matrix, mean, stddev, resample, stream);
+}
+
+} // namespace kernels
+} // namespace celux
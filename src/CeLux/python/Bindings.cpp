@@ -1,27 +1,341 @@
+#include "Python/PyIO.hpp"
+#include "Python/Remux.hpp"
+#include "Python/Transcoder.hpp"
 #include "Python/VideoReader.hpp"
+#include "Python/VideoReaderPool.hpp"
 #include "Python/VideoWriter.hpp"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <cstdint>
+#include <map>
+#include <optional>
 
 namespace py = pybind11;
 
+namespace
+{
+// Maps the Python-facing thread_type names to FFmpeg's FF_THREAD_* flags
+int parseThreadType(const std::string& threadType)
+{
+    if (threadType == "auto")
+    {
+        return FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+    if (threadType == "frame")
+    {
+        return FF_THREAD_FRAME;
+    }
+    if (threadType == "slice")
+    {
+        return FF_THREAD_SLICE;
+    }
+    throw std::invalid_argument("Unsupported thread_type: " + threadType +
+                                " (expected 'auto', 'frame' or 'slice')");
+}
+
+// Builds the fused layout/normalization settings from the Python arguments
+celux::conversion::ConversionOptions
+parseConversion(const std::string& layout,
+                const std::optional<std::vector<float>>& mean,
+                const std::optional<std::vector<float>>& stddev)
+{
+    celux::conversion::ConversionOptions conversion;
+    if (layout == "chw")
+    {
+        conversion.planar = true;
+    }
+    else if (layout != "hwc")
+    {
+        throw std::invalid_argument("Unsupported layout: " + layout +
+                                    " (expected 'hwc' or 'chw')");
+    }
+
+    if (mean.has_value() != stddev.has_value())
+    {
+        throw std::invalid_argument("mean and std must be given together");
+    }
+    if (mean)
+    {
+        if (mean->size() != 3 || stddev->size() != 3)
+        {
+            throw std::invalid_argument("mean and std must have 3 values each");
+        }
+        conversion.normalize = true;
+        for (int c = 0; c < 3; ++c)
+        {
+            if ((*stddev)[c] == 0.0f)
+            {
+                throw std::invalid_argument("std values must be non-zero");
+            }
+            conversion.mean[c] = (*mean)[c];
+            conversion.stddev[c] = (*stddev)[c];
+        }
+    }
+    return conversion;
+}
+
+// Reads an optional (width, height) argument; leaves the outputs alone if unset
+void parseSize(const std::optional<std::vector<int>>& size, const std::string& name,
+               int& width, int& height)
+{
+    if (!size)
+    {
+        return;
+    }
+    if (size->size() != 2 || (*size)[0] <= 0 || (*size)[1] <= 0)
+    {
+        throw std::invalid_argument(name +
+                                    " must be two positive integers (width, height)");
+    }
+    width = (*size)[0];
+    height = (*size)[1];
+}
+
+// Reads an optional (x, y, width, height) crop argument
+void parseCrop(const std::optional<std::vector<int>>& crop, const std::string& name,
+               int& x, int& y, int& width, int& height)
+{
+    if (!crop)
+    {
+        return;
+    }
+    if (crop->size() != 4 || (*crop)[0] < 0 || (*crop)[1] < 0 || (*crop)[2] <= 0 ||
+        (*crop)[3] <= 0)
+    {
+        throw std::invalid_argument(
+            name + " must be four integers (x, y, width, height) with a positive size");
+    }
+    if ((*crop)[0] % 2 != 0 || (*crop)[1] % 2 != 0)
+    {
+        throw std::invalid_argument(name + " x and y must be even");
+    }
+    x = (*crop)[0];
+    y = (*crop)[1];
+    width = (*crop)[2];
+    height = (*crop)[3];
+}
+
+// Adds the crop/resize arguments to the conversion settings
+void parseResample(celux::conversion::ConversionOptions& conversion,
+                   const std::optional<std::vector<int>>& resize,
+                   const std::optional<std::vector<int>>& crop,
+                   const std::string& interpolation)
+{
+    parseSize(resize, "resize", conversion.outputWidth, conversion.outputHeight);
+    parseCrop(crop, "crop", conversion.cropX, conversion.cropY, conversion.cropWidth,
+              conversion.cropHeight);
+    if (interpolation == "bilinear")
+    {
+        conversion.resizeFilter = celux::conversion::ResizeFilter::Bilinear;
+    }
+    else if (interpolation == "area")
+    {
+        conversion.resizeFilter = celux::conversion::ResizeFilter::Area;
+    }
+    else
+    {
+        throw std::invalid_argument("Unsupported interpolation: " + interpolation +
+                                    " (expected 'bilinear' or 'area')");
+    }
+}
+
+// Accepts a torch.cuda.Stream (or anything with a cuda_stream attribute) or a raw
+// cudaStream_t handle as an integer; None selects the converter's own stream
+void* parseStream(const py::object& stream)
+{
+    if (stream.is_none())
+    {
+        return nullptr;
+    }
+    py::object handle = py::hasattr(stream, "cuda_stream")
+                            ? py::object(stream.attr("cuda_stream"))
+                            : stream;
+    return reinterpret_cast<void*>(handle.cast<std::uintptr_t>());
+}
+
+// Accepts fps as a float, a fractions.Fraction (or int) or a (num, den) pair.
+// Exact rates go to `rate`; a float is left for the encoder to interpret.
+double parseFrameRate(const py::object& fps, AVRational& rate)
+{
+    if (py::hasattr(fps, "numerator") && py::hasattr(fps, "denominator"))
+    {
+        rate = {fps.attr("numerator").cast<int>(), fps.attr("denominator").cast<int>()};
+    }
+    else if (py::isinstance<py::tuple>(fps) || py::isinstance<py::list>(fps))
+    {
+        const auto pair = fps.cast<std::vector<int>>();
+        if (pair.size() != 2)
+        {
+            throw std::invalid_argument("fps must be a number or (numerator, "
+                                        "denominator)");
+        }
+        rate = {pair[0], pair[1]};
+    }
+    else
+    {
+        return fps.cast<double>();
+    }
+    if (rate.num <= 0 || rate.den <= 0)
+    {
+        throw std::invalid_argument("fps must be positive");
+    }
+    return av_q2d(rate);
+}
+
+// Builds the encoder settings shared by VideoWriter and Transcoder
+celux::Encoder::Options
+parseEncoder(const std::string& preset, const std::string& tune,
+             const std::string& rateControl, int64_t bitrate,
+             std::optional<int> quality, int gopSize, int bFrames,
+             const std::optional<std::map<std::string, std::string>>& codecOptions)
+{
+    celux::Encoder::Options encoder;
+    encoder.preset = preset;
+    encoder.tune = tune;
+    encoder.rateControl = rateControl;
+    encoder.bitrate = bitrate;
+    encoder.quality = quality.value_or(-1);
+    encoder.gopSize = gopSize;
+    encoder.maxBFrames = bFrames;
+    if (codecOptions)
+    {
+        encoder.codecOptions = *codecOptions;
+    }
+    return encoder;
+}
+
+// A str or os.PathLike names a file; anything else is read or written through
+// custom IO
+std::optional<std::string> parsePath(const py::object& path)
+{
+    if (py::isinstance<py::str>(path))
+    {
+        return path.cast<std::string>();
+    }
+    if (py::hasattr(path, "__fspath__"))
+    {
+        return py::module_::import("os").attr("fspath")(path).cast<std::string>();
+    }
+    return std::nullopt;
+}
+} // namespace
+
 PYBIND11_MODULE(celux, m)
 {
+    // FFmpeg's messages follow celux's level, silent unless enabled
+    celux::Logger::installFFmpegCallback();
+
     // VideoReader bindings
     // VideoReader bindings
     py::class_<VideoReader>(m, "VideoReader")
-        .def(py::init<const std::string&, const std::string&, const std::string&>(),
+        .def(py::init(
+                 [](const py::object& input, const std::string& device,
+                    const std::string& dType, int prefetch, int batchSize,
+                    int poolSize, const std::string& indexCache,
+                    bool exactFrameCount, int decoderThreads,
+                    const std::string& threadType, int extraHwFrames,
+                    const std::string& layout,
+                    const std::optional<std::vector<float>>& mean,
+                    const std::optional<std::vector<float>>& stddev,
+                    int conversionThreads,
+                    const std::optional<std::vector<int>>& resize,
+                    const std::optional<std::vector<int>>& crop,
+                    const std::string& interpolation,
+                    const std::optional<std::vector<int>>& hwResize,
+                    const std::optional<std::vector<int>>& hwCrop,
+                    const py::object& stream, bool shareContext, int ioBufferSize,
+                    const std::string& inputFormat,
+                    const std::optional<std::map<std::string, std::string>>&
+                        formatOptions,
+                    bool skipStreamInfo, int stride, bool keyframesOnly,
+                    bool returnPts, const std::string& outputDevice)
+                 {
+                     VideoReader::Options options;
+                     // In-memory and file-object inputs have no path to report
+                     std::string inputPath;
+                     if (const auto path = parsePath(input))
+                     {
+                         inputPath = *path;
+                     }
+                     else
+                     {
+                         options.decoder.io = inputFromPython(input, ioBufferSize);
+                     }
+                     options.prefetch = prefetch;
+                     options.batchSize = batchSize;
+                     options.poolSize = poolSize;
+                     options.indexCache = indexCache;
+                     options.exactFrameCount = exactFrameCount;
+                     options.decoder.threadCount = decoderThreads;
+                     options.decoder.threadType = parseThreadType(threadType);
+                     options.decoder.extraHwFrames = extraHwFrames;
+                     options.conversion = parseConversion(layout, mean, stddev);
+                     options.conversion.threadCount = conversionThreads;
+                     parseResample(options.conversion, resize, crop,
+                                   interpolation);
+                     celux::Decoder::Options& decoder = options.decoder;
+                     parseSize(hwResize, "hw_resize", decoder.hwResizeWidth,
+                               decoder.hwResizeHeight);
+                     parseCrop(hwCrop, "hw_crop", decoder.hwCropX, decoder.hwCropY,
+                               decoder.hwCropWidth, decoder.hwCropHeight);
+                     options.stream = parseStream(stream);
+                     options.shareDeviceContext = shareContext;
+                     decoder.inputFormat = inputFormat;
+                     if (formatOptions)
+                     {
+                         decoder.formatOptions = *formatOptions;
+                     }
+                     decoder.skipStreamInfo = skipStreamInfo;
+                     decoder.stride = stride;
+                     decoder.keyframesOnly = keyframesOnly;
+                     options.returnPts = returnPts;
+                     options.outputDevice = outputDevice;
+                     return std::make_unique<VideoReader>(inputPath, device, dType,
+                                                          options);
+                 }),
              py::arg("input_path"), py::arg("device") = "cuda",
-             py::arg("d_type") = "uint8")
-        .def("read_frame", &VideoReader::readFrame)
+             py::arg("d_type") = "uint8", py::arg("prefetch") = 0,
+             py::arg("batch_size") = 0, py::arg("pool_size") = 2,
+             py::arg("index_cache") = "", py::arg("exact_frame_count") = false,
+             py::arg("decoder_threads") = 0, py::arg("thread_type") = "auto",
+             py::arg("extra_hw_frames") = 0, py::arg("layout") = "hwc",
+             py::arg("mean") = py::none(), py::arg("std") = py::none(),
+             py::arg("conversion_threads") = 1, py::arg("resize") = py::none(),
+             py::arg("crop") = py::none(), py::arg("interpolation") = "bilinear",
+             py::arg("hw_resize") = py::none(), py::arg("hw_crop") = py::none(),
+             py::arg("stream") = py::none(), py::arg("share_context") = true,
+             py::arg("io_buffer_size") = 64 * 1024, py::arg("input_format") = "",
+             py::arg("format_options") = py::none(),
+             py::arg("skip_stream_info") = false, py::arg("stride") = 1,
+             py::arg("keyframes_only") = false, py::arg("return_pts") = false,
+             py::arg("output_device") = "")
+        .def("read_frame",
+             [](VideoReader& self)
+             { return self.withPts(self.readFrame(), self.getBatchSize() > 0); })
+        .def(
+            "read_batch",
+            [](VideoReader& self, int n)
+            { return self.withPts(self.readBatch(n), true); },
+            py::arg("n"))
+        .def(
+            "get_frames_at",
+            [](VideoReader& self, const std::vector<double>& times)
+            { return self.withPts(self.getFramesAt(times), true); },
+            py::arg("times"))
+        .def("read_raw", &VideoReader::readRaw, py::arg("dlpack") = false)
+        .def("release", &VideoReader::releaseFrame, py::arg("frame"))
         .def("seek", &VideoReader::seek)
+        .def("seek_to_frame", &VideoReader::seekToFrame, py::arg("frame_number"))
         .def("supported_codecs", &VideoReader::supportedCodecs)
         .def("get_properties", &VideoReader::getProperties)
+        .def("stats", &VideoReader::getStats, py::arg("reset") = false)
         .def("__len__", &VideoReader::length)
         .def(
             "__iter__", [](VideoReader& self) -> VideoReader& { return self.iter(); },
             py::return_value_policy::reference_internal)
-        .def("__next__", &VideoReader::next)
+        .def("__next__",
+             [](VideoReader& self)
+             { return self.withPts(self.next(), self.getBatchSize() > 0); })
         .def(
             "__enter__",
             [](VideoReader& self) -> VideoReader&
@@ -58,13 +372,175 @@ PYBIND11_MODULE(celux, m)
             },
             py::return_value_policy::reference_internal);
 
-        // VideoWriter bindings
+        py::class_<VideoReaderPool>(m, "VideoReaderPool")
+        .def(py::init(
+                 [](const std::string& device, const std::string& dType, int workers,
+                    int openDecoders, int decoderThreads, const std::string& threadType,
+                    const std::string& layout,
+                    const std::optional<std::vector<float>>& mean,
+                    const std::optional<std::vector<float>>& stddev,
+                    const std::optional<std::vector<int>>& resize,
+                    const std::optional<std::vector<int>>& crop,
+                    const std::string& interpolation,
+                    const std::optional<std::vector<int>>& hwResize,
+                    const std::optional<std::vector<int>>& hwCrop,
+                    const std::string& indexCache, bool skipStreamInfo,
+                    bool shareContext)
+                 {
+                     VideoReaderPool::Options options;
+                     options.workers = workers;
+                     options.openDecoders = openDecoders;
+                     options.indexCache = indexCache;
+                     options.shareDeviceContext = shareContext;
+                     celux::Decoder::Options& decoder = options.decoder;
+                     if (decoderThreads < 0)
+                     {
+                         throw std::invalid_argument(
+                             "decoder_threads must be 0 (auto) or positive");
+                     }
+                     decoder.threadCount = decoderThreads;
+                     decoder.threadType = parseThreadType(threadType);
+                     decoder.skipStreamInfo = skipStreamInfo;
+                     parseSize(hwResize, "hw_resize", decoder.hwResizeWidth,
+                               decoder.hwResizeHeight);
+                     parseCrop(hwCrop, "hw_crop", decoder.hwCropX, decoder.hwCropY,
+                               decoder.hwCropWidth, decoder.hwCropHeight);
+                     options.conversion = parseConversion(layout, mean, stddev);
+                     parseResample(options.conversion, resize, crop, interpolation);
+                     return std::make_unique<VideoReaderPool>(device, dType, options);
+                 }),
+             py::arg("device") = "cuda", py::arg("d_type") = "uint8",
+             py::arg("workers") = 0, py::arg("open_decoders") = 1,
+             py::arg("decoder_threads") = 1, py::arg("thread_type") = "auto",
+             py::arg("layout") = "hwc", py::arg("mean") = py::none(),
+             py::arg("std") = py::none(), py::arg("resize") = py::none(),
+             py::arg("crop") = py::none(), py::arg("interpolation") = "bilinear",
+             py::arg("hw_resize") = py::none(), py::arg("hw_crop") = py::none(),
+             py::arg("index_cache") = "", py::arg("skip_stream_info") = false,
+             py::arg("share_context") = true)
+        .def(
+            "read_clips",
+            [](VideoReaderPool& self, const py::iterable& requests)
+            {
+                // (path, start, n) per clip; paths may be os.PathLike
+                std::vector<VideoReaderPool::Clip> clips;
+                for (const py::handle& request : requests)
+                {
+                    const auto fields = request.cast<py::sequence>();
+                    if (fields.size() != 3)
+                    {
+                        throw std::invalid_argument(
+                            "Clips must be (path, start, n) tuples");
+                    }
+                    const auto path = parsePath(fields[0]);
+                    if (!path)
+                    {
+                        throw std::invalid_argument("Clip paths must be str or "
+                                                    "os.PathLike");
+                    }
+                    clips.push_back({*path, fields[1].cast<int>(),
+                                     fields[2].cast<int>()});
+                }
+                py::gil_scoped_release release;
+                return self.readClips(clips);
+            },
+            py::arg("clips"))
+        .def_property_readonly("workers", &VideoReaderPool::workerCount)
+        .def("close",
+             [](VideoReaderPool& self)
+             {
+                 py::gil_scoped_release release;
+                 self.close();
+             })
+        .def(
+            "__enter__", [](VideoReaderPool& self) -> VideoReaderPool& { return self; },
+            py::return_value_policy::reference_internal)
+        .def("__exit__",
+             [](VideoReaderPool& self, py::object exc_type, py::object exc_value,
+                py::object traceback)
+             {
+                 py::gil_scoped_release release;
+                 self.close();
+                 return false;
+             });
+
+    // VideoWriter bindings
         py::class_<VideoWriter>(m, "VideoWriter")
-        .def(py::init<const std::string&, int, int, float, const std::string&,
-                      const std::string&>(),
+        .def(py::init(
+                 [](const py::object& output, int width, int height,
+                    const py::object& fps, const std::string& device,
+                    const std::string& dtype, const py::object& stream, int queueSize,
+                    const std::string& codec, const std::string& preset,
+                    const std::string& tune, const std::string& rateControl,
+                    int64_t bitrate, std::optional<int> quality, int gopSize,
+                    int bFrames,
+                    const std::optional<std::map<std::string, std::string>>&
+                        codecOptions,
+                    const std::string& inputFormat, const py::object& audio,
+                    const std::string& container, int ioBufferSize)
+                 {
+                     VideoWriter::Options options;
+                     // A file object is written through custom IO, in the
+                     // container it names
+                     std::string filePath;
+                     std::shared_ptr<celux::IOCallbacks> io;
+                     if (const auto path = parsePath(output))
+                     {
+                         filePath = *path;
+                     }
+                     else if (container.empty())
+                     {
+                         throw std::invalid_argument(
+                             "Writing to a file object needs a container, e.g. "
+                             "container='matroska'");
+                     }
+                     else
+                     {
+                         filePath = container;
+                         io = outputToPython(output, ioBufferSize);
+                     }
+                     const double rate = parseFrameRate(fps, options.frameRate);
+                     options.stream = parseStream(stream);
+                     options.queueSize = queueSize;
+                     options.codec = codec;
+                     options.inputFormat = inputFormat;
+                     options.encoder =
+                         parseEncoder(preset, tune, rateControl, bitrate, quality,
+                                      gopSize, bFrames, codecOptions);
+                     options.encoder.io = io;
+                     // Audio is copied from a file, or from the file a reader has
+                     // open
+                     if (py::isinstance<VideoReader>(audio))
+                     {
+                         options.encoder.audioSource =
+                             audio.cast<const VideoReader&>().getFilePath();
+                         if (options.encoder.audioSource.empty())
+                         {
+                             throw std::invalid_argument(
+                                 "audio takes a reader opened from a path");
+                         }
+                     }
+                     else if (!audio.is_none())
+                     {
+                         options.encoder.audioSource = audio.cast<std::string>();
+                     }
+                     return std::make_unique<VideoWriter>(filePath, width, height, rate,
+                                                          device, dtype, options);
+                 }),
              py::arg("file_path"), py::arg("width"), py::arg("height"), py::arg("fps"),
-             py::arg("device") = "cuda", py::arg("dtype") = "uint8")
+             py::arg("device") = "cuda", py::arg("dtype") = "uint8",
+             py::arg("stream") = py::none(), py::arg("queue_size") = 0,
+             py::arg("codec") = "h264", py::arg("preset") = "", py::arg("tune") = "",
+             py::arg("rate_control") = "", py::arg("bitrate") = 0,
+             py::arg("quality") = py::none(), py::arg("gop_size") = 12,
+             py::arg("b_frames") = 0, py::arg("codec_options") = py::none(),
+             py::arg("input_format") = "rgb", py::arg("audio") = py::none(),
+             py::arg("container") = "", py::arg("io_buffer_size") = 64 * 1024)
         .def("write_frame", &VideoWriter::writeFrame, py::arg("frame"))
+        .def("write_batch", &VideoWriter::writeBatch, py::arg("frames"))
+        .def("flush", &VideoWriter::flush)
+        .def("stats", &VideoWriter::getStats, py::arg("reset") = false)
+        .def("close", &VideoWriter::close)
         .def("supported_codecs", &VideoWriter::supportedCodecs)
         .def("__call__", &VideoWriter::writeFrame, py::arg("frame"))
         .def(
@@ -77,4 +553,114 @@ PYBIND11_MODULE(celux, m)
                  self.close();
                  return false;
              });
+
+    m.def(
+        "remux",
+        [](const std::string& inputPath, const std::string& outputPath,
+           const std::optional<std::vector<int>>& frameRange,
+           const std::optional<std::vector<double>>& timeRange,
+           const std::string& indexCache)
+        {
+            RemuxOptions options;
+            if (frameRange && timeRange)
+            {
+                throw std::invalid_argument("Pass frame_range or time_range, not both");
+            }
+            if (frameRange)
+            {
+                if (frameRange->size() != 2)
+                {
+                    throw std::invalid_argument("frame_range must be (start, end)");
+                }
+                options.startFrame = (*frameRange)[0];
+                options.endFrame = (*frameRange)[1];
+            }
+            if (timeRange)
+            {
+                if (timeRange->size() != 2 || (*timeRange)[0] < 0.0)
+                {
+                    throw std::invalid_argument(
+                        "time_range must be (start, end) in seconds");
+                }
+                options.startTime = (*timeRange)[0];
+                options.endTime = (*timeRange)[1];
+            }
+            options.indexCache = indexCache;
+            py::gil_scoped_release release;
+            return remux(inputPath, outputPath, options);
+        },
+        py::arg("input_path"), py::arg("output_path"),
+        py::arg("frame_range") = py::none(), py::arg("time_range") = py::none(),
+        py::arg("index_cache") = "",
+        "Copy the video stream into a new container without re-encoding, cut on "
+        "keyframes. Returns the copied (start, end) frame range.");
+
+    m.def(
+        "set_log_level",
+        [](const std::string& level)
+        { celux::Logger::setLevel(celux::Logger::parseLevel(level)); },
+        py::arg("level"),
+        "Set the level of celux's and FFmpeg's messages on stderr: 'debug', "
+        "'info', 'warning', 'error' or 'off' (the default).");
+    m.def(
+        "get_log_level",
+        []() { return celux::Logger::levelName(celux::Logger::level()); },
+        "Return the current log level.");
+    m.def("set_log_rate_limit", &celux::Logger::setRateLimit, py::arg("per_second"),
+          "Limit the messages written per second, 0 for no limit (default 100).");
+
+    // Transcoder bindings
+    py::class_<Transcoder>(m, "Transcoder")
+        .def(py::init(
+                 [](const std::string& inputPath, const std::string& outputPath,
+                    const std::string& device, const std::string& codec,
+                    const py::object& fps,
+                    const std::optional<std::vector<int>>& resize,
+                    const std::optional<std::vector<int>>& crop,
+                    const std::string& preset, const std::string& tune,
+                    const std::string& rateControl, int64_t bitrate,
+                    std::optional<int> quality, int gopSize, int bFrames,
+                    const std::optional<std::map<std::string, std::string>>&
+                        codecOptions,
+                    bool audio)
+                 {
+                     Transcoder::Options options;
+                     options.copyAudio = audio;
+                     options.codec = codec;
+                     if (!fps.is_none())
+                     {
+                         options.fps = parseFrameRate(fps, options.frameRate);
+                     }
+                     celux::Decoder::Options& decoder = options.decoder;
+                     parseSize(resize, "resize", decoder.hwResizeWidth,
+                               decoder.hwResizeHeight);
+                     parseCrop(crop, "crop", decoder.hwCropX, decoder.hwCropY,
+                               decoder.hwCropWidth, decoder.hwCropHeight);
+                     options.encoder =
+                         parseEncoder(preset, tune, rateControl, bitrate, quality,
+                                      gopSize, bFrames, codecOptions);
+                     return std::make_unique<Transcoder>(inputPath, outputPath, device,
+                                                         options);
+                 }),
+             py::arg("input_path"), py::arg("output_path"), py::arg("device") = "cuda",
+             py::arg("codec") = "h264", py::arg("fps") = py::none(),
+             py::arg("resize") = py::none(), py::arg("crop") = py::none(),
+             py::arg("preset") = "", py::arg("tune") = "", py::arg("rate_control") = "",
+             py::arg("bitrate") = 0, py::arg("quality") = py::none(),
+             py::arg("gop_size") = 12, py::arg("b_frames") = 0,
+             py::arg("codec_options") = py::none(), py::arg("audio") = true)
+        .def("run", &Transcoder::run, py::arg("callback") = py::none(),
+             py::arg("max_frames") = -1)
+        .def("close", &Transcoder::close)
+        .def("get_properties", &Transcoder::getProperties)
+        .def(
+            "__enter__", [](Transcoder& self) -> Transcoder& { return self; },
+            py::return_value_policy::reference_internal)
+        .def("__exit__",
+             [](Transcoder& self, py::object exc_type, py::object exc_value,
+                py::object traceback)
+             {
+                 self.close();
+                 return false;
+             });
 }
@@ -0,0 +1,122 @@
+#include "Python/FramePool.hpp"
+
+FramePool::FramePool(int size, std::vector<int64_t> shape,
+                     torch::TensorOptions options)
+    : shape(std::move(shape)), options(options),
+      needsFence(options.device().type() != torch::kCPU)
+{
+    if (size < 1)
+    {
+        throw std::invalid_argument("Frame pool size must be at least 1");
+    }
+
+    slots.resize(size);
+    for (auto& slot : slots)
+    {
+        slot.tensor = torch::empty(this->shape, options);
+        // No work has read a new buffer yet, so it needs no fence
+        slot.fenced = true;
+    }
+}
+
+bool FramePool::isFree(size_t index) const
+{
+    const Slot& slot = slots[index];
+    // The pool's own handle is the only reference to the tensor and its storage,
+    // so nothing outside can observe the next write
+    return slot.released ||
+           (slot.tensor.use_count() == 1 && slot.tensor.storage().use_count() == 1);
+}
+
+bool FramePool::isReusable(size_t index) const
+{
+    return isFree(index) && (!needsFence || slots[index].fenced);
+}
+
+torch::Tensor FramePool::acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Start after the last handed-out slot so buffers are reused round-robin
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        const size_t index = (nextSlot + i) % slots.size();
+        if (isReusable(index))
+        {
+            slots[index].released = false;
+            slots[index].fenced = false;
+            nextSlot = index + 1;
+            return slots[index].tensor;
+        }
+    }
+
+    ++fallbacks;
+    return torch::empty(shape, options);
+}
+
+bool FramePool::release(const torch::Tensor& tensor)
+{
+    if (!tensor.defined())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& slot : slots)
+    {
+        if (slot.tensor.storage().is_alias_of(tensor.storage()))
+        {
+            slot.released = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FramePool::fence(const std::function<void()>& order)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!needsFence)
+    {
+        order();
+        return;
+    }
+
+    // Buffers dropped after this scan may be read by work queued after `order`
+    // runs, so they wait for the next fence
+    std::vector<size_t> freed;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (!slots[i].fenced && isFree(i))
+        {
+            freed.push_back(i);
+        }
+    }
+    order();
+    for (size_t index : freed)
+    {
+        slots[index].fenced = true;
+    }
+}
+
+int FramePool::size() const
+{
+    return static_cast<int>(slots.size());
+}
+
+int FramePool::available() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = 0;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        count += isReusable(i) ? 1 : 0;
+    }
+    return count;
+}
+
+int64_t FramePool::fallbackAllocations() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallbacks;
+}
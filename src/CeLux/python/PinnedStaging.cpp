@@ -0,0 +1,160 @@
+#include "Python/PinnedStaging.hpp"
+
+#ifdef CUDA_ENABLED
+#include <c10/cuda/CUDAGuard.h>
+
+PinnedStaging::PinnedStaging(int slots, std::vector<int64_t> shape,
+                             torch::ScalarType dtype, torch::Device device,
+                             void* stream)
+    : deviceIndex(device.index()), copyStream(static_cast<cudaStream_t>(stream))
+{
+    if (slots < 1)
+    {
+        throw std::invalid_argument("Staging needs at least one pinned frame");
+    }
+    const c10::cuda::CUDAGuard deviceGuard(deviceIndex);
+    try
+    {
+        if (!copyStream)
+        {
+            // Non-blocking, so copies don't serialize with the legacy default
+            // stream that other work may be queued on
+            if (cudaStreamCreateWithFlags(&copyStream, cudaStreamNonBlocking) !=
+                cudaSuccess)
+            {
+                throw std::runtime_error("Failed to create CUDA stream");
+            }
+            ownsStream = true;
+        }
+        if (cudaEventCreateWithFlags(&uploaded, cudaEventDisableTiming) !=
+                cudaSuccess ||
+            cudaEventCreateWithFlags(&consumed, cudaEventDisableTiming) != cudaSuccess)
+        {
+            throw std::runtime_error("Failed to create CUDA events");
+        }
+
+        const torch::TensorOptions hostOptions =
+            torch::TensorOptions().dtype(dtype).pinned_memory(true);
+        this->slots.resize(slots);
+        for (Slot& slot : this->slots)
+        {
+            slot.host = torch::empty(shape, hostOptions);
+            if (cudaEventCreateWithFlags(&slot.copied, cudaEventDisableTiming) !=
+                cudaSuccess)
+            {
+                throw std::runtime_error("Failed to create CUDA events");
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
+}
+
+PinnedStaging::~PinnedStaging()
+{
+    // Copies still reading the pinned frames must finish before they are freed
+    if (copyStream)
+    {
+        cudaStreamSynchronize(copyStream);
+    }
+    destroy();
+}
+
+void PinnedStaging::destroy()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.copied)
+        {
+            cudaEventDestroy(slot.copied);
+            slot.copied = nullptr;
+        }
+    }
+    if (uploaded)
+    {
+        cudaEventDestroy(uploaded);
+        uploaded = nullptr;
+    }
+    if (consumed)
+    {
+        cudaEventDestroy(consumed);
+        consumed = nullptr;
+    }
+    if (copyStream && ownsStream)
+    {
+        cudaStreamDestroy(copyStream);
+    }
+    copyStream = nullptr;
+}
+
+void* PinnedStaging::next()
+{
+    Slot& slot = slots[current];
+    if (slot.pending)
+    {
+        // Only this slot's copy; later ones keep running while the CPU converts
+        if (cudaEventSynchronize(slot.copied) != cudaSuccess)
+        {
+            throw std::runtime_error("Failed to wait for a host-to-device copy");
+        }
+        slot.pending = false;
+    }
+    return slot.host.data_ptr();
+}
+
+void PinnedStaging::upload(const torch::Tensor& output)
+{
+    Slot& slot = slots[current];
+    if (!output.is_cuda() || !output.is_contiguous() ||
+        output.nbytes() != slot.host.nbytes())
+    {
+        throw std::invalid_argument(
+            "Staged frames must be copied into contiguous device tensors of the "
+            "same size");
+    }
+    const c10::cuda::CUDAGuard deviceGuard(deviceIndex);
+    if (cudaMemcpyAsync(output.data_ptr(), slot.host.data_ptr(), slot.host.nbytes(),
+                        cudaMemcpyHostToDevice, copyStream) != cudaSuccess ||
+        cudaEventRecord(slot.copied, copyStream) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to queue a host-to-device copy");
+    }
+    slot.pending = true;
+    current = (current + 1) % slots.size();
+}
+
+void PinnedStaging::orderBefore(void* stream)
+{
+    streamWait(static_cast<cudaStream_t>(stream), copyStream, uploaded);
+}
+
+void PinnedStaging::orderAfter(void* stream)
+{
+    streamWait(copyStream, static_cast<cudaStream_t>(stream), consumed);
+}
+
+void PinnedStaging::synchronize()
+{
+    if (cudaStreamSynchronize(copyStream) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to synchronize CUDA stream");
+    }
+}
+
+void PinnedStaging::streamWait(cudaStream_t to, cudaStream_t from, cudaEvent_t event)
+{
+    if (to == from)
+    {
+        return;
+    }
+    if (cudaEventRecord(event, from) != cudaSuccess ||
+        cudaStreamWaitEvent(to, event, 0) != cudaSuccess)
+    {
+        throw std::runtime_error("Failed to order CUDA streams");
+    }
+}
+
+#endif // CUDA_ENABLED
@@ -0,0 +1,208 @@
+#include "Python/PyIO.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// Python state the callbacks share. The callbacks may be destroyed on a thread
+// that doesn't hold the GIL, so the references are dropped under it.
+struct PyFile
+{
+    py::object file;
+    Py_buffer view{}; // Bytes-like sources only
+    bool hasView = false;
+    int64_t position = 0;
+
+    ~PyFile()
+    {
+        py::gil_scoped_acquire acquire;
+        if (hasView)
+        {
+            PyBuffer_Release(&view);
+        }
+        file = py::object();
+    }
+};
+
+// Calls into Python under the GIL. FFmpeg can only see an error code, so an
+// exception is reported here and read as an I/O error.
+template <typename Fn> auto callPython(const char* what, Fn&& fn) -> decltype(fn())
+{
+    py::gil_scoped_acquire acquire;
+    try
+    {
+        return fn();
+    }
+    catch (py::error_already_set& error)
+    {
+        error.discard_as_unraisable(what);
+    }
+    catch (const std::exception& ex)
+    {
+        CELUX_ERROR(what << ": " << ex.what());
+    }
+    return AVERROR(EIO);
+}
+
+bool isSeekable(const py::object& file)
+{
+    return py::hasattr(file, "seekable") && file.attr("seekable")().cast<bool>() &&
+           py::hasattr(file, "tell");
+}
+
+// fseek on a Python file object, plus AVSEEK_SIZE; Python's whence values are
+// the same as SEEK_SET, SEEK_CUR and SEEK_END
+int64_t seekFile(const std::shared_ptr<PyFile>& state, int64_t offset, int whence)
+{
+    return callPython("celux seek callback",
+                      [&]() -> int64_t
+                      {
+                          py::object file = state->file;
+                          if (whence == AVSEEK_SIZE)
+                          {
+                              const int64_t position =
+                                  file.attr("tell")().cast<int64_t>();
+                              const int64_t end =
+                                  file.attr("seek")(0, SEEK_END).cast<int64_t>();
+                              file.attr("seek")(position, SEEK_SET);
+                              return end;
+                          }
+                          return file.attr("seek")(offset, whence).cast<int64_t>();
+                      });
+}
+} // namespace
+
+std::shared_ptr<celux::IOCallbacks> inputFromPython(const py::object& source,
+                                                    int bufferSize)
+{
+    auto callbacks = std::make_shared<celux::IOCallbacks>();
+    callbacks->bufferSize = bufferSize;
+    auto state = std::make_shared<PyFile>();
+    state->file = source;
+
+    if (PyObject_CheckBuffer(source.ptr()))
+    {
+        // Read in place; the view keeps the object's memory from moving, and
+        // fails for memory that isn't contiguous
+        if (PyObject_GetBuffer(source.ptr(), &state->view, PyBUF_SIMPLE) != 0)
+        {
+            throw py::error_already_set();
+        }
+        state->hasView = true;
+
+        callbacks->read = [state](uint8_t* buffer, int size)
+        {
+            const auto* data = static_cast<const uint8_t*>(state->view.buf);
+            const int count = static_cast<int>(
+                std::min<int64_t>(size, state->view.len - state->position));
+            std::memcpy(buffer, data + state->position, count);
+            state->position += count;
+            return count;
+        };
+        callbacks->seek = [state](int64_t offset, int whence) -> int64_t
+        {
+            int64_t target = 0;
+            switch (whence)
+            {
+            case AVSEEK_SIZE:
+                return state->view.len;
+            case SEEK_SET:
+                target = offset;
+                break;
+            case SEEK_CUR:
+                target = state->position + offset;
+                break;
+            case SEEK_END:
+                target = state->view.len + offset;
+                break;
+            default:
+                return AVERROR(EINVAL);
+            }
+            if (target < 0 || target > state->view.len)
+            {
+                return AVERROR(EINVAL);
+            }
+            return state->position = target;
+        };
+        return callbacks;
+    }
+
+    if (!py::hasattr(source, "read"))
+    {
+        throw std::invalid_argument(
+            "Input must be a path, a bytes-like object or a binary file object");
+    }
+    if (py::hasattr(source, "readinto"))
+    {
+        // Straight into FFmpeg's buffer, without an intermediate bytes object
+        callbacks->read = [state](uint8_t* buffer, int size)
+        {
+            return callPython("celux read callback",
+                              [&]
+                              {
+                                  py::object count = state->file.attr("readinto")(
+                                      py::memoryview::from_memory(buffer, size));
+                                  // None: a non-blocking stream has nothing yet
+                                  return count.is_none() ? AVERROR(EAGAIN)
+                                                         : count.cast<int>();
+                              });
+        };
+    }
+    else
+    {
+        callbacks->read = [state](uint8_t* buffer, int size)
+        {
+            return callPython("celux read callback",
+                              [&]
+                              {
+                                  py::object chunk = state->file.attr("read")(size);
+                                  if (chunk.is_none())
+                                  {
+                                      return AVERROR(EAGAIN);
+                                  }
+                                  const std::string bytes = chunk.cast<py::bytes>();
+                                  const int count = static_cast<int>(
+                                      std::min<size_t>(bytes.size(), size));
+                                  std::memcpy(buffer, bytes.data(), count);
+                                  return count;
+                              });
+        };
+    }
+    if (isSeekable(source))
+    {
+        callbacks->seek = [state](int64_t offset, int whence)
+        { return seekFile(state, offset, whence); };
+    }
+    return callbacks;
+}
+
+std::shared_ptr<celux::IOCallbacks> outputToPython(const py::object& sink,
+                                                   int bufferSize)
+{
+    if (!py::hasattr(sink, "write"))
+    {
+        throw std::invalid_argument("Output must be a path or a binary file object");
+    }
+    auto callbacks = std::make_shared<celux::IOCallbacks>();
+    callbacks->bufferSize = bufferSize;
+    auto state = std::make_shared<PyFile>();
+    state->file = sink;
+
+    callbacks->write = [state](const uint8_t* buffer, int size)
+    {
+        return callPython("celux write callback",
+                          [&]
+                          {
+                              // A copy, since the file may keep what it is given
+                              const auto* bytes = reinterpret_cast<const char*>(buffer);
+                              state->file.attr("write")(py::bytes(bytes, size));
+                              return size;
+                          });
+    };
+    if (isSeekable(sink))
+    {
+        callbacks->seek = [state](int64_t offset, int whence)
+        { return seekFile(state, offset, whence); };
+    }
+    return callbacks;
+}
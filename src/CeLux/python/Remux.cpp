@@ -0,0 +1,93 @@
+#include "Python/Remux.hpp"
+
+using namespace celux::error;
+
+std::pair<int, int> remux(const std::string& inputPath, const std::string& outputPath,
+                          const RemuxOptions& options)
+{
+    // Only the demuxer and the seek index are used; decoding never starts
+    celux::Decoder::Options decoderOptions;
+    decoderOptions.threadCount = 1;
+    auto decoder = celux::Factory::createDecoder(celux::backend::CPU, inputPath,
+                                                 nullptr, decoderOptions);
+    if (!options.indexCache.empty())
+    {
+        decoder->setSeekIndexCache(options.indexCache);
+    }
+    const celux::SeekIndex& index = decoder->getSeekIndex();
+    const AVStream* source = decoder->getVideoStream();
+    if (!index.isValid())
+    {
+        throw CxException("Stream copy needs timestamps to cut on: " + inputPath);
+    }
+
+    const int frameCount = index.frameCount();
+    int startFrame = options.startFrame;
+    int endFrame = options.endFrame < 0 ? frameCount : options.endFrame;
+    // Times map to frames as in get_frames_at: the frame on screen at the start
+    // is the first copied, the one on screen at the end the first left out
+    if (options.startTime >= 0.0)
+    {
+        startFrame = decoder->frameAtTime(options.startTime);
+    }
+    if (options.endTime >= 0.0)
+    {
+        const int frame = decoder->frameAtTime(options.endTime);
+        endFrame = frame < 0 ? frameCount : frame; // Past the end of the video
+    }
+    endFrame = std::min(endFrame, frameCount);
+    if (startFrame < 0 || startFrame >= endFrame)
+    {
+        throw std::invalid_argument("Empty or invalid range [" +
+                                    std::to_string(startFrame) + ", " +
+                                    std::to_string(endFrame) + ") for a video of " +
+                                    std::to_string(frameCount) + " frames");
+    }
+
+    const int firstFrame = decoder->seekToKeyframe(startFrame);
+    if (firstFrame < 0)
+    {
+        throw CxException("Could not seek to frame " + std::to_string(startFrame));
+    }
+    const int64_t endPts =
+        endFrame < frameCount ? index.framePts(endFrame) : INT64_MAX;
+
+    celux::Encoder muxer(nullptr);
+    muxer.openCopy(outputPath, source);
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet)
+    {
+        throw CxException("Could not allocate AVPacket");
+    }
+    int lastFrame = frameCount;
+    bool started = false;
+    try
+    {
+        while (decoder->readPacket(packet))
+        {
+            const bool keyframe = packet->flags & AV_PKT_FLAG_KEY;
+            // A demuxer may land a few packets early; the clip opens on a keyframe
+            started = started || keyframe;
+            if (!started)
+            {
+                continue;
+            }
+            if (keyframe && packet->pts != AV_NOPTS_VALUE && packet->pts >= endPts)
+            {
+                lastFrame = index.frameAt(packet->pts);
+                break;
+            }
+            muxer.writePacket(packet, source->time_base);
+        }
+        av_packet_free(&packet);
+    }
+    catch (...)
+    {
+        av_packet_free(&packet);
+        throw;
+    }
+
+    muxer.close();
+    return {firstFrame, lastFrame};
+}
@@ -0,0 +1,225 @@
+#include "Python/Transcoder.hpp"
+#include "Python/CudaDevice.hpp"
+#include "Python/PlaneTensor.hpp"
+#include "Python/VideoWriter.hpp"
+#ifdef CUDA_ENABLED
+#include <c10/cuda/CUDAStream.h>
+#endif // CUDA_ENABLED
+
+namespace
+{
+// Surfaces NVENC may hold on to beyond its B-frames while later frames decode
+constexpr int HeldHwFrames = 8;
+} // namespace
+
+Transcoder::Transcoder(const std::string& inputPath, const std::string& outputPath,
+                       const std::string& device, const Options& options)
+    : torchDevice(torch::kCPU)
+{
+    celux::backend backend;
+    if (isCudaDevice(device))
+    {
+        backend = celux::backend::CUDA;
+        torchDevice = parseCudaDevice(device);
+    }
+    else if (device == "cpu")
+    {
+        backend = celux::backend::CPU;
+    }
+    else
+    {
+        throw std::invalid_argument("Unsupported device: " + device);
+    }
+    if (backend != celux::backend::CUDA && options.decoder.hwScales())
+    {
+        throw std::invalid_argument("resize and crop require device='cuda'");
+    }
+
+    const c10::DeviceGuard deviceGuard(torchDevice);
+
+    // Decoder and encoder share one device context, so NVENC can read the NVDEC
+    // surfaces. Frames NVENC still references are not back in the decoder's
+    // pool yet, so the pool gets room for them.
+    celux::Decoder::Options decoderOptions = options.decoder;
+    celux::Encoder::Options encoderOptions = options.encoder;
+    if (backend == celux::backend::CUDA)
+    {
+        decoderOptions.hwDevice = torchDevice.index();
+        encoderOptions.hwDevice = torchDevice.index();
+        decoderOptions.extraHwFrames +=
+            HeldHwFrames + std::max(encoderOptions.maxBFrames, 0);
+    }
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA)
+    {
+        AVBufferRef* shared =
+            celux::backends::gpu::cuda::sharedDeviceContext(torchDevice.index());
+        if (!decoderOptions.hwDeviceCtx)
+        {
+            decoderOptions.hwDeviceCtx = shared;
+        }
+        if (!encoderOptions.hwDeviceCtx)
+        {
+            encoderOptions.hwDeviceCtx = decoderOptions.hwDeviceCtx;
+        }
+    }
+#endif // CUDA_ENABLED
+
+    decoder =
+        celux::Factory::createDecoder(backend, inputPath, nullptr, decoderOptions);
+    const celux::Decoder::VideoProperties source = decoder->getVideoProperties();
+
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(source.pixelFormat);
+    if (backend == celux::backend::CUDA &&
+        (!desc || desc->comp[0].depth > 8 || desc->log2_chroma_w != 1 ||
+         desc->log2_chroma_h != 1))
+    {
+        throw std::invalid_argument(
+            std::string("Transcoding on cuda takes 8-bit 4:2:0 sources, got ") +
+            (desc ? desc->name : "unknown"));
+    }
+
+    celux::Encoder::VideoProperties props;
+    props.width = width = source.width;
+    props.height = height = source.height;
+    props.fps = fps = options.fps > 0.0 ? options.fps : source.fps;
+    props.frameRate = options.frameRate;
+    // NVENC takes the NV12 surfaces; on CPU the encoder picks the format closest
+    // to the decoder's
+    props.pixelFormat =
+        backend == celux::backend::CUDA ? AV_PIX_FMT_NV12 : source.pixelFormat;
+    props.codecName =
+        VideoWriter::encoderName(options.codec, backend == celux::backend::CUDA);
+
+    if (options.copyAudio && source.hasAudio && encoderOptions.audioSource.empty())
+    {
+        encoderOptions.audioSource = inputPath;
+    }
+
+    // Used only for NV12 frames returned by a callback
+    auto convert = celux::Factory::createConverter(
+        backend, celux::ConversionType::NV12ToNV12, celux::dataType::UINT8);
+    encoder = celux::Factory::createEncoder(backend, outputPath, props,
+                                            std::move(convert), encoderOptions);
+}
+
+Transcoder::~Transcoder()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& ex)
+    {
+        CELUX_ERROR("Exception while closing Transcoder: " << ex.what());
+    }
+}
+
+int Transcoder::run(const py::object& callback, int maxFrames)
+{
+    if (!decoder)
+    {
+        throw std::runtime_error("Transcoder is closed");
+    }
+    const c10::DeviceGuard deviceGuard(torchDevice);
+    const bool processed = !callback.is_none();
+
+    int written = 0;
+    py::gil_scoped_release release;
+    while (maxFrames < 0 || written < maxFrames)
+    {
+        if (!decoder->decodeNextRawFrame(frame))
+        {
+            break;
+        }
+        if (processed)
+        {
+            py::gil_scoped_acquire acquire;
+            process(callback);
+        }
+        else
+        {
+            encoder->encodeRawFrame(frame);
+        }
+        // Let the decoder reuse the surface once the encoder releases it
+        av_frame_unref(frame.get());
+        ++written;
+    }
+    return written;
+}
+
+void Transcoder::process(const py::object& callback)
+{
+    const AVFrame* av = frame.get();
+    AVPixelFormat format = static_cast<AVPixelFormat>(av->format);
+    if (format == AV_PIX_FMT_CUDA)
+    {
+        // The planes are device pointers laid out as the surface's software format
+        auto* framesCtx = reinterpret_cast<AVHWFramesContext*>(av->hw_frames_ctx->data);
+        format = framesCtx->sw_format;
+    }
+    py::tuple planes(av_pix_fmt_count_planes(format));
+    for (size_t plane = 0; plane < planes.size(); ++plane)
+    {
+        planes[plane] = py::cast(wrapPlane(av, format, static_cast<int>(plane),
+                                           torchDevice));
+    }
+    py::object result = callback(*planes);
+
+    torch::Tensor nv12;
+    if (!result.is_none())
+    {
+        nv12 = result.cast<torch::Tensor>();
+        if (nv12.sizes() != c10::IntArrayRef({height * 3 / 2, width}) ||
+            nv12.scalar_type() != torch::kUInt8)
+        {
+            throw std::invalid_argument(
+                "The callback must return None or a uint8 [" +
+                std::to_string(height * 3 / 2) + ", " + std::to_string(width) +
+                "] NV12 tensor, got " + c10::str(nv12.sizes()));
+        }
+        nv12 = nv12.to(torchDevice).contiguous();
+    }
+
+#ifdef CUDA_ENABLED
+    // NVENC and the input copy read the frame outside torch's streams
+    if (torchDevice.is_cuda())
+    {
+        c10::cuda::getCurrentCUDAStream(torchDevice.index()).synchronize();
+    }
+#endif // CUDA_ENABLED
+
+    py::gil_scoped_release release;
+    if (!nv12.defined())
+    {
+        encoder->encodeRawFrame(frame);
+    }
+    else if (!encoder->encodeFrame(nv12.data_ptr()))
+    {
+        throw std::runtime_error("Failed to encode frame");
+    }
+}
+
+void Transcoder::close()
+{
+    if (!decoder)
+    {
+        return;
+    }
+    const c10::DeviceGuard deviceGuard(torchDevice);
+    av_frame_unref(frame.get());
+    // Frames NVENC still holds reference the decoder's pool, so the encoder goes
+    // first
+    std::unique_ptr<celux::Decoder> source = std::move(decoder);
+    encoder->close();
+    encoder.reset();
+}
+
+py::dict Transcoder::getProperties() const
+{
+    py::dict props;
+    props["width"] = width;
+    props["height"] = height;
+    props["fps"] = fps;
+    return props;
+}
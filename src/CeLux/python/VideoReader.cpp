@@ -1,32 +1,54 @@
 #include "Python/VideoReader.hpp"
+#include "Python/CudaDevice.hpp"
+#include "Python/PlaneTensor.hpp"
+#include "Python/PyStats.hpp"
+#include <ATen/DLConvertor.h>
+#include <cmath>
+#include <numeric>
 #include <pybind11/pybind11.h>
+#ifdef CUDA_ENABLED
+#include <c10/cuda/CUDAStream.h>
+#endif // CUDA_ENABLED
 
 namespace py = pybind11;
+
+namespace
+{
+void deleteUnusedCapsule(PyObject* capsule)
+{
+    // Consumers rename the capsule once they take ownership of the tensor
+    if (PyCapsule_IsValid(capsule, "dltensor"))
+    {
+        auto* managed =
+            static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+        if (managed && managed->deleter)
+        {
+            managed->deleter(managed);
+        }
+    }
+}
+
+// Pinned frames per reader staging CPU frames for a GPU: one being converted,
+// one being copied and one to spare for a copy that runs late
+constexpr int StagingFrames = 3;
+} // namespace
 VideoReader::VideoReader(const std::string& filePath, const std::string& device,
-                         const std::string& dataType)
-    : decoder(nullptr), currentIndex(0), start_frame(0), end_frame(-1),
-      torchDevice(torch::kCPU)
+                         const std::string& dataType, const Options& options)
+    : decoder(nullptr), filePath(filePath), currentIndex(0), start_frame(0),
+      end_frame(-1), torchDevice(torch::kCPU), outputDevice(torch::kCPU),
+      batchSize(std::max(options.batchSize, 0)), poolSize(options.poolSize),
+      stride(std::max(options.decoder.stride, 1)),
+      keyframesOnly(options.decoder.keyframesOnly), returnPts(options.returnPts),
+      prefetchDepth(std::max(options.prefetch, 0))
 {
     try
     {
         // Determine the backend enum from the device string
         celux::backend backend;
-        if (device == "cuda")
+        if (isCudaDevice(device))
         {
-            if (!torch::cuda::is_available())
-            {
-                throw std::runtime_error("CUDA is not available. Please install a "
-                                         "CUDA-enabled version of celux.");
-            }
-            if (torch::cuda::device_count() == 0)
-            {
-                throw std::runtime_error(
-                    "No CUDA devices found. Please check your CUDA installation.");
-            }
-          
-            torchDevice = torch::kCUDA;
             backend = celux::backend::CUDA;
-            torchDevice = torch::Device(torch::kCUDA);
+            torchDevice = parseCudaDevice(device);
         }
         else if (device == "cpu")
         {
@@ -39,70 +61,146 @@ VideoReader::VideoReader(const std::string& filePath, const std::string& device,
             throw std::invalid_argument("Unsupported device: " + device);
         }
 
+        // CPU-decoded frames may be returned on a GPU; CUDA-decoded ones stay put
+        outputDevice = torchDevice;
+        if (options.outputDevice == "cpu")
+        {
+            outputDevice = torch::Device(torch::kCPU);
+        }
+        else if (!options.outputDevice.empty())
+        {
+            if (!isCudaDevice(options.outputDevice))
+            {
+                throw std::invalid_argument("Unsupported output_device: " +
+                                            options.outputDevice);
+            }
+            outputDevice = parseCudaDevice(options.outputDevice);
+        }
+        if (backend == celux::backend::CUDA && outputDevice != torchDevice)
+        {
+            throw std::invalid_argument(
+                "output_device must be the decode device when device='cuda'");
+        }
+#ifndef CUDA_ENABLED
+        if (outputDevice.is_cuda())
+        {
+            throw std::invalid_argument(
+                "output_device='cuda' requires a CUDA-enabled build of celux");
+        }
+#endif // CUDA_ENABLED
+
         // Map dataType string to celux::dataType enum and torch::Dtype
-        celux::dataType dtype;
         torch::Dtype torchDataType;
+        const celux::dataType dtype = parseDataType(dataType, torchDataType);
 
-        if (dataType == "uint8")
+        if (options.decoder.threadCount < 0)
         {
-            torchDataType = torch::kUInt8;
-            dtype = celux::dataType::UINT8;
+            throw std::invalid_argument("decoder_threads must be 0 (auto) or positive");
         }
-        else if (dataType == "float32")
+        if (options.conversion.threadCount < 0)
         {
-            torchDataType = torch::kFloat32;
-            dtype = celux::dataType::FLOAT32;
+            throw std::invalid_argument(
+                "conversion_threads must be 0 (auto) or positive");
         }
-        else if (dataType == "float16")
+        if (backend != celux::backend::CUDA && options.decoder.hwScales())
         {
-            torchDataType = torch::kFloat16;
-            dtype = celux::dataType::FLOAT16;
+            throw std::invalid_argument("hw_resize and hw_crop require device='cuda'");
         }
-        else
+        if (!outputDevice.is_cuda() && options.stream)
         {
-            throw std::invalid_argument("Unsupported dataType: " + dataType);
+            throw std::invalid_argument(
+                "stream requires device='cuda' or output_device='cuda'");
         }
 
+        // The converter's stream and kernels belong to the current CUDA device
+        const c10::DeviceGuard deviceGuard(outputDevice);
+
+        celux::Decoder::Options decoderOptions = options.decoder;
+        decoderOptions.hwDevice = torchDevice.is_cuda() ? torchDevice.index() : 0;
+#ifdef CUDA_ENABLED
+        if (backend == celux::backend::CUDA && options.shareDeviceContext &&
+            !decoderOptions.hwDeviceCtx)
+        {
+            decoderOptions.hwDeviceCtx = celux::backends::gpu::cuda::sharedDeviceContext(
+                decoderOptions.hwDevice);
+        }
+#endif // CUDA_ENABLED
+
+        // Create the decoder using the factory. The converter depends on the
+        // stream's bit depth, so it is attached once the stream is open.
+        decoder = celux::Factory::createDecoder(backend, filePath, nullptr,
+                                                decoderOptions);
+
         // Create the converter using the factory
         convert = celux::Factory::createConverter(
-            backend, celux::ConversionType::NV12ToRGB, dtype);
+            backend,
+            conversionFor(backend, decoder->getVideoProperties().pixelFormat, dtype),
+            dtype, options.stream);
+        convert->setOptions(options.conversion);
+        planar = options.conversion.planar;
+        decoder->setConverter(std::move(convert));
 
-        // Create the decoder using the factory
-        decoder = celux::Factory::createDecoder(backend, filePath, std::move(convert));
+        if (!options.indexCache.empty())
+        {
+            decoder->setSeekIndexCache(options.indexCache);
+        }
+        if (options.exactFrameCount)
+        {
+            decoder->countFrames();
+        }
 
         // Retrieve video properties
         properties = decoder->getVideoProperties();
+        timeBase = decoder->getVideoStream()->time_base;
+
+        // Frames come out at the crop/resize size when one is requested
+        const celux::conversion::ResampleParams geometry =
+            options.conversion.resampleFor(properties.width, properties.height);
+        outputWidth = geometry.outputWidth;
+        outputHeight = geometry.outputHeight;
 
-        // Initialize tensors based on backend and data type
-        if (backend == celux::backend::CUDA)
+        // The converter writes straight into the tensors handed back to Python
+        // when they are on the decode device, so no staging copy is needed.
+        outputOptions =
+            torch::TensorOptions().dtype(torchDataType).device(outputDevice);
+#ifdef CUDA_ENABLED
+        if (outputDevice != torchDevice)
         {
-            RGBTensor = torch::empty(
-                {properties.height, properties.width, 3},
-                torch::TensorOptions().dtype(torchDataType).device(torch::kCUDA));
+            staging = std::make_unique<PinnedStaging>(StagingFrames, frameShape(),
+                                                      torchDataType, outputDevice,
+                                                      options.stream);
+        }
+#endif // CUDA_ENABLED
 
-            // For CUDA, cpuTensor is not used. You might want to remove it or keep it
-            // for CPU operations. If keeping, initialize it on CPU.
-            cpuTensor = torch::empty(
-                {properties.height, properties.width, 3},
-                torch::TensorOptions().dtype(torchDataType).device(torch::kCUDA));
+        // Frames queued (and the one being decoded) by the decode-ahead worker
+        // also come from the pool, so reserve room for them on top of what the
+        // caller asked to hold.
+        if (options.poolSize < 1)
+        {
+            throw std::invalid_argument("pool_size must be at least 1");
         }
-        else // CPU
+        framePool = std::make_unique<FramePool>(
+            options.poolSize + (prefetchDepth > 0 ? prefetchDepth + 1 : 0),
+            frameShape(),
+            outputOptions);
+
+        if (this->batchSize > 0)
         {
-            // For CPU, initialize cpuTensor on CPU
-            cpuTensor = torch::empty(
-                {properties.height, properties.width, 3},
-                torch::TensorOptions().dtype(torchDataType).device(torch::kCPU));
+            batchPool = std::make_unique<FramePool>(
+                options.poolSize, frameShape(this->batchSize), outputOptions);
+            batchFrames = this->batchSize;
+        }
 
-            // RGBTensor is not used on CPU. You might want to remove it or keep it for
-            // GPU operations. If keeping, initialize it on CUDA.
-            RGBTensor = torch::empty(
-                {properties.height, properties.width, 3},
-                torch::TensorOptions().dtype(torchDataType).device(torch::kCPU));
+        if (prefetchDepth > 0)
+        {
+            readyFrames =
+                std::make_unique<celux::SPSCQueue<DecodedFrame>>(prefetchDepth);
+            startPrefetch();
         }
     }
     catch (const std::exception& ex)
     {
-        std::cerr << "Exception in VideoReader constructor: " << ex.what() << std::endl;
+        CELUX_ERROR("Exception in VideoReader constructor: " << ex.what());
         throw; // Re-throw exception after logging
     }
 }
@@ -112,8 +210,60 @@ VideoReader::~VideoReader()
     close();
 }
 
+celux::dataType VideoReader::parseDataType(const std::string& name,
+                                           torch::Dtype& torchType)
+{
+    if (name == "uint8")
+    {
+        torchType = torch::kUInt8;
+        return celux::dataType::UINT8;
+    }
+    if (name == "uint16")
+    {
+        torchType = torch::kUInt16;
+        return celux::dataType::UINT16;
+    }
+    if (name == "float32")
+    {
+        torchType = torch::kFloat32;
+        return celux::dataType::FLOAT32;
+    }
+    if (name == "float16")
+    {
+        torchType = torch::kFloat16;
+        return celux::dataType::FLOAT16;
+    }
+    throw std::invalid_argument("Unsupported dataType: " + name);
+}
+
+celux::ConversionType VideoReader::conversionFor(celux::backend backend,
+                                                 AVPixelFormat pixelFormat,
+                                                 celux::dataType dtype)
+{
+    // NVDEC delivers 10-bit and deeper streams as P010/P016 surfaces
+    const AVPixFmtDescriptor* sourceDesc = av_pix_fmt_desc_get(pixelFormat);
+    const bool highBitDepth = sourceDesc && sourceDesc->comp[0].depth > 8;
+    if (backend == celux::backend::CUDA && highBitDepth)
+    {
+        return celux::ConversionType::P010ToRGB;
+    }
+    if (dtype == celux::dataType::UINT16)
+    {
+        throw std::invalid_argument(
+            "uint16 output requires a 10-bit or deeper source decoded on cuda");
+    }
+    return celux::ConversionType::NV12ToRGB;
+}
+
 void VideoReader::setRange(int start, int end)
 {
+    if (keyframesOnly)
+    {
+        throw std::invalid_argument(
+            "Frame ranges can't be combined with keyframes_only, which doesn't "
+            "track frame numbers");
+    }
+
     // Handle negative indices by converting them to positive frame numbers
     if (start < 0)
         start = properties.totalFrames + start;
@@ -140,6 +290,8 @@ void VideoReader::setRange(int start, int end)
 
 void VideoReader::close()
 {
+    stopPrefetch();
+    const c10::DeviceGuard deviceGuard(outputDevice);
     if (convert)
     {
         convert->synchronize();
@@ -150,27 +302,147 @@ void VideoReader::close()
         decoder->close(); // Assuming Decoder has a close method
         decoder.reset();
     }
+#ifdef CUDA_ENABLED
+    staging.reset(); // Waits for the copies still reading its frames
+#endif // CUDA_ENABLED
+}
+
+void VideoReader::startPrefetch()
+{
+    if (prefetchDepth <= 0 || !decoder || prefetchThread.joinable())
+    {
+        return;
+    }
+
+    readyFrames->reset();
+    prefetchError = nullptr;
+
+    prefetchThread = std::thread(&VideoReader::prefetchLoop, this);
+}
+
+void VideoReader::stopPrefetch()
+{
+    if (!prefetchThread.joinable())
+    {
+        return;
+    }
+
+    readyFrames->close();
+    if (PyGILState_Check())
+    {
+        py::gil_scoped_release release;
+        prefetchThread.join();
+    }
+    else
+    {
+        prefetchThread.join();
+    }
+
+    // Give frames decoded past the stop point back to the pool
+    DecodedFrame discarded;
+    while (readyFrames->tryPop(discarded))
+    {
+    }
+}
+
+void VideoReader::prefetchLoop()
+{
+    try
+    {
+        // The current device is per thread
+        const c10::DeviceGuard deviceGuard(outputDevice);
+        while (!readyFrames->isClosed())
+        {
+            torch::Tensor output = framePool->acquire();
+            if (!decodeInto(output))
+            {
+                break; // End of stream
+            }
+            // The consumer orders its stream after the conversion when it pops
+            // the frame, and fences the pool so acquire() only hands back
+            // frames whose last reads are ordered before this conversion, see
+            // readFrame()
+            if (!readyFrames->push({std::move(output), decoder->lastFramePts()}))
+            {
+                break; // Stopped while waiting for the consumer
+            }
+        }
+    }
+    catch (...)
+    {
+        prefetchError = std::current_exception();
+    }
+
+    // Lets the consumer drain what was decoded and then observe end of stream
+    readyFrames->close();
 }
 
 torch::Tensor VideoReader::readFrame()
 {
+    if (batchSize > 0)
+    {
+        return readBatch(batchSize);
+    }
+
+    if (prefetchDepth > 0)
+    {
+        DecodedFrame decoded;
+        bool received;
+        {
+            py::gil_scoped_release release;
+            received = readyFrames->pop(decoded);
+        }
+
+        if (!received)
+        {
+            if (prefetchError)
+            {
+                std::exception_ptr error = prefetchError;
+                prefetchError = nullptr;
+                std::rethrow_exception(error);
+            }
+            throw py::stop_iteration();
+        }
+
+        // Conversions run on the converter's stream. This also waits for any
+        // frames decoded ahead of this one, which are queued on the same stream.
+        void* stream = consumerStream();
+        orderBefore(stream);
+        // Frames dropped so far may still be read by work queued on the caller's
+        // stream; the worker only reuses them once it is ordered after that work
+        framePool->fence([&] { orderAfter(stream); });
+        returnedPts.assign(1, decoded.pts);
+        resumePts = decoded.pts;
+        return std::move(decoded.tensor);
+    }
+
     int result;
+    const c10::DeviceGuard deviceGuard(outputDevice);
+
+    torch::Tensor output;
+    void* stream = consumerStream();
 
     // Release GIL during decoding
     {
         py::gil_scoped_release release;
-        result = decoder->decodeNextFrame(RGBTensor.data_ptr());
+        // Kernels queued before Python dropped a buffer may still read it. Only
+        // returns a buffer Python no longer holds, so earlier frames stay valid.
+        framePool->fence([&] { orderAfter(stream); });
+        output = framePool->acquire();
+        result = decodeInto(output);
+        if (result == 1)
+        {
+            // Work the caller queues next sees the finished frame
+            orderBefore(stream);
+            returnedPts.assign(1, decoder->lastFramePts());
+            resumePts = returnedPts[0];
+        }
     }
 
     if (result == 1) // Frame decoded successfully
     {
-        // No need to acquire GIL for tensor operations if they don't interact with
-        // Python
-
-        // Acquire GIL before returning tensor to Pytho
-        cpuTensor.copy_(RGBTensor, /*non_blocking=*/true);
         py::gil_scoped_acquire acquire;
-        return cpuTensor;
+        return output;
     }
     else if (result == 0) // End of video stream
     {
@@ -186,17 +458,234 @@ torch::Tensor VideoReader::readFrame()
     }
 }
 
+torch::Tensor VideoReader::readBatch(int n)
+{
+    if (n <= 0)
+    {
+        throw std::invalid_argument("Batch size must be positive");
+    }
+
+    // Batches are pooled like single frames, so a batch the caller still holds
+    // is never overwritten by the next read
+    if (!batchPool || batchFrames != n)
+    {
+        batchPool = std::make_unique<FramePool>(poolSize, frameShape(n),
+                                                outputOptions);
+    }
+    batchFrames = n;
+
+    int count = 0;
+    const c10::DeviceGuard deviceGuard(outputDevice);
+    void* stream = consumerStream();
+    returnedPts.clear();
+    torch::Tensor batch;
+    {
+        py::gil_scoped_release release;
+        // Dropped batches may still be read by the caller's stream
+        batchPool->fence([&] { orderAfter(stream); });
+        batch = batchPool->acquire();
+        if (prefetchDepth > 0)
+        {
+            // Frames were already decoded ahead; move them into the batch. The
+            // copies run on the caller's stream, ordered after each conversion,
+            // and the worker may only reuse a frame once its copy is done.
+            DecodedFrame decoded;
+            while (count < n && readyFrames->pop(decoded))
+            {
+                orderBefore(stream);
+                batch[count].copy_(decoded.tensor);
+                returnedPts.push_back(decoded.pts);
+                // Back to the pool, reused once the worker is ordered after the copy
+                decoded.tensor = torch::Tensor();
+                framePool->fence([&] { orderAfter(stream); });
+                ++count;
+            }
+        }
+        else
+        {
+            while (count < n && decodeInto(batch[count]))
+            {
+                returnedPts.push_back(decoder->lastFramePts());
+                ++count;
+            }
+            orderBefore(stream);
+        }
+    }
+
+    if (count == 0)
+    {
+        if (prefetchError)
+        {
+            std::exception_ptr error = prefetchError;
+            prefetchError = nullptr;
+            std::rethrow_exception(error);
+        }
+        throw py::stop_iteration();
+    }
+
+    resumePts = returnedPts.back();
+    return count == n ? batch : batch.narrow(0, 0, count);
+}
+
+void* VideoReader::consumerStream() const
+{
+#ifdef CUDA_ENABLED
+    if (outputDevice.is_cuda())
+    {
+        return c10::cuda::getCurrentCUDAStream(outputDevice.index()).stream();
+    }
+#endif // CUDA_ENABLED
+    return nullptr;
+}
+
+bool VideoReader::decodeInto(const torch::Tensor& output)
+{
+#ifdef CUDA_ENABLED
+    if (staging)
+    {
+        // The CPU converter fills a pinned frame, copied while the next decodes
+        if (!decoder->decodeNextFrame(staging->next()))
+        {
+            return false;
+        }
+        celux::Stats::Scope scope(decoder->getStats(), celux::Stats::Stage::Transfer);
+        staging->upload(output);
+        return true;
+    }
+#endif // CUDA_ENABLED
+    return decoder->decodeNextFrame(output.data_ptr());
+}
+
+void VideoReader::orderBefore(void* stream)
+{
+    decoder->orderBefore(stream);
+#ifdef CUDA_ENABLED
+    if (staging)
+    {
+        staging->orderBefore(stream);
+    }
+#endif // CUDA_ENABLED
+}
+
+void VideoReader::orderAfter(void* stream)
+{
+    decoder->orderAfter(stream);
+#ifdef CUDA_ENABLED
+    if (staging)
+    {
+        staging->orderAfter(stream);
+    }
+#endif // CUDA_ENABLED
+}
+
+std::vector<int64_t> VideoReader::frameShape(int64_t batch) const
+{
+    std::vector<int64_t> shape;
+    if (batch > 0)
+    {
+        shape.push_back(batch);
+    }
+    if (planar)
+    {
+        shape.insert(shape.end(), {3, outputHeight, outputWidth});
+    }
+    else
+    {
+        shape.insert(shape.end(), {outputHeight, outputWidth, 3});
+    }
+    return shape;
+}
+
+py::list VideoReader::readRaw(bool dlpack)
+{
+    if (prefetchDepth > 0)
+    {
+        throw std::runtime_error("read_raw cannot be combined with prefetch");
+    }
+
+    bool received;
+    {
+        py::gil_scoped_release release;
+        received = decoder->decodeNextRawFrame(rawFrame);
+    }
+    if (!received)
+    {
+        throw py::stop_iteration();
+    }
+    // Track the position like readFrame() and next(), so later index reads and
+    // restorePosition() continue after this frame
+    returnedPts.assign(1, decoder->lastFramePts());
+    resumePts = returnedPts[0];
+    currentIndex += stride;
+
+    const AVFrame* av = rawFrame.get();
+    AVPixelFormat format = static_cast<AVPixelFormat>(av->format);
+    torch::Device planeDevice(torch::kCPU);
+    if (format == AV_PIX_FMT_CUDA)
+    {
+        // The planes are device pointers laid out as the surface's software format
+        auto* framesCtx = reinterpret_cast<AVHWFramesContext*>(av->hw_frames_ctx->data);
+        format = framesCtx->sw_format;
+        planeDevice = torchDevice;
+    }
+
+    py::list planes;
+    const int planeCount = av_pix_fmt_count_planes(format);
+    for (int plane = 0; plane < planeCount; ++plane)
+    {
+        torch::Tensor tensor = wrapPlane(av, format, plane, planeDevice);
+        if (dlpack)
+        {
+            PyObject* capsule =
+                PyCapsule_New(at::toDLPack(tensor), "dltensor", deleteUnusedCapsule);
+            if (!capsule)
+            {
+                throw py::error_already_set();
+            }
+            planes.append(py::reinterpret_steal<py::object>(capsule));
+        }
+        else
+        {
+            planes.append(tensor);
+        }
+    }
+
+    // The planes hold their own references; let the decoder reuse the surface
+    // as soon as they are released
+    av_frame_unref(rawFrame.get());
+    return planes;
+}
+
+bool VideoReader::releaseFrame(const torch::Tensor& frame)
+{
+    return (framePool && framePool->release(frame)) ||
+           (batchPool && batchPool->release(frame));
+}
 
 bool VideoReader::seek(double timestamp)
 {
     bool success;
 
+    // The worker owns the decoder while running
+    stopPrefetch();
+
     // Release GIL during seeking
     {
         py::gil_scoped_release release;
         success = decoder->seek(timestamp);
+        if (success)
+        {
+            resumePts = AV_NOPTS_VALUE;
+            resumeTime = timestamp;
+        }
+        else if (prefetchDepth > 0)
+        {
+            // The frames decoded ahead were discarded with the worker
+            restorePosition();
+        }
     }
 
+    startPrefetch();
     return success;
 }
 
@@ -205,6 +694,11 @@ std::vector<std::string> VideoReader::supportedCodecs()
     return decoder->listSupportedDecoders();
 }
 
+const std::string& VideoReader::getFilePath() const
+{
+    return filePath;
+}
+
 py::dict VideoReader::getProperties() const
 {
     py::dict props;
@@ -215,9 +709,201 @@ py::dict VideoReader::getProperties() const
     props["total_frames"] = properties.totalFrames;
     props["pixel_format"] = av_get_pix_fmt_name(properties.pixelFormat);
     props["has_audio"] = properties.hasAudio;
+    props["time_base"] = py::make_tuple(timeBase.num, timeBase.den);
     return props;
 }
 
+py::dict VideoReader::getStats(bool reset)
+{
+    if (!decoder)
+    {
+        throw std::runtime_error("VideoReader is closed");
+    }
+    py::dict stats = statsToDict(decoder->getStats(), reset);
+    stats["queue_depth"] = readyFrames ? readyFrames->size() : 0;
+    return stats;
+}
+
+int VideoReader::getBatchSize() const
+{
+    return batchSize;
+}
+
+py::object VideoReader::withPts(const torch::Tensor& frames, bool batched) const
+{
+    if (!returnPts)
+    {
+        return py::cast(frames);
+    }
+    const double unit = av_q2d(timeBase);
+    if (!batched)
+    {
+        // An empty frame past the end has no PTS either
+        const int64_t pts = returnedPts.empty() || frames.numel() == 0
+                                ? AV_NOPTS_VALUE
+                                : returnedPts[0];
+        if (pts == AV_NOPTS_VALUE)
+        {
+            return py::make_tuple(frames, py::none(), py::none());
+        }
+        return py::make_tuple(frames, pts * unit, pts);
+    }
+    torch::Tensor ticks =
+        torch::tensor(c10::ArrayRef<int64_t>(returnedPts), torch::kInt64);
+    torch::Tensor seconds = ticks.to(torch::kFloat64) * unit;
+    seconds.masked_fill_(ticks == AV_NOPTS_VALUE, std::nan(""));
+    return py::make_tuple(frames, seconds, ticks);
+}
+
+torch::Tensor VideoReader::getFramesAt(const std::vector<double>& times)
+{
+    if (keyframesOnly)
+    {
+        throw std::invalid_argument("get_frames_at can't be combined with "
+                                    "keyframes_only");
+    }
+    if (times.empty())
+    {
+        // frameShape(0) has no batch dimension
+        std::vector<int64_t> shape = frameShape();
+        shape.insert(shape.begin(), 0);
+        returnedPts.clear();
+        return torch::empty(shape, outputOptions);
+    }
+
+    // The worker owns the decoder while running
+    stopPrefetch();
+    const c10::DeviceGuard deviceGuard(outputDevice);
+
+    std::vector<int> frames(times.size());
+    {
+        // The first lookup may scan the file to build the index
+        py::gil_scoped_release release;
+        const bool indexed = decoder->getSeekIndex().isValid();
+        for (size_t i = 0; indexed && i < times.size(); ++i)
+        {
+            frames[i] = decoder->frameAtTime(times[i]);
+        }
+        if (!indexed)
+        {
+            // The scan left the demuxer at the end of the input
+            restorePosition();
+            py::gil_scoped_acquire acquire;
+            startPrefetch();
+            throw std::runtime_error(
+                "get_frames_at needs a stream with timestamps to index");
+        }
+    }
+    for (size_t i = 0; i < times.size(); ++i)
+    {
+        if (frames[i] < 0)
+        {
+            {
+                py::gil_scoped_release release;
+                restorePosition();
+            }
+            startPrefetch();
+            throw std::out_of_range("Time " + std::to_string(times[i]) +
+                                    " is outside the video");
+        }
+    }
+
+    // Decoded in presentation order; seekToFrame() decodes forward within a GOP
+    // and only seeks to reach a later one
+    std::vector<size_t> order(times.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return frames[a] < frames[b]; });
+
+    torch::Tensor output = torch::empty(frameShape(times.size()), outputOptions);
+    returnedPts.assign(times.size(), AV_NOPTS_VALUE);
+    std::vector<std::pair<size_t, size_t>> repeats; // (copy, of)
+    void* stream = consumerStream();
+    int last = -1;
+    int failed = -1;
+    {
+        py::gil_scoped_release release;
+        // The new tensor's memory may be freed work of the caller's stream
+        orderAfter(stream);
+        size_t source = 0;
+        for (size_t k : order)
+        {
+            if (frames[k] == last)
+            {
+                repeats.emplace_back(k, source);
+                returnedPts[k] = returnedPts[source];
+                continue;
+            }
+            if (!decoder->seekToFrame(frames[k]) ||
+                !decodeInto(output[k]))
+            {
+                failed = frames[k];
+                break;
+            }
+            returnedPts[k] = decoder->lastFramePts();
+            last = frames[k];
+            source = k;
+        }
+        if (last >= 0)
+        {
+            resumePts = decoder->lastFramePts();
+        }
+        if (failed >= 0)
+        {
+            // Continue after the last frame decoded, or where reads were
+            restorePosition();
+        }
+        // The copies, like any work the caller queues next, see the conversions
+        orderBefore(stream);
+        for (const auto& [copy, of] : repeats)
+        {
+            output[copy].copy_(output[of]);
+        }
+    }
+
+    if (last >= 0)
+    {
+        currentIndex = last + stride;
+    }
+    startPrefetch();
+    if (failed >= 0)
+    {
+        throw std::runtime_error("Failed to decode frame " + std::to_string(failed));
+    }
+    return output;
+}
+
+void VideoReader::restorePosition()
+{
+    // Best effort: the caller already reports the failure that moved the decoder
+    try
+    {
+        const celux::SeekIndex& index = decoder->getSeekIndex();
+        if (resumePts != AV_NOPTS_VALUE && index.isValid())
+        {
+            // After the last frame returned. Past the end the scan left the
+            // demuxer at the end already, where reads belong.
+            const int next = index.frameAt(resumePts) + (keyframesOnly ? 1 : stride);
+            if (next < index.frameCount())
+            {
+                decoder->seekToFrame(next);
+            }
+        }
+        else if (resumeTime >= 0.0)
+        {
+            decoder->seek(resumeTime);
+        }
+        else
+        {
+            decoder->seekToFrame(currentIndex);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        CELUX_WARNING("Failed to restore the read position: " << ex.what());
+    }
+}
+
 void VideoReader::reset()
 {
     seek(0.0); // Reset to the beginning
@@ -226,21 +912,48 @@ void VideoReader::reset()
 
 bool VideoReader::seekToFrame(int frame_number)
 {
-    if (frame_number < 0 || frame_number >= properties.totalFrames)
+    if (frame_number < 0)
     {
         return false; // Out of range
     }
 
-    // Convert frame number to timestamp in seconds
-    double timestamp = static_cast<double>(frame_number) / properties.fps;
+    bool success;
+
+    // The worker owns the decoder while running
+    stopPrefetch();
+
+    // Release GIL during seeking, which may scan the file on first use
+    {
+        py::gil_scoped_release release;
+        success = decoder->seekToFrame(frame_number);
+        if (!success)
+        {
+            // The index scan and the stopped worker moved the decoder
+            restorePosition();
+        }
+    }
+    if (success)
+    {
+        currentIndex = frame_number;
+        resumePts = AV_NOPTS_VALUE;
+        resumeTime = -1.0;
+    }
 
-    return seek(timestamp);
+    startPrefetch();
+    return success;
 }
 
 VideoReader& VideoReader::iter()
 {
     currentIndex = start_frame;
-    seekToFrame(start_frame);
+    if (start_frame > 0)
+    {
+        seekToFrame(start_frame);
+    }
+    else
+    {
+        seek(0.0); // The first frame needs no index
+    }
     return *this;
 }
 
@@ -251,13 +964,26 @@ VideoReader& VideoReader::iter()
         throw py::stop_iteration(); // Stop iteration if range is exhausted
     }
 
+    if (batchSize > 0)
+    {
+        // Never read past the end of the requested range
+        int n = batchSize;
+        if (end_frame >= 0)
+        {
+            n = std::min(n, (end_frame - currentIndex) / stride + 1);
+        }
+        torch::Tensor batch = readBatch(n);
+        currentIndex += static_cast<int>(batch.size(0)) * stride;
+        return batch;
+    }
+
      torch::Tensor frame = readFrame();
     if (frame.numel() == 0)
     {
         throw py::stop_iteration(); // Stop iteration if no more frames are available
     }
 
-    currentIndex++;
+    currentIndex += stride;
     return frame;
 }
 
@@ -274,17 +1000,27 @@ void VideoReader::exit(const py::object& exc_type, const py::object& exc_value,
 
 int VideoReader::length() const
 {
-    return properties.totalFrames;
+    // Frames returned with a stride; keyframes aren't counted up front
+    return (properties.totalFrames + stride - 1) / stride;
 }
 
 void VideoReader::sync()
 {
+    // Frames are already ordered with the caller's current stream; this only
+    // matters when they are consumed on another stream or read by the host
+    // through a raw pointer
     // Release GIL during synchronization
     {
         py::gil_scoped_release release;
-        if (convert)
+        if (decoder)
+        {
+            decoder->synchronize();
+        }
+#ifdef CUDA_ENABLED
+        if (staging)
         {
-            convert->synchronize();
+            staging->synchronize();
         }
+#endif // CUDA_ENABLED
     }
 }
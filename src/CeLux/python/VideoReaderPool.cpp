@@ -0,0 +1,323 @@
+#include "Python/VideoReaderPool.hpp"
+#include "Python/CudaDevice.hpp"
+#include "Python/VideoReader.hpp"
+#include <algorithm>
+#include <map>
+#ifdef CUDA_ENABLED
+#include <c10/cuda/CUDAStream.h>
+#endif // CUDA_ENABLED
+
+VideoReaderPool::VideoReaderPool(const std::string& device, const std::string& dtype,
+                                 const Options& options)
+    : torchDevice(torch::kCPU), options(options)
+{
+    if (isCudaDevice(device))
+    {
+        backend = celux::backend::CUDA;
+        torchDevice = parseCudaDevice(device);
+    }
+    else if (device == "cpu")
+    {
+        backend = celux::backend::CPU;
+    }
+    else
+    {
+        throw std::invalid_argument("Unsupported device: " + device);
+    }
+    if (backend != celux::backend::CUDA && options.decoder.hwScales())
+    {
+        throw std::invalid_argument("hw_resize and hw_crop require device='cuda'");
+    }
+    if (options.openDecoders < 1)
+    {
+        throw std::invalid_argument("open_decoders must be at least 1");
+    }
+    if (options.workers < 0)
+    {
+        throw std::invalid_argument("workers must be 0 (auto) or positive");
+    }
+
+    torch::Dtype torchType;
+    this->dtype = VideoReader::parseDataType(dtype, torchType);
+    outputOptions = torch::TensorOptions().dtype(torchType).device(torchDevice);
+
+    this->options.decoder.hwDevice = torchDevice.is_cuda() ? torchDevice.index() : 0;
+#ifdef CUDA_ENABLED
+    if (backend == celux::backend::CUDA && options.shareDeviceContext &&
+        !this->options.decoder.hwDeviceCtx)
+    {
+        this->options.decoder.hwDeviceCtx =
+            celux::backends::gpu::cuda::sharedDeviceContext(torchDevice.index());
+    }
+#endif // CUDA_ENABLED
+
+    const int count =
+        options.workers > 0
+            ? options.workers
+            : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        threads.emplace_back(&VideoReaderPool::workerLoop, this);
+    }
+}
+
+VideoReaderPool::~VideoReaderPool()
+{
+    close();
+}
+
+void VideoReaderPool::close()
+{
+    // Workers stop between jobs, so let a running readClips() finish
+    std::lock_guard<std::mutex> call(callMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    threads.clear();
+}
+
+int VideoReaderPool::workerCount() const
+{
+    return static_cast<int>(threads.size());
+}
+
+std::vector<torch::Tensor> VideoReaderPool::readClips(const std::vector<Clip>& clips)
+{
+    std::lock_guard<std::mutex> call(callMutex);
+    if (threads.empty())
+    {
+        throw std::runtime_error("VideoReaderPool is closed");
+    }
+
+    // One job per file, so a file is opened (and read front to back) by a single
+    // worker, until idle workers steal part of it, see workerLoop()
+    std::map<std::string, Group> byPath;
+    for (size_t i = 0; i < clips.size(); ++i)
+    {
+        if (clips[i].start < 0 || clips[i].count < 1)
+        {
+            throw std::invalid_argument("Clip " + std::to_string(i) +
+                                        " needs start >= 0 and n >= 1");
+        }
+        Group& group = byPath[clips[i].path];
+        group.path = clips[i].path;
+        group.clips.push_back(i);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    this->clips = &clips;
+    results.assign(clips.size(), torch::Tensor());
+    groups.clear();
+    for (auto& [path, group] : byPath)
+    {
+        std::sort(group.clips.begin(), group.clips.end(),
+                  [&](size_t a, size_t b) { return clips[a].start < clips[b].start; });
+        group.end = group.clips.size();
+        groups.push_back(std::move(group));
+    }
+    // Files with the most clips first, so the last to finish are short
+    std::stable_sort(groups.begin(), groups.end(),
+                     [](const Group& a, const Group& b)
+                     { return a.clips.size() > b.clips.size(); });
+    nextGroup = 0;
+    pendingGroups = groups.size();
+    error = nullptr;
+    wake.notify_all();
+    done.wait(lock, [this] { return pendingGroups == 0; });
+
+    this->clips = nullptr;
+    groups.clear();
+    nextGroup = 0;
+    std::vector<torch::Tensor> output = std::move(results);
+    results.clear();
+    if (error)
+    {
+        std::exception_ptr failure = error;
+        error = nullptr;
+        std::rethrow_exception(failure);
+    }
+    return output;
+}
+
+VideoReaderPool::Group* VideoReaderPool::stealable()
+{
+    if (nextGroup < groups.size())
+    {
+        return nullptr;
+    }
+    Group* largest = nullptr;
+    for (Group& group : groups)
+    {
+        if (group.end - group.next >= 2 &&
+            (!largest || group.end - group.next > largest->end - largest->next))
+        {
+            largest = &group;
+        }
+    }
+    return largest;
+}
+
+void VideoReaderPool::workerLoop()
+{
+    // The current device is per thread; the decoders are created and freed here
+    const c10::DeviceGuard deviceGuard(torchDevice);
+    std::list<Source> sources; // Most recently used first
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]
+                  { return stopping || nextGroup < groups.size() || stealable(); });
+        if (stopping)
+        {
+            break;
+        }
+        if (Group* victim = stealable())
+        {
+            // Every file is taken: steal the later half of the clips another
+            // worker has yet to read, so one long file doesn't leave this one idle
+            Group tail;
+            tail.path = victim->path;
+            const size_t middle = victim->next + (victim->end - victim->next) / 2;
+            tail.clips.assign(victim->clips.begin() + middle,
+                              victim->clips.begin() + victim->end);
+            tail.end = tail.clips.size();
+            victim->end = middle;
+            groups.push_back(std::move(tail));
+            ++pendingGroups;
+        }
+        Group& group = groups[nextGroup++];
+        lock.unlock();
+        std::exception_ptr failure;
+        try
+        {
+            readGroup(sources, group);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+        lock.lock();
+        if (failure)
+        {
+            // Nothing may steal the clips left behind once the call returns
+            group.end = group.next;
+            if (!error)
+            {
+                error = failure;
+            }
+        }
+        if (--pendingGroups == 0)
+        {
+            done.notify_all();
+        }
+    }
+    lock.unlock();
+    sources.clear();
+}
+
+VideoReaderPool::Source& VideoReaderPool::open(std::list<Source>& sources,
+                                               const std::string& path)
+{
+    auto it = std::find_if(sources.begin(), sources.end(),
+                           [&](const Source& source) { return source.path == path; });
+    if (it != sources.end())
+    {
+        sources.splice(sources.begin(), sources, it);
+        return sources.front();
+    }
+
+    // Make room before opening, so no more than openDecoders are ever open
+    while (static_cast<int>(sources.size()) >= options.openDecoders)
+    {
+        sources.pop_back();
+    }
+
+    Source source;
+    source.path = path;
+    source.decoder =
+        celux::Factory::createDecoder(backend, path, nullptr, options.decoder);
+    const celux::Decoder::VideoProperties props = source.decoder->getVideoProperties();
+    // Each file gets its own converter, which depends on its bit depth
+    auto convert = celux::Factory::createConverter(
+        backend, VideoReader::conversionFor(backend, props.pixelFormat, dtype), dtype);
+    convert->setOptions(options.conversion);
+    source.decoder->setConverter(std::move(convert));
+    if (!options.indexCache.empty())
+    {
+        source.decoder->setSeekIndexCache(options.indexCache);
+    }
+
+    const celux::conversion::ResampleParams geometry =
+        options.conversion.resampleFor(props.width, props.height);
+    if (options.conversion.planar)
+    {
+        source.frameShape = {3, geometry.outputHeight, geometry.outputWidth};
+    }
+    else
+    {
+        source.frameShape = {geometry.outputHeight, geometry.outputWidth, 3};
+    }
+    sources.push_front(std::move(source));
+    return sources.front();
+}
+
+void VideoReaderPool::readGroup(std::list<Source>& sources, Group& group)
+{
+    Source& source = open(sources, group.path);
+    while (true)
+    {
+        // Other workers may take the clips not read yet, see workerLoop()
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (group.next >= group.end)
+            {
+                break;
+            }
+            index = group.clips[group.next++];
+        }
+        const Clip& clip = (*clips)[index];
+        if (clip.start != source.nextFrame)
+        {
+            if (!source.decoder->seekToFrame(clip.start))
+            {
+                source.nextFrame = -1; // Unknown after a failed seek
+                throw std::out_of_range("Frame " + std::to_string(clip.start) +
+                                        " is outside " + clip.path);
+            }
+        }
+
+        std::vector<int64_t> shape = source.frameShape;
+        shape.insert(shape.begin(), clip.count);
+        torch::Tensor output = torch::empty(shape, outputOptions);
+#ifdef CUDA_ENABLED
+        if (torchDevice.is_cuda())
+        {
+            // The new tensor's memory may be freed work of this thread's stream
+            source.decoder->orderAfter(
+                c10::cuda::getCurrentCUDAStream(torchDevice.index()).stream());
+        }
+#endif // CUDA_ENABLED
+        int count = 0;
+        while (count < clip.count &&
+               source.decoder->decodeNextFrame(output[count].data_ptr()))
+        {
+            ++count;
+        }
+        source.nextFrame = clip.start + count;
+        results[index] = count == clip.count ? output : output.narrow(0, 0, count);
+    }
+    // Returned tensors may be read on any stream
+    source.decoder->synchronize();
+}
@@ -1,42 +1,48 @@
 
 #include "Python/VideoWriter.hpp"
+#include "Python/CudaDevice.hpp"
+#include "Python/PyStats.hpp"
 #include <Factory.hpp>
 #include <torch/extension.h>
+#ifdef CUDA_ENABLED
+#include <c10/cuda/CUDAStream.h>
+#endif // CUDA_ENABLED
 
-VideoWriter::VideoWriter(const std::string& filePath, int width, int height, float fps,
-                         const std::string& device, const std::string& dataType)
-    : encoder(nullptr)
+std::string VideoWriter::encoderName(const std::string& codec, bool cuda)
+{
+    const std::string name = codec.empty() ? "h264" : codec;
+    if (cuda && (name == "h264" || name == "hevc" || name == "av1"))
+    {
+        return name + "_nvenc";
+    }
+    // On CPU a codec name picks FFmpeg's default encoder for it (e.g. libx264)
+    return name;
+}
+
+VideoWriter::VideoWriter(const std::string& filePath, int width, int height, double fps,
+                         const std::string& device, const std::string& dataType,
+                         const Options& options)
+    : encoder(nullptr), torchDevice(torch::kCPU), width(width), height(height)
 {
     try
     {
-        std::cout << "Creating VideoWriter\n" << std::endl;
         celux::Encoder::VideoProperties props;
         props.width = width;
         props.height = height;
         props.fps = fps;
+        props.frameRate = options.frameRate;
         props.pixelFormat = AV_PIX_FMT_NV12;
         // Determine the backend enum from the device string
         celux::backend backend;
-        if (device == "cuda")
+        if (isCudaDevice(device))
         {
-            props.codecName = "h264_nvenc";
-            if (!torch::cuda::is_available())
-            {
-                throw std::runtime_error("CUDA is not available. Please install a "
-                                         "CUDA-enabled version of celux.");
-            }
-            if (torch::cuda::device_count() == 0)
-            {
-                throw std::runtime_error(
-                    "No CUDA devices found. Please check your CUDA installation.");
-            }
-
+            props.codecName = encoderName(options.codec, true);
             backend = celux::backend::CUDA;
+            torchDevice = parseCudaDevice(device);
         }
         else if (device == "cpu")
         {
-
-            props.codecName = "h264";
+            props.codecName = encoderName(options.codec, false);
             backend = celux::backend::CPU;
         }
         else
@@ -67,25 +73,88 @@ VideoWriter::VideoWriter(const std::string& filePath, int width, int height, flo
         {
             throw std::invalid_argument("Unsupported dataType: " + dataType);
         }
-        std::cout << "Creating encoder\n" << std::endl;
+        inputType = torchDataType;
+
+        // NV12 input is copied into the encoder's frames without a conversion
+        celux::ConversionType conversion;
+        if (options.inputFormat.empty() || options.inputFormat == "rgb")
+        {
+            conversion = celux::ConversionType::RGBToNV12;
+        }
+        else if (options.inputFormat == "bgr")
+        {
+            conversion = celux::ConversionType::BGRToNV12;
+        }
+        else if (options.inputFormat == "nv12")
+        {
+            if (dtype != celux::dataType::UINT8)
+            {
+                throw std::invalid_argument("nv12 input must be uint8");
+            }
+            if (width % 2 != 0 || height % 2 != 0)
+            {
+                throw std::invalid_argument(
+                    "nv12 input needs an even width and height");
+            }
+            conversion = celux::ConversionType::NV12ToNV12;
+            nv12Input = true;
+        }
+        else
+        {
+            throw std::invalid_argument("Unsupported input_format: " +
+                                        options.inputFormat +
+                                        " (expected 'rgb', 'bgr' or 'nv12')");
+        }
+        // The converter's stream and kernels belong to the current CUDA device
+        const c10::DeviceGuard deviceGuard(torchDevice);
         // Create the converter using the factory
         convert = celux::Factory::createConverter(
-            backend, celux::ConversionType::RGBToNV12, dtype);
-        std::cout << "Converter created\n" << std::endl;
+            backend, conversion, dtype, options.stream);
+
+        // Encode in the context shared with readers on the primary CUDA context
+        celux::Encoder::Options encoderOptions = options.encoder;
+        encoderOptions.hwDevice = torchDevice.is_cuda() ? torchDevice.index() : 0;
+#ifdef CUDA_ENABLED
+        if (backend == celux::backend::CUDA && !encoderOptions.hwDeviceCtx)
+        {
+            encoderOptions.hwDeviceCtx =
+                celux::backends::gpu::cuda::sharedDeviceContext(torchDevice.index());
+        }
+#endif // CUDA_ENABLED
+        encoder = celux::Factory::createEncoder(backend, filePath, props,
+                                                std::move(convert), encoderOptions);
+        CELUX_DEBUG("Created VideoWriter for " << filePath << " on " << device);
 
-      encoder = celux::Factory::createEncoder(backend, filePath, props, std::move(convert));
-      std::cout << "Encoder created\n" << std::endl;
+        const int queueSize = options.queueSize;
+        if (queueSize < 0)
+        {
+            throw std::invalid_argument(
+                "queue_size must be 0 (synchronous) or positive");
+        }
+        if (queueSize > 0)
+        {
+            pendingFrames =
+                std::make_unique<celux::SPSCQueue<torch::Tensor>>(queueSize);
+            writeThread = std::thread(&VideoWriter::writeLoop, this);
+        }
     }
     catch (const std::exception& ex)
     {
-        std::cerr << "Exception in VideoReader constructor: " << ex.what() << std::endl;
+        CELUX_ERROR("Exception in VideoWriter constructor: " << ex.what());
         throw; // Re-throw exception after logging
     }
 }
 
 VideoWriter::~VideoWriter()
 {
-    close();
+    try
+    {
+        close();
+    }
+    catch (const std::exception& ex)
+    {
+        CELUX_ERROR("Exception in VideoWriter destructor: " << ex.what());
+    }
     // cudaFree(npBuffer);
 }
 
@@ -93,24 +162,218 @@ bool VideoWriter::writeFrame(torch::Tensor tensorFrame)
 {
     try
     {
-        std::cout << "Writing frame\n" << std::endl;
-        // If tensor is already on GPU, just get the pointer
-        encoder->encodeFrame(tensorFrame.data_ptr());
+        submit(prepareInput(tensorFrame, false));
+        return true;
+    }
+    catch (const std::exception& ex)
+    {
+        CELUX_ERROR("Exception in writeFrame: " << ex.what());
+        throw; // Re-throw exception after logging
+    }
+}
+
+bool VideoWriter::writeBatch(torch::Tensor frames)
+{
+    try
+    {
+        submit(prepareInput(frames, true));
+        return true;
     }
     catch (const std::exception& ex)
     {
-        std::cerr << "Exception in writeFrame: " << ex.what() << std::endl;
+        CELUX_ERROR("Exception in writeBatch: " << ex.what());
         throw; // Re-throw exception after logging
     }
 }
 
+torch::Tensor VideoWriter::prepareInput(const torch::Tensor& frames,
+                                        bool batch) const
+{
+    // RGB/BGR frames are [H, W, 3], NV12 frames [H * 3 / 2, W]
+    std::vector<int64_t> expected = nv12Input
+                                        ? std::vector<int64_t>{height * 3 / 2, width}
+                                        : std::vector<int64_t>{height, width, 3};
+    if (batch)
+    {
+        expected.insert(expected.begin(), frames.dim() > 0 ? frames.size(0) : 0);
+    }
+    if (frames.sizes() != c10::IntArrayRef(expected))
+    {
+        std::string shape = c10::str(c10::IntArrayRef(expected));
+        if (batch)
+        {
+            shape.replace(1, shape.find(',') - 1, "B");
+        }
+        throw std::invalid_argument("Expected a " + shape + " tensor, got " +
+                                    c10::str(frames.sizes()));
+    }
+    if (frames.scalar_type() != inputType)
+    {
+        throw std::invalid_argument(std::string("Expected ") +
+                                    c10::toString(inputType) + " frames, got " +
+                                    c10::toString(frames.scalar_type()));
+    }
+    // The converter reads packed frames on the writer's device
+    if (frames.device() == torchDevice)
+    {
+        return frames.contiguous();
+    }
+    celux::Stats::Scope timed(encoder->getStats(), celux::Stats::Stage::Transfer);
+    return frames.to(torchDevice).contiguous();
+}
+
+void VideoWriter::submit(torch::Tensor frames)
+{
+    rethrowWriteError();
+    const c10::DeviceGuard deviceGuard(torchDevice);
+    // The conversion must not read the frames before the kernels producing them
+    // on the caller's stream are done
+    encoder->orderAfter(producerStream());
+
+    py::gil_scoped_release release;
+    if (pendingFrames)
+    {
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            ++queuedCount;
+        }
+        if (!pendingFrames->push(std::move(frames)))
+        {
+            // Never queued, so flush() must not wait for it to be written
+            {
+                std::lock_guard<std::mutex> lock(writeMutex);
+                --queuedCount;
+            }
+            framesWritten.notify_all();
+            throw std::runtime_error("VideoWriter is closed");
+        }
+        return;
+    }
+
+    encode(frames);
+}
+
+void VideoWriter::encode(const torch::Tensor& frames)
+{
+    // One frame or a batch of frames, converted back to back
+    const int frameDims = nv12Input ? 2 : 3;
+    const int count =
+        frames.dim() > frameDims ? static_cast<int>(frames.size(0)) : 1;
+    if (count == 0)
+    {
+        return;
+    }
+    if (!encoder->encodeFrames(frames.data_ptr(), count, frames.nbytes() / count))
+    {
+        throw std::runtime_error("Failed to encode frame");
+    }
+}
+
+void VideoWriter::flush()
+{
+    if (pendingFrames)
+    {
+        py::gil_scoped_release release;
+        std::unique_lock<std::mutex> lock(writeMutex);
+        framesWritten.wait(lock, [this] { return writtenCount == queuedCount; });
+    }
+    rethrowWriteError();
+}
+
+void VideoWriter::writeLoop()
+{
+    // The current device is per thread
+    const c10::DeviceGuard deviceGuard(torchDevice);
+
+    torch::Tensor pending;
+    bool failed = false;
+    while (pendingFrames->pop(pending))
+    {
+        try
+        {
+            // After an error the remaining frames are only drained so the producer
+            // and flush() never wait on a frame that will not be written
+            if (!failed)
+            {
+                encode(pending);
+            }
+        }
+        catch (...)
+        {
+            failed = true;
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writeError = std::current_exception();
+        }
+        pending = torch::Tensor(); // The conversion has finished with it
+
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            ++writtenCount;
+        }
+        framesWritten.notify_all();
+    }
+}
+
+void VideoWriter::stopWriter()
+{
+    if (!writeThread.joinable())
+    {
+        return;
+    }
+
+    // Frames already queued are still written before the worker exits
+    pendingFrames->close();
+    if (PyGILState_Check())
+    {
+        py::gil_scoped_release release;
+        writeThread.join();
+    }
+    else
+    {
+        writeThread.join();
+    }
+}
+
+void VideoWriter::rethrowWriteError()
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::swap(error, writeError);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void* VideoWriter::producerStream() const
+{
+#ifdef CUDA_ENABLED
+    if (torchDevice.is_cuda())
+    {
+        return c10::cuda::getCurrentCUDAStream(torchDevice.index()).stream();
+    }
+#endif // CUDA_ENABLED
+    return nullptr;
+}
+
 std::vector<std::string> VideoWriter::supportedCodecs()
 {
     return encoder->listSupportedEncoders();
 }
 
+py::dict VideoWriter::getStats(bool reset)
+{
+    py::dict stats = statsToDict(encoder->getStats(), reset);
+    stats["queue_depth"] = pendingFrames ? pendingFrames->size() : 0;
+    return stats;
+}
+
 void VideoWriter::close()
 {
+    stopWriter();
+    const c10::DeviceGuard deviceGuard(torchDevice);
     if (convert)
     {
         convert->synchronize();
@@ -119,4 +382,6 @@ void VideoWriter::close()
     {
         encoder->close();
     }
+    // Report a failure of the last queued frames, after the file is closed
+    rethrowWriteError();
 }
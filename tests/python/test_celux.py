@@ -1,6 +1,12 @@
+import io
+import os
+import shutil
+import subprocess
+import tempfile
 import unittest
 import celux
 import sys
+import torch
 
 
 class TestVideoReader(unittest.TestCase):
@@ -41,6 +47,456 @@ class TestVideoReader(unittest.TestCase):
         """Test seeking to an invalid timestamp."""
         self.assertFalse(self.reader.seek(-10))
 
+    def test_seek_to_frame(self):
+        """Test that seek_to_frame lands on the exact requested frame."""
+        target = 7
+        for index, frame in enumerate(self.reader):
+            if index == target:
+                expected = frame.clone()
+                break
+        self.assertTrue(self.reader.seek_to_frame(target))
+        self.assertTrue(torch.equal(self.reader.read_frame(), expected))
+
+    def test_seek_to_frame_invalid(self):
+        """Test seeking to a frame number outside the video."""
+        self.assertFalse(self.reader.seek_to_frame(-1))
+
+    def test_read_after_failed_seek_to_frame(self):
+        """Test that a failed seek_to_frame leaves reads where they were."""
+        expected = [f.clone() for _, f in zip(range(4), celux.VideoReader(
+            self.video_path, device="cpu"))]
+        for prefetch in (0, 2):
+            reader = celux.VideoReader(self.video_path, device="cpu",
+                                       prefetch=prefetch)
+            for _ in range(3):
+                reader.read_frame()
+            self.assertFalse(reader.seek_to_frame(len(reader) + 100))
+            self.assertTrue(torch.equal(reader.read_frame(), expected[3]))
+
+    def test_prefetch_matches_synchronous_reads(self):
+        """Test that frames decoded ahead equal the synchronously decoded frames."""
+        expected = [f.clone() for _, f in zip(range(10), celux.VideoReader(
+            self.video_path, device="cpu"))]
+        reader = celux.VideoReader(self.video_path, device="cpu", prefetch=4)
+        frames = [f.clone() for _, f in zip(range(10), reader)]
+        self.assertEqual(len(frames), len(expected))
+        for frame, other in zip(frames, expected):
+            self.assertTrue(torch.equal(frame, other))
+        reader = None
+
+    def test_read_batch_matches_read_frame(self):
+        """Test that batches hold the frames read_frame returns, and stay intact."""
+        expected = [f.clone() for _, f in zip(range(8), celux.VideoReader(
+            self.video_path, device="cpu"))]
+        reader = celux.VideoReader(self.video_path, device="cpu")
+        batch = reader.read_batch(4)
+        self.assertEqual(tuple(batch.shape), (4,) + tuple(expected[0].shape))
+        self.assertTrue(torch.equal(batch, torch.stack(expected[:4])))
+        reader = celux.VideoReader(self.video_path, device="cpu", batch_size=2)
+        # Batches kept across reads are not overwritten by later ones
+        batches = [b for _, b in zip(range(4), reader)]
+        for index, kept in enumerate(batches):
+            first = 2 * index
+            self.assertTrue(torch.equal(kept, torch.stack(expected[first:first + 2])))
+        reader = None
+
+    def test_pool_keeps_referenced_frames(self):
+        """Test that held frames are never overwritten and dropped ones are reused."""
+        reader = celux.VideoReader(self.video_path, device="cpu", pool_size=1)
+        first = reader.read_frame()
+        kept = first.clone()
+        second = reader.read_frame()
+        self.assertNotEqual(second.data_ptr(), first.data_ptr())
+        self.assertTrue(torch.equal(first, kept))
+        pooled = first.data_ptr()
+        first = second = None
+        self.assertEqual(reader.read_frame().data_ptr(), pooled)
+        # Handed back early, the frame is reused while still referenced
+        frame = reader.read_frame()
+        self.assertEqual(frame.data_ptr(), pooled)
+        self.assertTrue(reader.release(frame))
+        self.assertEqual(reader.read_frame().data_ptr(), pooled)
+        self.assertFalse(reader.release(torch.zeros(1)))
+        reader = None
+
+    def test_sidecar_index_cache(self):
+        """Test that the sidecar index is written once and reused on the next open."""
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, os.path.basename(self.video_path))
+            shutil.copyfile(self.video_path, path)
+            reader = celux.VideoReader(path, device="cpu", index_cache="sidecar")
+            expected = [f.clone() for _, f in zip(range(6), reader)]
+            self.assertTrue(reader.seek_to_frame(5))
+            reader = None
+            sidecar = path + ".cxidx"
+            self.assertTrue(os.path.isfile(sidecar))
+            written = os.stat(sidecar).st_mtime_ns
+            reader = celux.VideoReader(path, device="cpu", index_cache="sidecar")
+            self.assertTrue(reader.seek_to_frame(5))
+            self.assertTrue(torch.equal(reader.read_frame(), expected[5]))
+            self.assertEqual(os.stat(sidecar).st_mtime_ns, written)
+            reader = None
+
+    def test_exact_frame_count(self):
+        """Test that the exact frame count matches the frames decoded."""
+        reader = celux.VideoReader(self.video_path, device="cpu",
+                                   exact_frame_count=True)
+        count = reader.get_properties()["total_frames"]
+        self.assertEqual(len(reader), count)
+        self.assertEqual(sum(1 for _ in reader), count)
+        reader = None
+
+    def test_decoder_threading_validation(self):
+        """Test that decoder threading options reject invalid values."""
+        with self.assertRaises(ValueError):
+            celux.VideoReader(self.video_path, device="cpu", decoder_threads=-1)
+        with self.assertRaises(ValueError):
+            celux.VideoReader(self.video_path, device="cpu", thread_type="fiber")
+        reader = celux.VideoReader(self.video_path, device="cpu", decoder_threads=2,
+                                   thread_type="slice")
+        self.assertIsNotNone(reader.read_frame())
+        reader = None
+
+    def test_read_raw_plane_shapes(self):
+        """Test that CPU raw planes have the YUV 4:2:0 plane shapes."""
+        frame = torch.zeros((48, 64, 3), dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mkv")
+            with celux.VideoWriter(path, 64, 48, 30.0, device="cpu",
+                                   codec="mpeg4") as writer:
+                for _ in range(3):
+                    writer.write_frame(frame)
+            reader = celux.VideoReader(path, device="cpu")
+            self.assertEqual(reader.get_properties()["pixel_format"], "yuv420p")
+            planes = reader.read_raw()
+            self.assertEqual([tuple(p.shape) for p in planes],
+                             [(48, 64), (24, 32), (24, 32)])
+            self.assertTrue(all(p.dtype == torch.uint8 for p in planes))
+            # Reads continue after the raw frame
+            self.assertEqual(sum(1 for _ in reader), 2)
+            reader = None
+
+    def test_cpu_yuv420p_and_yuv444p_inputs(self):
+        """Test that YUV 4:2:0 and 4:4:4 videos convert to the colour they hold."""
+        colour = torch.tensor([48, 80, 160], dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "yuv420p.mkv")
+            with celux.VideoWriter(path, 64, 48, 30.0, device="cpu",
+                                   codec="mpeg4") as writer:
+                for _ in range(3):
+                    writer.write_frame(colour.expand(48, 64, 3).contiguous())
+            paths = {"yuv420p": path}
+            # The writer encodes 4:2:0 only; 4:4:4 needs the ffmpeg CLI
+            if shutil.which("ffmpeg"):
+                path = os.path.join(directory, "yuv444p.mkv")
+                subprocess.run(["ffmpeg", "-loglevel", "error", "-f", "lavfi", "-i",
+                                "color=c=0x3050a0:s=64x48:d=0.1", "-pix_fmt",
+                                "yuv444p", "-c:v", "ffv1", path], check=True)
+                paths["yuv444p"] = path
+            for pixel_format, path in paths.items():
+                reader = celux.VideoReader(path, device="cpu")
+                self.assertEqual(reader.get_properties()["pixel_format"],
+                                 pixel_format)
+                frame = reader.read_frame()
+                self.assertEqual(tuple(frame.shape), (48, 64, 3))
+                self.assertLess((frame.float() - colour.float()).abs().max().item(),
+                                10)
+                reader = None
+            if "yuv444p" not in paths:
+                self.skipTest("ffmpeg is not available to encode a 4:4:4 video")
+
+    def test_conversion_threads_match_single_thread(self):
+        """Test that banded conversion gives byte-identical frames."""
+        for d_type in ("uint8", "float32"):
+            single = celux.VideoReader(self.video_path, device="cpu", d_type=d_type)
+            banded = celux.VideoReader(self.video_path, device="cpu", d_type=d_type,
+                                       conversion_threads=4)
+            for _, expected, frame in zip(range(5), single, banded):
+                self.assertTrue(torch.equal(frame, expected))
+            single = banded = None
+
+    def test_cpu_float_matches_uint8(self):
+        """Test that CPU float32 frames are the uint8 frames scaled to [0, 1]."""
+        as_uint8 = celux.VideoReader(self.video_path, device="cpu", d_type="uint8")
+        as_float = celux.VideoReader(self.video_path, device="cpu", d_type="float32")
+        expected = as_uint8.read_frame().float() / 255.0
+        frame = as_float.read_frame()
+        self.assertEqual(frame.dtype, torch.float32)
+        self.assertTrue(torch.allclose(frame, expected, atol=1.5 / 255.0))
+
+    def test_crop_and_resize(self):
+        """Test that crop and resize set the shape of returned frames."""
+        reader = celux.VideoReader(self.video_path, device="cpu", resize=(64, 48))
+        self.assertEqual(tuple(reader.read_frame().shape), (48, 64, 3))
+        reader = celux.VideoReader(self.video_path, device="cpu", crop=(2, 4, 32, 16))
+        self.assertEqual(tuple(reader.read_frame().shape), (16, 32, 3))
+
+    def test_stride_and_keyframes_only(self):
+        """Test that stride returns every k-th frame and keyframes decode alone."""
+        reader = celux.VideoReader(self.video_path, device="cpu")
+        frames = [f.clone() for _, f in zip(range(21), reader)]
+        reader = None
+        strided = celux.VideoReader(self.video_path, device="cpu", stride=10)
+        picked = [f.clone() for _, f in zip(range(3), strided)]
+        self.assertEqual(len(strided), (len(self.reader) + 9) // 10)
+        for got, expected in zip(picked, frames[::10]):
+            self.assertTrue(torch.equal(got, expected))
+        strided = None
+        keyframes = celux.VideoReader(self.video_path, device="cpu",
+                                      keyframes_only=True)
+        first = keyframes.read_frame()
+        self.assertTrue(torch.equal(first, frames[0]))
+        keyframes = None
+
+    def test_return_pts_and_get_frames_at(self):
+        """Test that frames come with increasing PTS and can be read by time."""
+        reader = celux.VideoReader(self.video_path, device="cpu", return_pts=True)
+        frames, seconds = [], []
+        for _ in range(12):
+            frame, time, pts = reader.read_frame()
+            frames.append(frame.clone())
+            seconds.append(time)
+        self.assertEqual(seconds, sorted(seconds))
+        self.assertEqual(len(set(seconds)), len(seconds))
+        picked, times, _ = reader.get_frames_at([seconds[10], seconds[2], seconds[10]])
+        self.assertTrue(torch.equal(picked[0], frames[10]))
+        self.assertTrue(torch.equal(picked[1], frames[2]))
+        self.assertTrue(torch.equal(picked[2], frames[10]))
+        self.assertEqual(times.tolist(), [seconds[10], seconds[2], seconds[10]])
+        with self.assertRaises(IndexError):
+            reader.get_frames_at([-1.0])
+        empty, times, pts = reader.get_frames_at([])
+        self.assertEqual(tuple(empty.shape), (0,) + tuple(frames[0].shape))
+        self.assertEqual(len(times), 0)
+        self.assertEqual(len(pts), 0)
+        self.assertTrue(torch.equal(reader.read_frame()[0], frames[11]))
+        # Batches carry the PTS of every frame
+        reader = celux.VideoReader(self.video_path, device="cpu", return_pts=True,
+                                   batch_size=2)
+        for first in (0, 2):
+            batch, times, pts = reader.read_frame()
+            self.assertTrue(torch.equal(batch, torch.stack(frames[first:first + 2])))
+            self.assertEqual(times.tolist(), seconds[first:first + 2])
+            self.assertEqual(len(pts), 2)
+        # The first lookup builds the index; a failed one still continues reads
+        for prefetch in (0, 2):
+            reader = celux.VideoReader(self.video_path, device="cpu",
+                                       prefetch=prefetch)
+            for _ in range(3):
+                reader.read_frame()
+            with self.assertRaises(IndexError):
+                reader.get_frames_at([-1.0])
+            self.assertTrue(torch.equal(reader.read_frame(), frames[3]))
+        reader = None
+
+    def test_reader_pool_reads_clips(self):
+        """Test that pooled clips hold the frames a reader returns for them."""
+        reader = celux.VideoReader(self.video_path, device="cpu")
+        frames = [f.clone() for _, f in zip(range(12), reader)]
+        reader = None
+        with celux.VideoReaderPool(device="cpu", workers=2) as pool:
+            clips = pool.read_clips([(self.video_path, 8, 4), (self.video_path, 0, 3),
+                                     (self.video_path, 3, 2)])
+            with self.assertRaises(IndexError):
+                pool.read_clips([(self.video_path, 10**7, 1)])
+        self.assertEqual([len(c) for c in clips], [4, 3, 2])
+        self.assertTrue(torch.equal(clips[0], torch.stack(frames[8:12])))
+        self.assertTrue(torch.equal(clips[1], torch.stack(frames[0:3])))
+        self.assertTrue(torch.equal(clips[2], torch.stack(frames[3:5])))
+
+    def test_stats_count_pipeline_stages(self):
+        """Test that reader and writer stats count the frames and stages used."""
+        reader = celux.VideoReader(self.video_path, device="cpu")
+        frames = [f for _, f in zip(range(5), reader)]
+        stats = reader.stats(reset=True)
+        self.assertEqual(stats["frames"], 5)
+        self.assertGreater(stats["demux"]["calls"], 0)
+        self.assertGreater(stats["convert"]["seconds"], 0.0)
+        self.assertEqual(reader.stats()["frames"], 0)
+        reader = None
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mkv")
+            with celux.VideoWriter(path, frames[0].shape[1], frames[0].shape[0], 30.0,
+                                   device="cpu", codec="mpeg4") as writer:
+                for frame in frames:
+                    writer.write_frame(frame)
+            stats = writer.stats()
+            self.assertEqual(stats["frames"], 5)
+            self.assertGreater(stats["encode"]["calls"], 0)
+            self.assertGreater(stats["mux"]["calls"], 0)
+
+    def test_log_level(self):
+        """Test that the log level round-trips and rejects unknown names."""
+        previous = celux.get_log_level()
+        try:
+            celux.set_log_level("warning")
+            self.assertEqual(celux.get_log_level(), "warning")
+            with self.assertRaises(ValueError):
+                celux.set_log_level("verbose")
+        finally:
+            celux.set_log_level(previous)
+
+    def test_cpu_decode_to_cuda_output(self):
+        """Test that CPU-decoded frames staged to the GPU match CPU output."""
+        if not torch.cuda.is_available():
+            self.skipTest("CUDA is not available")
+        expected = [f for _, f in zip(range(4), celux.VideoReader(self.video_path,
+                                                                  device="cpu"))]
+        for prefetch in (0, 2):
+            reader = celux.VideoReader(self.video_path, device="cpu",
+                                       output_device="cuda", prefetch=prefetch)
+            frames = [f for _, f in zip(range(4), reader)]
+            self.assertTrue(all(f.is_cuda for f in frames))
+            for frame, cpu in zip(frames, expected):
+                self.assertTrue(torch.equal(frame.cpu(), cpu))
+
+    def test_cpu_writer_round_trip(self):
+        """Test that frames written on CPU read back with the same size and count."""
+        frame = torch.full((48, 64, 3), 128, dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mp4")
+            with celux.VideoWriter(path, 64, 48, (30000, 1001), device="cpu",
+                                   codec="mpeg4") as writer:
+                for _ in range(5):
+                    writer.write_frame(frame)
+            reader = celux.VideoReader(path, device="cpu")
+            frames = [f for f in reader]
+            self.assertEqual(len(frames), 5)
+            self.assertEqual(tuple(frames[0].shape), (48, 64, 3))
+            reader = None
+
+    def test_cpu_writer_queue_size(self):
+        """Test that queued writes are all written and flush returns after close."""
+        frame = torch.full((48, 64, 3), 128, dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mp4")
+            writer = celux.VideoWriter(path, 64, 48, 30.0, device="cpu",
+                                       codec="mpeg4", queue_size=2)
+            for _ in range(5):
+                writer.write_frame(frame)
+            writer.flush()
+            writer.write_batch(torch.stack([frame] * 3))
+            writer.close()
+            with self.assertRaises(RuntimeError):
+                writer.write_frame(frame)
+            writer.flush()  # Must not wait for the rejected frame
+            writer = None
+            reader = celux.VideoReader(path, device="cpu")
+            frames = [f for f in reader]
+            self.assertEqual(len(frames), 8)
+            self.assertEqual(tuple(frames[0].shape), (48, 64, 3))
+            reader = None
+
+    def test_cpu_writer_batch(self):
+        """Test that write_batch writes every frame and rejects a wrong frame size."""
+        frames = torch.zeros((4, 48, 64, 3), dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mp4")
+            with celux.VideoWriter(path, 64, 48, 30.0, device="cpu",
+                                   codec="mpeg4") as writer:
+                writer.write_batch(frames)
+                with self.assertRaises(ValueError):
+                    writer.write_batch(torch.zeros((2, 32, 64, 3), dtype=torch.uint8))
+            reader = celux.VideoReader(path, device="cpu")
+            self.assertEqual(len([f for f in reader]), 4)
+            reader = None
+
+    def test_cpu_writer_nv12_input(self):
+        """Test that NV12 frames are written as is and rejected in RGB shape."""
+        frame = torch.full((48 * 3 // 2, 64), 128, dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mp4")
+            with celux.VideoWriter(path, 64, 48, 30.0, device="cpu", codec="mpeg4",
+                                   input_format="nv12") as writer:
+                for _ in range(3):
+                    writer.write_frame(frame)
+                with self.assertRaises(ValueError):
+                    writer.write_frame(torch.zeros((48, 64, 3), dtype=torch.uint8))
+            reader = celux.VideoReader(path, device="cpu")
+            frames = [f for f in reader]
+            self.assertEqual(len(frames), 3)
+            # Mid grey luma and neutral chroma decode to mid grey RGB
+            self.assertLess((frames[0].float() - 130).abs().max().item(), 8)
+            reader = None
+
+    def test_cpu_transcoder(self):
+        """Test that the transcoder writes the requested frames through a callback."""
+        calls = []
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mp4")
+            with celux.Transcoder(self.video_path, path, device="cpu",
+                                  codec="mpeg4") as transcoder:
+                written = transcoder.run(lambda y, *chroma: calls.append(y.shape),
+                                         max_frames=4)
+                size = transcoder.get_properties()
+            self.assertEqual(written, 4)
+            self.assertEqual(len(calls), 4)
+            self.assertEqual(tuple(calls[0]), (size["height"], size["width"]))
+            reader = celux.VideoReader(path, device="cpu")
+            self.assertEqual(len([f for f in reader]), 4)
+            reader = None
+
+    def test_remux_copies_keyframe_range(self):
+        """Test that remux copies whole GOPs covering the requested range."""
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "clip.mkv")
+            start, end = celux.remux(self.video_path, path, frame_range=(5, 10))
+            self.assertLessEqual(start, 5)
+            self.assertGreaterEqual(end, 10)
+            reader = celux.VideoReader(path, device="cpu")
+            self.assertEqual(len([f for f in reader]), end - start)
+            reader = None
+
+    def test_writer_copies_audio(self):
+        """Test that a writer given an audio source writes an audio stream."""
+        if not self.reader.get_properties()["has_audio"]:
+            self.skipTest("the test video has no audio")
+        frame = torch.zeros((48, 64, 3), dtype=torch.uint8)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "out.mkv")
+            with celux.VideoWriter(path, 64, 48, 30.0, device="cpu", codec="mpeg4",
+                                   audio=self.video_path) as writer:
+                for _ in range(30):
+                    writer.write_frame(frame)
+            reader = celux.VideoReader(path, device="cpu")
+            self.assertTrue(reader.get_properties()["has_audio"])
+            reader = None
+
+    def test_skip_stream_info_matches_probed_open(self):
+        """Test that header-only opens report the same stream as probed opens."""
+        probed = celux.VideoReader(self.video_path, device="cpu")
+        fast = celux.VideoReader(self.video_path, device="cpu", skip_stream_info=True,
+                                 format_options={"probesize": "65536"})
+        expected = probed.get_properties()
+        properties = fast.get_properties()
+        for key in ("width", "height", "pixel_format", "total_frames"):
+            self.assertEqual(properties[key], expected[key])
+        self.assertTrue(torch.equal(fast.read_frame(), probed.read_frame()))
+        with self.assertRaises(ValueError):
+            celux.VideoReader(self.video_path, device="cpu",
+                              format_options={"not_an_option": "1"})
+        probed = fast = None
+
+    def test_custom_io_round_trip(self):
+        """Test reading from bytes and writing to a file object."""
+        with open(self.video_path, "rb") as source:
+            data = source.read()
+        from_bytes = celux.VideoReader(data, device="cpu")
+        from_path = celux.VideoReader(self.video_path, device="cpu")
+        self.assertEqual(len(from_bytes), len(from_path))
+        self.assertTrue(torch.equal(from_bytes.read_frame(), from_path.read_frame()))
+        from_bytes = from_path = None
+
+        buffer = io.BytesIO()
+        frame = torch.zeros((48, 64, 3), dtype=torch.uint8)
+        with celux.VideoWriter(buffer, 64, 48, 30.0, device="cpu", codec="mpeg4",
+                               container="matroska") as writer:
+            for _ in range(3):
+                writer.write_frame(frame)
+        reader = celux.VideoReader(io.BytesIO(buffer.getvalue()), device="cpu")
+        self.assertEqual(len([f for f in reader]), 3)
+        reader = None
+
     def test_iteration(self):
         """Test iteration through frames."""
         count = 0